@@ -9,23 +9,66 @@
  * 
  */
 #include "Loggers.h"
+#include "log/RingLogger.h"
+#include "log/LogFilter.h"
+#include "log/LogBuilder.h"
+#include "log/BinaryLog.h"
+#include <cstdio>
 
 #ifndef Global_h
 #define Global_h
 
 using namespace LogCPP;
 
-#define INFO_ASYN(msg)      AsynchronizedLogger::GetInstance().Log(INFO,      msg);
-#define DEBUG_ASYN(msg)     AsynchronizedLogger::GetInstance().Log(DEBUG,     msg);
-#define WARNING_ASYN(msg)   AsynchronizedLogger::GetInstance().Log(WARNING,   msg);
-#define ERROR_ASYN(msg)     AsynchronizedLogger::GetInstance().Log(ERROR,     msg);
-#define FATAL_ASYN(msg)     AsynchronizedLogger::GetInstance().Log(FATAL,     msg);
-#define INFO_SYN(msg)       SynchronizedLogger::GetInstance().Log(INFO,      msg);
-#define DEBUG_SYN(msg)      SynchronizedLogger::GetInstance().Log(DEBUG,     msg);
-#define WARNING_SYN(msg)    SynchronizedLogger::GetInstance().Log(WARNING,   msg);
-#define ERROR_SYN(msg)      SynchronizedLogger::GetInstance().Log(ERROR,     msg);
-#define FATAL_SYN(msg)      SynchronizedLogger::GetInstance().Log(FATAL,     msg);
+// QQ_LOG_MIN_LEVEL removes the levels below it at compile time, LogFilter drops them at runtime
+// the message is only evaluated when both let the level through
+#define LOG_ENABLED(level)  ((int)(level) >= QQ_LOG_MIN_LEVEL && QQDommy::LogFilter::enabled(level))
+// the asynchronous macros go through the lock free ring logger
+#define LOG_ASYN(level, msg) \
+    do { if (LOG_ENABLED(level)) QQDommy::RingLogger::GetInstance().Log(level, msg); } while (0);
+#define LOG_SYN(level, msg) \
+    do { if (LOG_ENABLED(level)) SynchronizedLogger::GetInstance().Log(level, msg); } while (0);
+// e.g. DEBUG_STREAM("seq " << seq << " : " << payload.toHexString())
+#define LOG_STREAM(level, expr) \
+    do { if (LOG_ENABLED(level)) { QQDommy::LogBuilder builder_; builder_ << expr; \
+        QQDommy::RingLogger::GetInstance().Log(level, builder_.str()); } } while (0);
+// e.g. DEBUG_FORMAT("seq %u : %zu bytes", seq, length)
+#define LOG_FORMAT(level, ...) \
+    do { if (LOG_ENABLED(level)) QQDommy::RingLogger::GetInstance().Log(level, QQDommy::LogBuilder::format(__VA_ARGS__)); } while (0);
+
+// e.g. DEBUG_BIN("seq %u : %zu bytes", seq, length), only a format id, a tick and the raw
+// arguments are recorded, the daemon formats them, the printf call is never made
+#define LOG_BIN(level, fmt, ...) \
+    do { if (LOG_ENABLED(level)) { if (0) printf(fmt, ##__VA_ARGS__); \
+        static const QQDommy::LogFormat format_(level, fmt, __FILE__, __LINE__); \
+        QQDommy::BinaryLog::log(format_, ##__VA_ARGS__); } } while (0);
+
+#define INFO_ASYN(msg)      LOG_ASYN(INFO,      msg)
+#define DEBUG_ASYN(msg)     LOG_ASYN(DEBUG,     msg)
+#define WARNING_ASYN(msg)   LOG_ASYN(WARNING,   msg)
+#define ERROR_ASYN(msg)     LOG_ASYN(ERROR,     msg)
+#define FATAL_ASYN(msg)     LOG_ASYN(FATAL,     msg)
+#define INFO_SYN(msg)       LOG_SYN(INFO,      msg)
+#define DEBUG_SYN(msg)      LOG_SYN(DEBUG,     msg)
+#define WARNING_SYN(msg)    LOG_SYN(WARNING,   msg)
+#define ERROR_SYN(msg)      LOG_SYN(ERROR,     msg)
+#define FATAL_SYN(msg)      LOG_SYN(FATAL,     msg)
+#define INFO_STREAM(expr)       LOG_STREAM(INFO,      expr)
+#define DEBUG_STREAM(expr)      LOG_STREAM(DEBUG,     expr)
+#define WARNING_STREAM(expr)    LOG_STREAM(WARNING,   expr)
+#define ERROR_STREAM(expr)      LOG_STREAM(ERROR,     expr)
+#define FATAL_STREAM(expr)      LOG_STREAM(FATAL,     expr)
+#define INFO_FORMAT(...)        LOG_FORMAT(INFO,      __VA_ARGS__)
+#define DEBUG_FORMAT(...)       LOG_FORMAT(DEBUG,     __VA_ARGS__)
+#define WARNING_FORMAT(...)     LOG_FORMAT(WARNING,   __VA_ARGS__)
+#define ERROR_FORMAT(...)       LOG_FORMAT(ERROR,     __VA_ARGS__)
+#define FATAL_FORMAT(...)       LOG_FORMAT(FATAL,     __VA_ARGS__)
+#define INFO_BIN(...)           LOG_BIN(INFO,      __VA_ARGS__)
+#define DEBUG_BIN(...)          LOG_BIN(DEBUG,     __VA_ARGS__)
+#define WARNING_BIN(...)        LOG_BIN(WARNING,   __VA_ARGS__)
+#define ERROR_BIN(...)          LOG_BIN(ERROR,     __VA_ARGS__)
+#define FATAL_BIN(...)          LOG_BIN(FATAL,     __VA_ARGS__)
 #define CLEAN_UP            SynchronizedLogger::GetInstance().SafeDelete(); \
-                            AsynchronizedLogger::GetInstance().SafeDelete();
+                            QQDommy::RingLogger::GetInstance().SafeDelete();
 
 #endif
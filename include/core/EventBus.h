@@ -0,0 +1,210 @@
+/**
+ * @file EventBus.h
+ * @author maxwellzs
+ * @brief this file defines the bus handing the decoded events to the processes of the host
+ * one publisher writes every event once into a ring of posix shared memory, each
+ * subscriber process maps the ring and reads the events in place through read only
+ * ByteBuffer views, so neither side makes a syscall per event
+ * shm | header (BUS_HEADER_SIZE) | ring (capacity bytes) |
+ * event | length u32 | type u16 | reserved u16 | sequence u64 | payload | padding to 16 |
+ * an event never wraps, the room left before the end of the ring is filled by an
+ * event of the type BUS_PADDING
+ * every subscriber owns a slot of the header holding its cursor, the publisher never
+ * writes over the bytes a subscriber has not read, a subscriber holding the ring full
+ * is evicted while it is not reading, it starts over at the newest event on its next poll
+ * and counts the events it lost from the gap in the sequences
+ * the slot of a subscriber whose process is gone is freed
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <exception>
+#include "utils/ByteBuffer.h"
+
+#ifndef EventBus_h
+#define EventBus_h
+
+namespace QQDommy
+{
+
+    const static uint32_t BUS_MAGIC = 0x51514542;
+    const static uint16_t BUS_VERSION = 2;
+    /// @brief the header takes a page so that the ring is page aligned
+    const static size_t BUS_HEADER_SIZE = 4096;
+    const static size_t BUS_MAX_SUBSCRIBERS = 32;
+    /// @brief the bytes of the header of an event, the events are aligned to it
+    const static size_t BUS_EVENT_ALIGN = 16;
+    const static size_t DEFAULT_BUS_CAPACITY = 4 << 20;
+    /// @brief the type filling the end of the ring, never handed to the subscribers
+    const static uint16_t BUS_PADDING = 0xFFFF;
+
+    /**
+     * @brief thrown when the bus can not be created or joined, or an event does not fit it
+     *
+     */
+    class EventBusException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        EventBusException(const std::string &msg);
+        const char *what() const noexcept override;
+    };
+
+    struct BusHeader;
+    struct BusSlot;
+
+    /**
+     * @brief an event as the subscriber sees it
+     *
+     */
+    struct BusEvent
+    {
+        uint16_t type;
+        /// @brief counted from 1 by the publisher, a gap is an event lost
+        uint64_t sequence;
+        /// @brief a read only view into the ring, valid until the handler returns
+        ByteBuffer &payload;
+    };
+
+    /**
+     * @brief the counters of the bus, kept in the shared memory
+     *
+     */
+    struct BusStats
+    {
+        uint64_t published = 0;
+        /// @brief the events not written since a subscriber in the middle of a poll held the ring full
+        uint64_t dropped = 0;
+        /// @brief the subscribers evicted for holding the ring full
+        uint64_t evictions = 0;
+        uint64_t subscribers = 0;
+        /// @brief the unread bytes of the slowest subscriber
+        uint64_t maxLag = 0;
+    };
+
+    /**
+     * @brief the single writer of a bus
+     *
+     */
+    class EventPublisher
+    {
+    private:
+        std::string name;
+        int fd = -1;
+        uint8_t *mapped = nullptr;
+        size_t mappedSize = 0;
+        BusHeader *header = nullptr;
+        uint8_t *ring = nullptr;
+        size_t capacity = 0;
+        /// @brief the position of the next event, only written here
+        uint64_t head = 0;
+        uint64_t sequence = 0;
+        /// @brief the position up to which the ring is known to be free, the slots are looked at past it
+        uint64_t limit = 0;
+        /// @brief the free position given the cursors, evicting or freeing the subscribers in the way of need bytes
+        uint64_t gate(uint64_t need);
+
+    public:
+        /**
+         * @brief create the bus, or take over the one left by a former publisher of the same capacity
+         * the shared memory is locked against a second publisher
+         *
+         * @param name the name of the shared memory, e.g. "/qqdommy-events"
+         * @param capacity the bytes of the ring, a power of 2
+         */
+        EventPublisher(const std::string &name, size_t capacity = DEFAULT_BUS_CAPACITY);
+        /// @brief unmap the bus, it stays for the subscribers until unlinked
+        ~EventPublisher();
+        EventPublisher(const EventPublisher &) = delete;
+        EventPublisher &operator=(const EventPublisher &) = delete;
+        /**
+         * @brief copy an event into the ring, the only copy it makes
+         * throws EventBusException if the event is larger than a quarter of the ring
+         *
+         * @param type the kind of the event, e.g. a group message, BUS_PADDING is reserved
+         * @param data the payload
+         * @param length the length of the payload
+         * @return true if published, false if dropped for a subscriber in the middle of a poll holding the ring full
+         */
+        bool publish(uint16_t type, const void *data, size_t length);
+        /// @brief publish the readable bytes of the buffer without consuming them
+        bool publish(uint16_t type, const ByteBuffer &payload);
+        BusStats getStats() const;
+        /// @brief remove the shared memory, the mappings stay valid
+        static void unlink(const std::string &name);
+    };
+
+    /**
+     * @brief the callback of a subscriber
+     *
+     */
+    class BusHandler
+    {
+    public:
+        virtual ~BusHandler() = default;
+        virtual void onEvent(const BusEvent &event) = 0;
+    };
+
+    /**
+     * @brief a reader of a bus, one per process or thread reading it
+     *
+     */
+    class EventSubscriber
+    {
+    private:
+        uint8_t *mapped = nullptr;
+        size_t mappedSize = 0;
+        BusHeader *header = nullptr;
+        BusSlot *slot = nullptr;
+        /// @brief the pid the slot is held with
+        int32_t pid = 0;
+        uint8_t *ring = nullptr;
+        size_t capacity = 0;
+        uint64_t cursor = 0;
+        /// @brief the sequence of the next event, 0 until the first one is read
+        uint64_t expected = 0;
+        uint64_t lost = 0;
+        uint64_t evicted = 0;
+        /// @brief publish the slot with the cursor at the newest event
+        void attach();
+
+    public:
+        /**
+         * @brief join a bus, the events published from now on are read
+         * throws EventBusException if there is no such bus or all the slots are taken
+         *
+         * @param name the name the publisher created the bus with
+         */
+        EventSubscriber(const std::string &name);
+        /// @brief free the slot, the publisher no longer waits for it
+        ~EventSubscriber();
+        EventSubscriber(const EventSubscriber &) = delete;
+        EventSubscriber &operator=(const EventSubscriber &) = delete;
+        /**
+         * @brief hand the events published since the last poll to the handler, in order
+         * the ring is not written over while the handler reads it
+         *
+         * @param handler the callback
+         * @param maxEvents the most events handled
+         * @return size_t the events handled
+         */
+        size_t poll(BusHandler &handler, size_t maxEvents = SIZE_MAX);
+        /// @brief the bytes published and not read yet
+        uint64_t lag() const;
+        /// @brief the events that never reached the subscriber, counted when the event after them is read
+        uint64_t getLost() const;
+        /// @brief the times the subscriber was evicted for being too slow
+        uint64_t getEvictions() const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file Frame.h
+ * @author maxwellzs
+ * @brief this file defines the framing of the packets on the oicq connection
+ * every frame starts with a big endian header:
+ * | length u32 (including the header) | sequence u32 | command u32 | payload ... |
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <exception>
+#include "utils/ByteBuffer.h"
+
+#ifndef Frame_h
+#define Frame_h
+
+namespace QQDommy
+{
+
+    /// @brief the size of length + sequence + command
+    const static size_t FRAME_HEADER_SIZE = 12;
+    /// @brief frames longer than this are treated as a broken stream
+    const static size_t MAX_FRAME_LENGTH = 16 * 1024 * 1024;
+
+    /**
+     * @brief thrown when the length field of a frame is impossible
+     *
+     */
+    class MalformedFrameException : public std::exception
+    {
+    public:
+        const char *what() const noexcept override;
+    };
+
+    /**
+     * @brief a decoded frame
+     * the payload is a READ ONLY view into the receive buffer, it is only valid
+     * until the receive buffer is written again, i.e. during the current callback
+     *
+     */
+    struct Frame
+    {
+        uint32_t sequence = 0;
+        uint32_t command = 0;
+        ByteBuffer payload = ByteBuffer::wrap(nullptr, 0);
+    };
+
+    class FrameCodec
+    {
+    private:
+        FrameCodec();
+
+    public:
+        /**
+         * @brief write the header and the payload into the buffer
+         *
+         * @param out the buffer to write
+         * @param sequence the sequence id of the frame
+         * @param command the command of the frame
+         * @param payload the payload
+         * @param length the length of the payload
+         */
+        static void encode(ByteBuffer &out, uint32_t sequence, uint32_t command, const uint8_t *payload, size_t length);
+        /**
+         * @brief try to cut one complete frame from the buffer
+         * the bytes of the frame are consumed when a frame is returned
+         *
+         * @param in the receive buffer
+         * @param frame where the decoded frame is stored
+         * @return true if a frame is complete
+         * @return false if more data is needed, nothing is consumed
+         */
+        static bool decode(ByteBuffer &in, Frame &frame);
+    };
+
+};
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @file Multiplexer.h
+ * @author maxwellzs
+ * @brief this file defines the multiplexer that matches the responses with the requests
+ * by sequence id, so that many requests can be in flight on one connection
+ * the pending requests are kept in a fixed size open addressed table that is
+ * modified only with atomic operations, no mutex is held on any path
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include "core/Frame.h"
+
+#ifndef Multiplexer_h
+#define Multiplexer_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief how a pending request ended
+     *
+     */
+    typedef enum
+    {
+        RESPONDED,
+        TIMED_OUT,
+        CANCELLED
+    } REQUEST_STATUS;
+
+    /**
+     * @brief called exactly once for every registered request
+     * the frame is only given when the status is RESPONDED, nullptr otherwise
+     * the payload of the frame is only valid during the call
+     *
+     */
+    typedef std::function<void(REQUEST_STATUS, Frame *)> ResponseCallback;
+
+    /**
+     * @brief set on the future of a request that did not get its response
+     *
+     */
+    class RequestFailedException : public std::exception
+    {
+    private:
+        REQUEST_STATUS status;
+
+    public:
+        RequestFailedException(REQUEST_STATUS status);
+        REQUEST_STATUS getStatus() const;
+        const char *what() const noexcept override;
+    };
+
+    /// @brief the number of requests that can be pending at the same time
+    const static size_t DEFAULT_PENDING_CAPACITY = 4096;
+    /// @brief how far a request may be stored from its home slot
+    const static size_t MAX_PENDING_PROBE = 16;
+
+    class SequenceMultiplexer
+    {
+    private:
+        /**
+         * @brief one entry of the pending table
+         * key is EMPTY_KEY, BUSY_KEY while owned by one thread, or sequence + KEY_OFFSET
+         * when the entry is published, the other fields are only written while BUSY
+         *
+         */
+        struct alignas(64) PendingSlot
+        {
+            std::atomic<uint64_t> key{0};
+            std::atomic<int64_t> deadline{0};
+            ResponseCallback callback;
+        };
+        const static uint64_t EMPTY_KEY = 0;
+        const static uint64_t BUSY_KEY = 1;
+        const static uint64_t KEY_OFFSET = 2;
+
+        std::unique_ptr<PendingSlot[]> slots;
+        size_t mask;
+        std::atomic<uint32_t> sequence{0};
+        /// @brief where the sequences are taken from, the own counter unless bound
+        std::atomic<uint32_t> *source = &sequence;
+        std::atomic<size_t> pending{0};
+        /// @brief taken by expect only, the duplicate check and the insert are one step for concurrent callers
+        std::mutex registering;
+        /**
+         * @brief find the published entry of the sequence and take the ownership of it
+         *
+         * @param seq the sequence id
+         * @return PendingSlot* the slot in BUSY state, nullptr if not pending
+         */
+        PendingSlot *claim(uint32_t seq);
+        /**
+         * @brief empty a claimed slot and call its callback
+         *
+         * @param slot the slot owned by this thread
+         * @param status the reason
+         * @param frame the response, may be nullptr
+         */
+        void finish(PendingSlot *slot, REQUEST_STATUS status, Frame *frame);
+
+    public:
+        /**
+         * @brief Construct a new Sequence Multiplexer object
+         *
+         * @param capacity the size of the pending table, rounded up to a power of 2
+         */
+        SequenceMultiplexer(size_t capacity = DEFAULT_PENDING_CAPACITY);
+        SequenceMultiplexer(const SequenceMultiplexer &) = delete;
+        SequenceMultiplexer &operator=(const SequenceMultiplexer &) = delete;
+        /**
+         * @brief allocate a sequence id, 0 is never returned
+         *
+         * @return uint32_t the sequence id
+         */
+        uint32_t nextSequence();
+        /**
+         * @brief take the sequences from a counter outliving the multiplexer, such as the
+         * one of a SessionStore, so that a resumed session goes on where it stopped
+         * must be called before the first request
+         *
+         * @param counter the last sequence used
+         */
+        void bindSequence(std::atomic<uint32_t> &counter);
+        /**
+         * @brief register a request, must be called before the request is sent
+         * can be called from any thread
+         *
+         * @param seq the sequence id of the request
+         * @param callback called when the response arrives, the request times out or is cancelled
+         * @param timeoutMs the time to wait for the response, 0 waits forever
+         * @return true if registered
+         * @return false if the sequence is already pending or the table is full around it, the callback is not kept
+         */
+        bool expect(uint32_t seq, const ResponseCallback &callback, int timeoutMs);
+        /**
+         * @brief register a request and get the payload of the response by future
+         * the future throws RequestFailedException if no response arrives
+         *
+         * @param seq the sequence id of the request
+         * @param timeoutMs the time to wait for the response, 0 waits forever
+         * @return std::future<ByteBuffer> holding a copy of the response payload
+         */
+        std::future<ByteBuffer> expect(uint32_t seq, int timeoutMs);
+        /**
+         * @brief complete the pending request matching the frame
+         *
+         * @param frame the decoded response
+         * @return true if a request was waiting for the frame
+         * @return false if the frame is unsolicited, e.g. a push from the server
+         */
+        bool dispatch(Frame &frame);
+        /**
+         * @brief cancel a pending request, its callback receives CANCELLED
+         *
+         * @param seq the sequence id
+         * @return true if the request was still pending
+         */
+        bool cancel(uint32_t seq);
+        /**
+         * @brief time out one pending request at once, its callback receives TIMED_OUT
+         * used when the deadline is tracked outside, e.g. by the timer wheel of a loop
+         *
+         * @param seq the sequence id
+         * @return true if the request was still pending
+         */
+        bool timeout(uint32_t seq);
+        /// @brief cancel all the pending requests, e.g. when the connection is lost
+        size_t cancelAll();
+        /**
+         * @brief time out every request whose deadline has passed
+         *
+         * @param now the current time
+         * @return size_t the number of requests timed out
+         */
+        size_t expire(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+        size_t pendingCount() const;
+        size_t getCapacity() const;
+    };
+
+};
+
+#endif
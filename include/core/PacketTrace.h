@@ -0,0 +1,188 @@
+/**
+ * @file PacketTrace.h
+ * @author maxwellzs
+ * @brief this file defines the packet trace used to reproduce performance problems offline
+ * a trace is a header followed by timestamped, direction tagged frames:
+ * header | magic "QQTR" | version u16 | flags u16 | start time u64 (ns since epoch) |
+ * record | offset u64 (ns since start) | direction u8 | kind u8 | reserved u16 | length u32 | bytes |
+ * all the integers are big endian like the rest of the protocol
+ * the recorder taps the buffers of a connection, the replayer maps the file and hands out
+ * the frames as read only views, so replaying does not allocate or copy per frame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <functional>
+#include <exception>
+#include "utils/ByteBuffer.h"
+#include "core/Frame.h"
+#include "net/Connection.h"
+
+#ifndef PacketTrace_h
+#define PacketTrace_h
+
+namespace QQDommy
+{
+
+    const static uint32_t TRACE_MAGIC = 0x51515452;
+    const static uint16_t TRACE_VERSION = 1;
+    const static size_t TRACE_HEADER_SIZE = 16;
+    const static size_t TRACE_RECORD_HEADER_SIZE = 16;
+    /// @brief the header flag telling that some records hold decrypted payloads
+    const static uint16_t TRACE_FLAG_DECRYPTED = 0x1;
+    /// @brief the recorder writes to the file once this many bytes are buffered
+    const static size_t TRACE_FLUSH_SIZE = 64 * 1024;
+
+    /**
+     * @brief what the bytes of a record are
+     *
+     */
+    typedef enum
+    {
+        /// @brief a whole frame as seen on the wire
+        FRAME_RECORD,
+        /// @brief a payload after decryption
+        PAYLOAD_RECORD
+    } TRACE_KIND;
+
+    typedef enum
+    {
+        /// @brief feed the frames as fast as possible
+        MAX_SPEED,
+        /// @brief feed the frames with the gaps they were recorded with
+        ORIGINAL_TIMING
+    } REPLAY_MODE;
+
+    /**
+     * @brief thrown when a trace can not be opened or is malformed
+     *
+     */
+    class TraceFileException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        TraceFileException(const std::string &msg);
+        const char *what() const noexcept override;
+    };
+
+    class TraceRecorder : public ConnectionTap
+    {
+    private:
+        int fd = -1;
+        int64_t startNs;
+        /// @brief records waiting to be written
+        ByteBuffer output;
+        /// @brief bytes of an incomplete frame, per direction
+        ByteBuffer partial[2];
+        void writeRecord(DIRECTION direction, TRACE_KIND kind, const uint8_t *data, size_t length);
+
+    public:
+        /**
+         * @brief create or truncate the trace file
+         *
+         * @param path the path of the trace
+         * @param decrypted whether decrypted payloads will be recorded too
+         */
+        TraceRecorder(const std::string &path, bool decrypted = false);
+        /// @brief flush and close the file
+        ~TraceRecorder();
+        TraceRecorder(const TraceRecorder &) = delete;
+        TraceRecorder &operator=(const TraceRecorder &) = delete;
+        /**
+         * @brief cut the stream of the connection into frames and record them
+         * attach with Connection::setTap
+         *
+         */
+        void tap(DIRECTION direction, const uint8_t *data, size_t length) override;
+        /**
+         * @brief record a payload after it was decrypted
+         *
+         * @param direction INBOUND or OUTBOUND
+         * @param data the decrypted payload
+         * @param length the length of the payload
+         */
+        void recordPayload(DIRECTION direction, const uint8_t *data, size_t length);
+        /// @brief write the buffered records to the file
+        void flush();
+    };
+
+    /**
+     * @brief a record handed out by the replayer, data is a view into the mapped file
+     *
+     */
+    struct TraceRecord
+    {
+        uint64_t offsetNs = 0;
+        DIRECTION direction = INBOUND;
+        TRACE_KIND kind = FRAME_RECORD;
+        ByteBuffer data = ByteBuffer::wrap(nullptr, 0);
+    };
+
+    /**
+     * @brief the result of a replay
+     *
+     */
+    struct ReplayStats
+    {
+        size_t frames = 0;
+        size_t bytes = 0;
+        double seconds = 0;
+        double framesPerSecond() const { return seconds > 0 ? frames / seconds : 0; }
+        double bytesPerSecond() const { return seconds > 0 ? bytes / seconds : 0; }
+    };
+
+    /// @brief receives the decoded frames of a replay
+    typedef std::function<void(DIRECTION, Frame &)> ReplayCallback;
+
+    class TraceReplayer
+    {
+    private:
+        const uint8_t *mapped = nullptr;
+        size_t mappedSize = 0;
+        size_t position = TRACE_HEADER_SIZE;
+        uint16_t flags = 0;
+        uint64_t startNs = 0;
+
+    public:
+        /**
+         * @brief map the trace file read only
+         *
+         * @param path the path of the trace
+         */
+        TraceReplayer(const std::string &path);
+        ~TraceReplayer();
+        TraceReplayer(const TraceReplayer &) = delete;
+        TraceReplayer &operator=(const TraceReplayer &) = delete;
+        /**
+         * @brief read the next record
+         *
+         * @param record filled with the record, the data is a view into the file
+         * @return true if a record was read
+         * @return false at the end of the trace
+         */
+        bool next(TraceRecord &record);
+        /// @brief start from the first record again
+        void rewind();
+        /**
+         * @brief decode every frame record of the trace and pass it to the callback
+         *
+         * @param callback called with each decoded frame
+         * @param mode MAX_SPEED or ORIGINAL_TIMING
+         * @return ReplayStats the decode throughput
+         */
+        ReplayStats replay(const ReplayCallback &callback, REPLAY_MODE mode = MAX_SPEED);
+        bool hasDecryptedPayloads() const;
+        /// @brief the wall clock time the trace was started, ns since epoch
+        uint64_t getStartTime() const;
+    };
+
+};
+
+#endif
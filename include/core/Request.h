@@ -0,0 +1,170 @@
+/**
+ * @file Request.h
+ * @author maxwellzs
+ * @brief this file defines the awaitables of the request/response flows
+ * co_await request(...) sends a frame and resumes the coroutine when the response
+ * with the same sequence id arrives, the request times out on the timer wheel of
+ * the loop and can be cancelled by a token
+ * all of them must be used on the thread of the loop driving the connection
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <functional>
+#include <coroutine>
+#include "core/Task.h"
+#include "core/Frame.h"
+#include "core/Multiplexer.h"
+#include "net/Connection.h"
+#include "utils/Tracing.h"
+
+#ifndef Request_h
+#define Request_h
+
+namespace QQDommy
+{
+
+    /// @brief the default time to wait for a response
+    const static int DEFAULT_REQUEST_TIMEOUT = 10000;
+
+    /**
+     * @brief cancels the requests it is passed to, copies share the same state
+     * NOT thread safe, use it on the thread of the loop
+     *
+     */
+    class CancelToken
+    {
+    private:
+        struct CancelState
+        {
+            bool cancelled = false;
+            std::function<void()> onCancel;
+        };
+        std::shared_ptr<CancelState> state;
+
+    public:
+        CancelToken();
+        /// @brief cancel the request currently waiting on this token, and all later ones
+        void cancel();
+        bool isCancelled() const;
+        /**
+         * @brief set what happens on cancel, used by the awaitables
+         *
+         * @param callback called once on cancel, nullptr to clear
+         */
+        void setCallback(const std::function<void()> &callback);
+    };
+
+    /**
+     * @brief the result of an awaited request
+     * the payload is a copy owned by the coroutine
+     *
+     */
+    struct Response
+    {
+        REQUEST_STATUS status = CANCELLED;
+        uint32_t command = 0;
+        ByteBuffer payload;
+        bool ok() const { return status == RESPONDED; }
+    };
+
+    class RequestAwaiter
+    {
+    private:
+        Connection &conn;
+        SequenceMultiplexer &mux;
+        uint32_t command;
+        const uint8_t *payload;
+        size_t length;
+        int timeoutMs;
+        CancelToken *token;
+        TimerId timer = 0;
+        Response response;
+        /// @brief the traced flow of the coroutine, left while it waits
+        uint64_t flow;
+        uint64_t sentAt = 0;
+        /// @brief set while await_suspend runs, a completion then only records itself
+        bool suspending = false;
+        /// @brief completed before await_suspend returned, e.g. the send closed the connection
+        bool completedInline = false;
+        /// @brief called by the multiplexer, fills the response and resumes
+        void complete(REQUEST_STATUS status, Frame *frame, std::coroutine_handle<> handle);
+
+    public:
+        RequestAwaiter(Connection &conn, SequenceMultiplexer &mux, uint32_t command,
+                       const uint8_t *payload, size_t length, int timeoutMs, CancelToken *token);
+        bool await_ready() const noexcept;
+        bool await_suspend(std::coroutine_handle<> handle);
+        Response await_resume();
+    };
+
+    /**
+     * @brief send a request and await its response
+     * the payload is copied into the send buffer before the coroutine suspends
+     *
+     * @param conn the connection carrying the request
+     * @param mux the multiplexer the responses of the connection are dispatched to
+     * @param command the command of the frame
+     * @param payload the payload, all the readable bytes are sent but not consumed
+     * @param timeoutMs the time to wait for the response
+     * @param token optional, cancels the request
+     * @return RequestAwaiter co_await it to get the Response
+     */
+    RequestAwaiter request(Connection &conn, SequenceMultiplexer &mux, uint32_t command, const ByteBuffer &payload,
+                           int timeoutMs = DEFAULT_REQUEST_TIMEOUT, CancelToken *token = nullptr);
+
+    class DelayAwaiter
+    {
+    private:
+        EventLoop &loop;
+        int delayMs;
+        uint64_t flow;
+
+    public:
+        DelayAwaiter(EventLoop &loop, int delayMs);
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() noexcept { Tracer::resume(flow); }
+    };
+
+    /**
+     * @brief suspend the coroutine on the timer wheel of the loop, e.g. to back off before a retry
+     *
+     * @param loop the loop
+     * @param delayMs the delay
+     * @return DelayAwaiter the awaitable
+     */
+    DelayAwaiter delay(EventLoop &loop, int delayMs);
+
+    /**
+     * @brief a connection handler that cuts frames and dispatches the responses
+     * frames no request is waiting for are given to onPush
+     * all the pending requests are cancelled when the connection is closed
+     *
+     */
+    class FrameDispatcher : public ConnectionHandler
+    {
+    protected:
+        SequenceMultiplexer &mux;
+
+    public:
+        FrameDispatcher(SequenceMultiplexer &mux);
+        void onMessage(Connection &conn, ByteBuffer &input) override;
+        void onClosed(Connection &conn, int error) override;
+        /**
+         * @brief an unsolicited frame, e.g. a message pushed by the server
+         *
+         * @param conn the connection
+         * @param frame the frame, the payload is only valid during the call
+         */
+        virtual void onPush(Connection & /*conn*/, Frame & /*frame*/) {}
+    };
+
+};
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file SessionStore.h
+ * @author maxwellzs
+ * @brief this file defines the persistent store of the login sessions
+ * every account owns a fixed size record of a file mapped into memory, a restarted
+ * host finds the tokens, the device identity and the sequence of each account there
+ * and resumes without logging in again
+ * file | header (SESSION_HEADER_SIZE) | record 0 | record 1 | ... |
+ * record | sequence u32 | reserved u32 | copy 0 | copy 1 |
+ * copy | generation u64 | crc32 u32 | reserved u32 | SessionState |
+ * a save writes the copy not holding the newest generation, then its generation,
+ * so a save cut by a crash leaves the former copy intact, on open the valid copy of
+ * the highest generation wins
+ * the integers are in the byte order of the host, the file is not meant to be moved
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <unordered_map>
+#include "encrypt/Tea.h"
+
+#ifndef SessionStore_h
+#define SessionStore_h
+
+namespace QQDommy
+{
+
+    const static uint32_t SESSION_MAGIC = 0x51515353;
+    const static uint16_t SESSION_VERSION = 1;
+    /// @brief the header takes a page so that the records are page aligned
+    const static size_t SESSION_HEADER_SIZE = 4096;
+    /// @brief the room of a token, the tgt and d2 of qq are far shorter
+    const static size_t SESSION_TOKEN_SIZE = 256;
+    const static size_t DEFAULT_SESSION_CAPACITY = 16384;
+    /// @brief the sequences skipped after an unclean shutdown, the last advances may not have reached the disk
+    const static uint32_t SEQUENCE_RESUME_GAP = 1 << 16;
+
+    /**
+     * @brief the state of a logged in account, copied in and out of the store as it is
+     *
+     */
+    struct SessionState
+    {
+        /// @brief 0 is no account
+        uint64_t uin = 0;
+        uint32_t appId = 0;
+        uint16_t tgtLength = 0;
+        uint16_t d2Length = 0;
+        /// @brief the wall clock seconds the tokens were issued at and expire at
+        int64_t issuedAt = 0;
+        int64_t expiresAt = 0;
+        /// @brief the identity of the device, it must not change between logins
+        uint8_t guid[16] = {};
+        char imei[16] = {};
+        char deviceName[32] = {};
+        uint8_t tgtKey[TEA_KEY_SIZE] = {};
+        uint8_t d2Key[TEA_KEY_SIZE] = {};
+        uint8_t sessionKey[TEA_KEY_SIZE] = {};
+        uint8_t tgt[SESSION_TOKEN_SIZE] = {};
+        uint8_t d2[SESSION_TOKEN_SIZE] = {};
+    };
+
+    /**
+     * @brief thrown when the store can not be opened, is malformed or is full
+     *
+     */
+    class SessionStoreException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        SessionStoreException(const std::string &msg);
+        const char *what() const noexcept override;
+    };
+
+    struct SessionFileHeader;
+    struct SessionRecord;
+
+    class SessionStore
+    {
+    private:
+        int fd = -1;
+        uint8_t *mapped = nullptr;
+        size_t mappedSize = 0;
+        SessionFileHeader *header = nullptr;
+        SessionRecord *records = nullptr;
+        size_t capacity = 0;
+        bool durable;
+        /// @brief the slot of every account
+        std::unordered_map<uint64_t, size_t> index;
+        std::vector<size_t> freeSlots;
+        mutable std::mutex lock;
+        /// @brief write the state into the older copy of the slot
+        void write(size_t slot, const SessionState &state);
+        /// @brief flush the pages of a slot to the disk
+        void syncSlot(size_t slot);
+
+    public:
+        /**
+         * @brief open or create the store, the file is locked against other processes
+         * a file with fewer records than the capacity is grown, a larger one keeps its size
+         *
+         * @param path the path of the file
+         * @param capacity the accounts the store holds
+         * @param durable whether every save reaches the disk before it returns, otherwise
+         * a crash of the process loses nothing and a crash of the host the latest saves
+         */
+        SessionStore(const std::string &path, size_t capacity = DEFAULT_SESSION_CAPACITY, bool durable = false);
+        /// @brief flush the records and mark the shutdown as clean
+        ~SessionStore();
+        SessionStore(const SessionStore &) = delete;
+        SessionStore &operator=(const SessionStore &) = delete;
+        /**
+         * @brief read the session of an account
+         *
+         * @param uin the account
+         * @param state receives the session
+         * @return true if the account has a session
+         */
+        bool load(uint64_t uin, SessionState &state) const;
+        /**
+         * @brief create or replace the session of state.uin
+         * throws SessionStoreException if the store is full or a token is too long
+         *
+         * @param state the session
+         */
+        void save(const SessionState &state);
+        /**
+         * @brief forget the session of an account
+         *
+         * @return true if the account had one
+         */
+        bool remove(uint64_t uin);
+        /**
+         * @brief the last sequence of an account, kept in the mapping so that it survives
+         * a restart, bind it to the multiplexer of the connection
+         * it never goes back, an account taking over a freed slot goes on from its sequence
+         * throws SessionStoreException if the account has no session
+         *
+         * @param uin the account
+         * @return std::atomic<uint32_t>& valid as long as the store
+         */
+        std::atomic<uint32_t> &sequence(uint64_t uin);
+        /// @brief the accounts having a session
+        std::vector<uint64_t> accounts() const;
+        size_t size() const;
+        size_t getCapacity() const;
+        /// @brief flush all the records to the disk
+        void sync();
+    };
+
+};
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file Task.h
+ * @author maxwellzs
+ * @brief this file defines the c++20 coroutine task used to write multi step flows,
+ * e.g. login with captcha and device lock, as straight line code
+ * the frames of the coroutines are allocated from a per thread pool, a flow
+ * waiting for a response costs its frame instead of a thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <coroutine>
+#include "net/EventLoop.h"
+
+#ifndef Task_h
+#define Task_h
+
+namespace QQDommy
+{
+
+    /// @brief frames are rounded up to a multiple of this size
+    const static size_t FRAME_SIZE_CLASS = 64;
+    /// @brief frames larger than FRAME_SIZE_CLASS * FRAME_SIZE_CLASSES bypass the pool
+    const static size_t FRAME_SIZE_CLASSES = 32;
+    /// @brief the number of free frames kept per size class and thread
+    const static size_t FRAME_POOL_LIMIT = 4096;
+
+    /**
+     * @brief the per thread free lists of coroutine frames
+     *
+     */
+    class FramePool
+    {
+    private:
+        struct FreeFrame
+        {
+            FreeFrame *next;
+        };
+        FreeFrame *freeLists[FRAME_SIZE_CLASSES] = {};
+        size_t freeCounts[FRAME_SIZE_CLASSES] = {};
+        static FramePool &local();
+
+    public:
+        FramePool() = default;
+        ~FramePool();
+        static void *allocate(size_t size);
+        static void release(void *frame, size_t size);
+    };
+
+    /**
+     * @brief the part of the promise shared by every task
+     * the frame of every task comes from the pool
+     *
+     */
+    class TaskPromiseBase
+    {
+    public:
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+        /// @brief a detached task destroys itself when it finishes
+        bool detached = false;
+
+        static void *operator new(size_t size);
+        static void operator delete(void *frame, size_t size);
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        void unhandled_exception() { error = std::current_exception(); }
+
+        /**
+         * @brief resumes the awaiting coroutine, or frees a detached task
+         *
+         */
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+            template <typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept
+            {
+                TaskPromiseBase &promise = handle.promise();
+                if (promise.continuation)
+                    return promise.continuation;
+                // no one can observe a detached task, an escaped exception is dropped
+                if (promise.detached)
+                    handle.destroy();
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+    };
+
+    template <typename T>
+    class Task;
+
+    template <typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+        std::optional<T> value;
+        Task<T> get_return_object();
+        void return_value(T result) { value.emplace(std::move(result)); }
+        T result()
+        {
+            if (error)
+                std::rethrow_exception(error);
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+        Task<void> get_return_object();
+        void return_void() {}
+        void result()
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+
+    /**
+     * @brief a lazy coroutine, it starts when awaited or detached
+     * a task awaiting another one is resumed by symmetric transfer, the stack does not grow
+     *
+     * @tparam T the type returned by co_return
+     */
+    template <typename T = void>
+    class Task
+    {
+    public:
+        typedef TaskPromise<T> promise_type;
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+
+    public:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+        Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Task &operator=(Task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle)
+                    handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+        ~Task()
+        {
+            if (handle)
+                handle.destroy();
+        }
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+        {
+            handle.promise().continuation = caller;
+            return handle;
+        }
+        T await_resume() { return handle.promise().result(); }
+
+        /**
+         * @brief give up the ownership, the task frees itself when finished
+         *
+         * @return std::coroutine_handle<> the handle to resume to start the task
+         */
+        std::coroutine_handle<> detach()
+        {
+            handle.promise().detached = true;
+            return std::exchange(handle, nullptr);
+        }
+        bool done() const { return !handle || handle.done(); }
+    };
+
+    template <typename T>
+    Task<T> TaskPromise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+
+    /**
+     * @brief start the task on the thread of the loop, can be called from any thread
+     *
+     * @param loop the loop running the task
+     * @param task the task, detached
+     * @return true if posted
+     * @return false if the mailbox of the loop is full, the task is destroyed
+     */
+    bool spawn(EventLoop &loop, Task<void> task);
+
+};
+
+#endif
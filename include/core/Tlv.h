@@ -24,6 +24,67 @@ namespace QQDommy
         void visit(ByteBuffer &ref) const override;
     };
 
+    /// @brief the size of tag + length
+    const static size_t TLV_HEADER_SIZE = 4;
+
+    /**
+     * @brief writes a tlv holding raw bytes: | tag u16 | length u16 | value |
+     *
+     */
+    class BytesTlvPack : public BufferVisitor
+    {
+    private:
+        uint16_t tag;
+        const uint8_t *value;
+        size_t length;
+
+    public:
+        /**
+         * @brief Construct a new Bytes Tlv Pack object, the value is not copied
+         * throws BufferOutOfBoundException if the value is longer than UINT16_MAX
+         *
+         * @param tag the tag of the tlv
+         * @param value the value, must outlive the visit
+         * @param length the length of the value
+         */
+        BytesTlvPack(uint16_t tag, const uint8_t *value, size_t length);
+        BytesTlvPack(uint16_t tag, const ByteBuffer &value);
+        void visit(ByteBuffer &ref) const override;
+    };
+
+    /**
+     * @brief writes a tlv holding a big endian u64, e.g. the uin
+     *
+     */
+    class Uint64TlvPack : public BufferVisitor
+    {
+    private:
+        uint16_t tag;
+        uint64_t value;
+
+    public:
+        Uint64TlvPack(uint16_t tag, uint64_t value);
+        void visit(ByteBuffer &ref) const override;
+    };
+
+    class TlvReader
+    {
+    private:
+        TlvReader();
+
+    public:
+        /**
+         * @brief read the next tlv of the buffer
+         *
+         * @param in the buffer holding the tlvs, the tlv is consumed
+         * @param tag the tag read
+         * @param value a READ ONLY view of the value inside the buffer
+         * @return true if a tlv was read
+         * @return false if the buffer has no complete tlv left
+         */
+        static bool next(ByteBuffer &in, uint16_t &tag, ByteBuffer &value);
+    };
+
 };
 
 #endif
\ No newline at end of file
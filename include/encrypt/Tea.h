@@ -0,0 +1,82 @@
+/**
+ * @file Tea.h
+ * @author maxwellzs
+ * @brief this file defines the 16 round tea cipher used by oicq
+ * the plain text is padded with random bytes to a multiple of 8 and chained
+ * block by block the way qq does it
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <exception>
+#include "utils/ByteBuffer.h"
+
+#ifndef Tea_h
+#define Tea_h
+
+namespace QQDommy
+{
+
+    const static size_t TEA_KEY_SIZE = 16;
+    const static uint32_t TEA_DELTA = 0x9E3779B9;
+
+    /**
+     * @brief thrown when the cipher text can not be decrypted with the key
+     *
+     */
+    class TeaDecryptException : public std::exception
+    {
+    public:
+        const char *what() const noexcept override;
+    };
+
+    class TeaCipher
+    {
+    private:
+        uint32_t key[4];
+        /// @brief state of the padding generator, padding does not need to be secure
+        uint64_t seed;
+        uint64_t encodeBlock(uint64_t block) const;
+        uint64_t decodeBlock(uint64_t block) const;
+        uint32_t nextRandom();
+
+    public:
+        /**
+         * @brief Construct a new Tea Cipher object
+         *
+         * @param key the 16 bytes key
+         */
+        TeaCipher(const uint8_t *key);
+        /**
+         * @brief the length of the cipher text of a plain text
+         *
+         * @param length the length of the plain text
+         * @return size_t the length after padding
+         */
+        static size_t encryptedLength(size_t length);
+        /**
+         * @brief encrypt and append the cipher text to the buffer
+         *
+         * @param out where the cipher text is written
+         * @param data the plain text
+         * @param length the length of the plain text
+         */
+        void encrypt(ByteBuffer &out, const uint8_t *data, size_t length);
+        /**
+         * @brief decrypt and append the plain text to the buffer
+         * throws TeaDecryptException if the data is not a cipher text of this key
+         *
+         * @param out where the plain text is written
+         * @param data the cipher text
+         * @param length the length of the cipher text
+         */
+        void decrypt(ByteBuffer &out, const uint8_t *data, size_t length) const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file Zlib.h
+ * @author maxwellzs
+ * @brief this file defines the streaming adapters of the system zlib over byte buffers
+ * the compressed bytes are read from a buffer or a view, the output is produced
+ * straight into the writable part of the output buffer, no intermediate copy is made
+ * one adapter keeps its zlib state and is reset for the next payload, so a connection
+ * pays the allocation of the window once
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <exception>
+#include <zlib.h>
+#include "utils/ByteBuffer.h"
+
+#ifndef Zlib_h
+#define Zlib_h
+
+namespace QQDommy
+{
+
+    /// @brief the least room given to zlib at once
+    const static size_t ZLIB_CHUNK = 16 * 1024;
+    /// @brief the largest payload inflated by default, a pushed message is far smaller
+    const static size_t DEFAULT_INFLATE_LIMIT = 16 * 1024 * 1024;
+
+    typedef enum
+    {
+        /// @brief the zlib header and adler32, used by qq
+        ZLIB_FORMAT_ZLIB,
+        ZLIB_FORMAT_GZIP,
+        /// @brief bare deflate blocks
+        ZLIB_FORMAT_RAW
+    } ZLIB_FORMAT;
+
+    /**
+     * @brief thrown when the data is corrupt or the output exceeds its limit
+     *
+     */
+    class ZlibException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        ZlibException(const std::string &msg);
+        const char *what() const noexcept override;
+    };
+
+    class Inflater
+    {
+    private:
+        z_stream stream = {};
+        size_t limit;
+        /// @brief the end of the stream was reached, the next call starts a new one
+        bool finished = false;
+
+    public:
+        /**
+         * @brief Construct a new Inflater object
+         *
+         * @param limit the most bytes one stream may inflate to
+         * @param format the format of the compressed data
+         */
+        explicit Inflater(size_t limit = DEFAULT_INFLATE_LIMIT, ZLIB_FORMAT format = ZLIB_FORMAT_ZLIB);
+        ~Inflater();
+        Inflater(const Inflater &) = delete;
+        Inflater &operator=(const Inflater &) = delete;
+        /**
+         * @brief inflate the next part of a stream, the output is appended
+         * throws ZlibException if the data is corrupt or the output exceeds the limit,
+         * the output already appended for the stream is kept
+         *
+         * @param data the compressed bytes
+         * @param length the number of compressed bytes
+         * @param out the output buffer
+         * @param sizeHint the expected size of the output, reserved up front to avoid a reallocation
+         * @return size_t the compressed bytes consumed, less than length at the end of the stream
+         * or past 4GB of input
+         */
+        size_t inflate(const uint8_t *data, size_t length, ByteBuffer &out, size_t sizeHint = 0);
+        /**
+         * @brief inflate the readable bytes of a buffer, the bytes consumed are skipped
+         * the bytes after the end of the stream are left in the buffer
+         *
+         * @param in the compressed bytes
+         * @param out the output buffer
+         * @param sizeHint the expected size of the output
+         * @return true the end of the stream was reached
+         * @return false more input is needed
+         */
+        bool inflate(ByteBuffer &in, ByteBuffer &out, size_t sizeHint = 0);
+        /// @brief whether the last call reached the end of the stream
+        bool done() const;
+        /// @brief drop the stream in progress, the state is kept for the next one
+        void reset();
+        /// @brief the bytes produced by the stream so far
+        size_t totalOut() const;
+    };
+
+    class Deflater
+    {
+    private:
+        z_stream stream = {};
+        void run(const uint8_t *data, size_t length, ByteBuffer &out, int flush);
+
+    public:
+        /**
+         * @brief Construct a new Deflater object
+         *
+         * @param level from 0 to 9, Z_DEFAULT_COMPRESSION is 6
+         * @param format the format of the compressed data
+         */
+        explicit Deflater(int level = Z_DEFAULT_COMPRESSION, ZLIB_FORMAT format = ZLIB_FORMAT_ZLIB);
+        ~Deflater();
+        Deflater(const Deflater &) = delete;
+        Deflater &operator=(const Deflater &) = delete;
+        /**
+         * @brief compress the next part of a stream, zlib may keep it until more comes
+         *
+         * @param data the bytes
+         * @param length the number of bytes
+         * @param out the compressed bytes are appended
+         */
+        void deflate(const uint8_t *data, size_t length, ByteBuffer &out);
+        /// @brief compress all the readable bytes of a buffer, they are skipped
+        void deflate(ByteBuffer &in, ByteBuffer &out);
+        /**
+         * @brief write what zlib keeps and the end of the stream, the deflater is reset
+         *
+         * @param out the compressed bytes are appended
+         */
+        void finish(ByteBuffer &out);
+        /**
+         * @brief compress a whole payload into one stream
+         *
+         * @param data the bytes
+         * @param length the number of bytes
+         * @param out the compressed bytes are appended
+         */
+        void compress(const uint8_t *data, size_t length, ByteBuffer &out);
+        /// @brief drop the stream in progress, the state is kept for the next one
+        void reset();
+    };
+
+};
+
+#endif
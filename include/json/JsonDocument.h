@@ -0,0 +1,206 @@
+/**
+ * @file JsonDocument.h
+ * @author maxwellzs
+ * @brief this file defines a json parser writing a whole document into one arena
+ * the text is parsed in place, strings are views into it and escapes are decoded over
+ * the escaped text, arrays and objects are flat arrays of values and members
+ * a larger object also gets its members sorted by key, looked up by binary search
+ * releasing a document frees no value one by one, the arena is reset at once
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <exception>
+#include "utils/Arena.h"
+
+#ifndef JsonDocument_h
+#define JsonDocument_h
+
+namespace QQDommy
+{
+
+    /// @brief the deepest nesting of arrays and objects accepted
+    const static size_t JSON_MAX_DEPTH = 512;
+    /// @brief an object with this many members is indexed by key, a smaller one is searched in order
+    const static size_t JSON_INDEX_MEMBERS = 8;
+
+    typedef enum
+    {
+        JSON_NULL,
+        JSON_BOOLEAN,
+        JSON_INTEGER,
+        JSON_FLOAT,
+        JSON_STRING,
+        JSON_ARRAY,
+        JSON_OBJECT,
+        /// @brief returned by a lookup that found nothing
+        JSON_INVALID
+    } JSON_TYPE;
+
+    /**
+     * @brief thrown when the text is not valid json
+     *
+     */
+    class JsonParseException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        /**
+         * @brief Construct a new Json Parse Exception object
+         *
+         * @param reason what was wrong
+         * @param offset where in the text it was found
+         */
+        JsonParseException(const std::string &reason, size_t offset);
+        const char *what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT override;
+    };
+
+    struct JsonMember;
+
+    /**
+     * @brief a value of a document, only valid as long as the document and its text
+     * a lookup which finds nothing returns an invalid value instead of throwing,
+     * so lookups can be chained and the accessors return their fallback
+     *
+     */
+    class JsonValue
+    {
+        friend class JsonDocument;
+
+    private:
+        JSON_TYPE type = JSON_INVALID;
+        /// @brief the bytes of a string, the values of an array or the members of an object
+        uint32_t length = 0;
+        union
+        {
+            bool boolean;
+            int64_t integer;
+            double number;
+            const char *text;
+            const JsonValue *values;
+            const JsonMember *members;
+        };
+
+    public:
+        JsonValue() : integer(0) {}
+        JSON_TYPE getType() const { return type; }
+        bool isValid() const { return type != JSON_INVALID; }
+        bool isNull() const { return type == JSON_NULL; }
+        bool isObject() const { return type == JSON_OBJECT; }
+        bool isArray() const { return type == JSON_ARRAY; }
+        bool isString() const { return type == JSON_STRING; }
+        /// @brief an integer or a float
+        bool isNumber() const { return type == JSON_INTEGER || type == JSON_FLOAT; }
+        /// @brief the number of values of an array or members of an object, 0 for the rest
+        size_t size() const;
+        /**
+         * @brief look up a member of an object, the first of the members with the key
+         *
+         * @param key the key of the member
+         * @return const JsonValue* the value, nullptr if missing or not an object
+         */
+        const JsonValue *find(std::string_view key) const;
+        /// @brief the member of an object, invalid if missing
+        const JsonValue &operator[](std::string_view key) const;
+        /// @brief the member of an object, invalid if missing
+        const JsonValue &operator[](const char *key) const { return (*this)[std::string_view(key)]; }
+        /// @brief the value of an array, invalid if out of bound
+        const JsonValue &operator[](size_t index) const;
+        std::string_view asString(std::string_view fallback = {}) const;
+        /// @brief a float is truncated and clamped
+        int64_t asInteger(int64_t fallback = 0) const;
+        double asFloat(double fallback = 0) const;
+        bool asBoolean(bool fallback = false) const;
+        /// @brief the values of an array, empty for the rest
+        const JsonValue *begin() const;
+        const JsonValue *end() const;
+        /// @brief the members of an object in the order of the text, empty for the rest
+        const JsonMember *memberBegin() const;
+        const JsonMember *memberEnd() const;
+    };
+
+    struct JsonMember
+    {
+        std::string_view key;
+        JsonValue value;
+    };
+
+    class JsonDocument
+    {
+    private:
+        Arena arena;
+        JsonValue rootValue;
+        /// @brief the values and members of the containers still open, kept between parses
+        std::vector<JsonValue> valueStack;
+        std::vector<JsonMember> memberStack;
+        char *begin = nullptr;
+        char *cursor = nullptr;
+        char *end = nullptr;
+
+        /// @brief parse a text without dropping the arena, the text may live in it
+        const JsonValue &parseText(char *text, size_t length);
+        [[noreturn]] void fail(const char *reason) const;
+        void skipSpace();
+        void parseValue(JsonValue &value, size_t depth);
+        void parseArray(JsonValue &value, size_t depth);
+        void parseObject(JsonValue &value, size_t depth);
+        /// @brief the cursor is after the opening quote, decodes the escapes in place
+        std::string_view parseString();
+        void parseNumber(JsonValue &value);
+        void expectWord(const char *word, size_t length);
+
+    public:
+        /**
+         * @brief Construct a new empty Json Document object
+         *
+         * @param blockSize the size of the blocks of the arena
+         */
+        explicit JsonDocument(size_t blockSize = DEFAULT_ARENA_BLOCK);
+        JsonDocument(const JsonDocument &) = delete;
+        JsonDocument &operator=(const JsonDocument &) = delete;
+        /**
+         * @brief parse a text in place, the text is modified and must outlive the values
+         * the values of the previous parse are dropped
+         * throws JsonParseException if the text is not valid json
+         *
+         * @param text the text
+         * @param length the length of the text
+         * @return const JsonValue& the root value
+         */
+        const JsonValue &parseInSitu(char *text, size_t length);
+        /**
+         * @brief copy a text into the arena and parse the copy
+         * throws JsonParseException if the text is not valid json
+         *
+         * @param text the text
+         * @return const JsonValue& the root value
+         */
+        const JsonValue &parse(std::string_view text);
+        /**
+         * @brief read a whole file into the arena and parse it
+         * throws JsonParseException if the text is not valid json
+         *
+         * @param path the path of the file
+         * @return true if the file was read
+         */
+        bool parseFile(const std::string &path);
+        const JsonValue &root() const;
+        /// @brief drop the values, the memory of the arena is kept
+        void clear();
+        /// @brief the bytes of the arena used by the values, and the text if it was copied
+        size_t getArenaUsed() const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file JsonReader.h
+ * @author maxwellzs
+ * @brief this file defines a pull parser fed with the chunks of a json text as they arrive
+ * every call of next returns one event, or JSON_EVENT_MORE when the chunk ends inside a token
+ * the reader keeps only the text not consumed yet and the kinds of the open containers,
+ * no tree is built, so a few fields can be picked from a large document
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "json/JsonDocument.h"
+#include "utils/ByteBuffer.h"
+
+#ifndef JsonReader_h
+#define JsonReader_h
+
+namespace QQDommy
+{
+
+    /// @brief the longest token kept while waiting for its end
+    const static size_t JSON_MAX_TOKEN = 1024 * 1024;
+
+    typedef enum
+    {
+        /// @brief the text fed ends inside a token, feed the next chunk
+        JSON_EVENT_MORE,
+        JSON_EVENT_OBJECT_START,
+        JSON_EVENT_OBJECT_END,
+        JSON_EVENT_ARRAY_START,
+        JSON_EVENT_ARRAY_END,
+        JSON_EVENT_KEY,
+        JSON_EVENT_STRING,
+        JSON_EVENT_INTEGER,
+        JSON_EVENT_FLOAT,
+        JSON_EVENT_BOOLEAN,
+        JSON_EVENT_NULL,
+        /// @brief the document is complete, text fed after it is an error
+        JSON_EVENT_END
+    } JSON_EVENT;
+
+    class JsonReader
+    {
+    private:
+        typedef enum
+        {
+            EXPECT_VALUE,
+            EXPECT_VALUE_OR_END,
+            EXPECT_KEY,
+            EXPECT_KEY_OR_END,
+            EXPECT_COLON,
+            EXPECT_COMMA_OR_END,
+            EXPECT_NOTHING
+        } EXPECT;
+
+        /// @brief the text fed and not consumed yet starts at pos
+        std::string pending;
+        size_t pos = 0;
+        /// @brief the bytes dropped from the front of pending, for the offsets of the errors
+        size_t consumed = 0;
+        /// @brief where the scan of an unterminated string goes on, relative to pos
+        size_t stringScanned = 0;
+        bool stringEscaped = false;
+        bool finished = false;
+        /// @brief '{' or '[' for every open container
+        std::vector<char> containers;
+        EXPECT expect = EXPECT_VALUE;
+        size_t maxToken;
+
+        /// @brief the decoded string or key, when it had escapes
+        std::string decoded;
+        std::string_view token;
+        int64_t integerValue = 0;
+        double floatValue = 0;
+        bool booleanValue = false;
+
+        /// @brief the depth the skip ends at, SIZE_MAX when not skipping
+        size_t skipUntil = SIZE_MAX;
+        JSON_EVENT last = JSON_EVENT_MORE;
+
+        [[noreturn]] void fail(const char *reason) const;
+        void skipSpace();
+        /// @brief after a complete value, inside a container or at the top
+        void valueDone();
+        JSON_EVENT close(char kind);
+        /// @brief the cursor is at the opening quote, false if the string does not end in the text
+        bool readString();
+        bool readNumber(JSON_EVENT &event);
+        bool readWord(const char *word, size_t length);
+        JSON_EVENT step();
+
+    public:
+        /**
+         * @brief Construct a new Json Reader object
+         *
+         * @param maxToken the longest string or number accepted
+         */
+        explicit JsonReader(size_t maxToken = JSON_MAX_TOKEN);
+        /**
+         * @brief append the next chunk of the text
+         * the text and the values of the last event are no longer valid
+         *
+         * @param data the chunk
+         * @param length the length of the chunk
+         */
+        void feed(const char *data, size_t length);
+        /**
+         * @brief append the readable bytes of a buffer, they are skipped in the buffer
+         *
+         * @param chunk the chunk
+         */
+        void feed(ByteBuffer &chunk);
+        /// @brief no more text will be fed, a number at the end of the text is complete
+        void finish();
+        /**
+         * @brief parse the next event
+         * throws JsonParseException if the text is not valid json
+         *
+         * @return JSON_EVENT the event, JSON_EVENT_MORE if more text is needed
+         */
+        JSON_EVENT next();
+        /**
+         * @brief skip the value of the key just read, or the rest of the container just opened
+         * the events skipped are not returned, not even the end of the container
+         *
+         */
+        void skip();
+        /// @brief the key or string of the last event, the text of a number, valid until next or feed
+        std::string_view text() const;
+        int64_t integer() const;
+        /// @brief an integer is converted
+        double number() const;
+        bool boolean() const;
+        /// @brief the number of open containers
+        size_t depth() const;
+        /// @brief the bytes kept for a token which spans the chunks
+        size_t buffered() const;
+        /// @brief drop everything, ready for a new document
+        void reset();
+    };
+
+};
+
+#endif
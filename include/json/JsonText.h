@@ -0,0 +1,74 @@
+/**
+ * @file JsonText.h
+ * @author maxwellzs
+ * @brief this file defines the scanning of json strings and numbers shared by the parsers
+ * a scan only finds where a token ends, so a parser fed in chunks can stop at the end of
+ * a chunk and go on with the next one
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef JsonText_h
+#define JsonText_h
+
+namespace QQDommy
+{
+
+    class JsonText
+    {
+    private:
+        JsonText();
+
+    public:
+        /**
+         * @brief find the end of a string, starting after its opening quote
+         *
+         * @param cursor where to start, left where the scan can go on once more text arrives
+         * @param end the end of the text
+         * @param escaped set if an escape is met
+         * @return const char* the closing quote or a control character, nullptr if the text ends first
+         */
+        static const char *scanString(const char *&cursor, const char *end, bool &escaped);
+        /**
+         * @brief decode the escapes of a string without its quotes, out may be begin
+         * the decoded text is never longer than the escaped one
+         *
+         * @param begin the first character of the string
+         * @param end the closing quote
+         * @param out where the decoded text is written
+         * @param reason set to what was wrong on failure
+         * @param failedAt set to where it was wrong on failure
+         * @return char* the end of the decoded text, nullptr on failure
+         */
+        static char *unescape(const char *begin, const char *end, char *out, const char *&reason, const char *&failedAt);
+        /**
+         * @brief find the end of the characters a number may be made of
+         *
+         * @param cursor the first character of the number
+         * @param end the end of the text
+         * @return const char* the first character which can not be part of a number
+         */
+        static const char *scanNumber(const char *cursor, const char *end);
+        /**
+         * @brief parse a number found by scanNumber
+         * an integer too large for int64_t is parsed as a float
+         *
+         * @param begin the first character
+         * @param end the end of the number
+         * @param integral set if the number is an integer
+         * @param integer set to the value of an integer
+         * @param number set to the value of a float
+         * @return const char* what was wrong, nullptr if it is a json number
+         */
+        static const char *parseNumber(const char *begin, const char *end, bool &integral, int64_t &integer, double &number);
+    };
+
+};
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file JsonWriter.h
+ * @author maxwellzs
+ * @brief this file defines a json serializer writing straight into a byte buffer
+ * the text is produced in one pass as the values are written, nothing is built first
+ * the commas are placed by the writer, strings are escaped in runs and numbers are
+ * formatted in the buffer, a reused buffer makes a document cost no allocation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <bitset>
+#include <type_traits>
+#include "utils/ByteBuffer.h"
+#include "json/JsonDocument.h"
+
+#ifndef JsonWriter_h
+#define JsonWriter_h
+
+namespace QQDommy
+{
+
+    class JsonWriter
+    {
+    private:
+        ByteBuffer &out;
+        /// @brief set for the containers which already have a value, one bit per depth
+        std::bitset<JSON_MAX_DEPTH + 1> filled;
+        size_t level = 0;
+        /// @brief a key was written, the value goes without a comma
+        bool keyed = false;
+
+        /// @brief write the comma before a value if needed
+        void separate();
+        void open(char bracket);
+        void close(char bracket);
+        void writeString(std::string_view text);
+        void writeSigned(int64_t number);
+        void writeUnsigned(uint64_t number);
+
+    public:
+        /**
+         * @brief Construct a new Json Writer object appending to a buffer
+         *
+         * @param out the buffer, the text is appended after its content
+         */
+        explicit JsonWriter(ByteBuffer &out);
+        JsonWriter &beginObject();
+        JsonWriter &endObject();
+        JsonWriter &beginArray();
+        JsonWriter &endArray();
+        /**
+         * @brief write the key of the next value, only inside an object
+         *
+         * @param name the key, escaped if needed
+         * @return JsonWriter& this writer
+         */
+        JsonWriter &key(std::string_view name);
+        JsonWriter &value(std::string_view text);
+        JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+        JsonWriter &value(const std::string &text) { return value(std::string_view(text)); }
+        JsonWriter &value(bool boolean);
+        /// @brief infinity and nan are written as null
+        JsonWriter &value(double number);
+        template <typename T>
+        std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, JsonWriter &> value(T number)
+        {
+            separate();
+            if constexpr (std::is_signed_v<T>)
+                writeSigned((int64_t)number);
+            else
+                writeUnsigned((uint64_t)number);
+            return *this;
+        }
+        /// @brief write a value of a parsed document with all it contains
+        JsonWriter &value(const JsonValue &json);
+        JsonWriter &null();
+        /**
+         * @brief write a key and its value
+         *
+         * @param name the key
+         * @param content the value
+         * @return JsonWriter& this writer
+         */
+        template <typename T>
+        JsonWriter &field(std::string_view name, const T &content)
+        {
+            return key(name).value(content);
+        }
+        /**
+         * @brief write a text which is already json, e.g. a cached part of a document
+         *
+         * @param json the text
+         * @return JsonWriter& this writer
+         */
+        JsonWriter &raw(std::string_view json);
+        /// @brief the number of open containers
+        size_t depth() const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file BatchedStream.h
+ * @author maxwellzs
+ * @brief this file defines the output streams of the in tree loggers
+ * the lines are gathered into large batches, a writer thread of the stream writes
+ * all the batches waiting with one writev, the file stream also rotates in that thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "LogStream.h"
+
+#ifndef BatchedStream_h
+#define BatchedStream_h
+
+namespace QQDommy
+{
+
+    const static size_t DEFAULT_BATCH_BYTES = 64 * 1024;
+    const static int DEFAULT_FLUSH_MS = 200;
+    /// @brief the logging thread waits when the writer is this far behind
+    const static size_t MAX_PENDING_BYTES = 16 * 1024 * 1024;
+
+    class BatchedStream : public LogCPP::BaseStream
+    {
+    private:
+        /// @brief filled by the logging thread
+        std::string active;
+        size_t batchBytes;
+        int flushIntervalMs;
+        int64_t lastFlushMs;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        /// @brief the batches handed to the writer
+        std::vector<std::string> pending;
+        /// @brief written batches kept for reuse
+        std::vector<std::string> spare;
+        size_t pendingBytes = 0;
+        /// @brief the batches the writer is writing now
+        size_t writing = 0;
+        bool stopping = false;
+        std::thread writer;
+
+        std::atomic<uint64_t> lines{0};
+        std::atomic<uint64_t> writeCalls{0};
+        std::atomic<uint64_t> bytesWritten{0};
+
+        void run();
+        void writeAll(std::vector<std::string> &batches);
+        /// @brief one writev for the batches in [begin, end), continued after a partial write
+        void writeRange(std::vector<std::string> &batches, size_t begin, size_t end);
+
+    protected:
+        int fd;
+        /**
+         * @brief called by the writer for every batch before it is written
+         *
+         * @param bytes the size of the batch
+         * @return true if the file must be rotated before the batch, the batch is accounted again after
+         */
+        virtual bool account(size_t /*bytes*/) { return false; }
+        /// @brief called by the writer between two batches when account asked for it
+        virtual void rotateFile() {}
+        /// @brief start the writer, called by the constructor of the subclass once fd is set
+        void start();
+        /// @brief stop the writer after writing everything, called by the destructor of the subclass
+        void stop();
+
+    public:
+        /**
+         * @brief Construct a new Batched Stream object
+         *
+         * @param batchBytes a batch is handed to the writer once this large
+         * @param flushIntervalMs a smaller batch is handed over once this old, see poll
+         */
+        BatchedStream(size_t batchBytes, int flushIntervalMs);
+        virtual ~BatchedStream();
+        BatchedStream(const BatchedStream &) = delete;
+        BatchedStream &operator=(const BatchedStream &) = delete;
+        /// @brief append a line, NOT thread safe, only the thread of the logger writes into a stream
+        LogCPP::BaseStream &operator<<(const std::string &content) override;
+        /// @brief hand the current batch to the writer
+        void flush();
+        /// @brief flush if the batch is older than the interval, called by the logger when idle
+        void poll();
+        /// @brief flush and wait until everything is written
+        void sync();
+        uint64_t getLines() const;
+        uint64_t getWriteCalls() const;
+        uint64_t getBytesWritten() const;
+    };
+
+    class BatchedConsoleStream : public BatchedStream
+    {
+    public:
+        BatchedConsoleStream(size_t batchBytes = DEFAULT_BATCH_BYTES, int flushIntervalMs = DEFAULT_FLUSH_MS);
+        ~BatchedConsoleStream();
+    };
+
+    struct FileRotation
+    {
+        /// @brief rotate before the file grows over this, 0 never
+        size_t maxBytes = 0;
+        /// @brief rotate when the local date changes
+        bool daily = false;
+        /// @brief the rotated files kept, the oldest are deleted, 0 keeps all
+        size_t maxFiles = 0;
+    };
+
+    /**
+     * @brief appends to a file, a rotated file is renamed to path.YYYYmmdd-HHMMSS
+     *
+     */
+    class BatchedFileStream : public BatchedStream
+    {
+    private:
+        std::string path;
+        FileRotation rotation;
+        size_t fileBytes = 0;
+        /// @brief the local date the file was opened on, yyyymmdd
+        int fileDay = 0;
+        /// @brief open the file at path, fd stays -1 and the failure is counted if it can not be opened
+        void openFile();
+        void prune();
+
+    protected:
+        bool account(size_t bytes) override;
+        void rotateFile() override;
+
+    public:
+        /**
+         * @brief Construct a new Batched File Stream object
+         * throws LogFileOpenException if the file can not be opened
+         *
+         * @param path the file
+         * @param rotation when to rotate
+         * @param batchBytes a batch is handed to the writer once this large
+         * @param flushIntervalMs a smaller batch is handed over once this old
+         */
+        BatchedFileStream(const std::string &path, const FileRotation &rotation = FileRotation(),
+                          size_t batchBytes = DEFAULT_BATCH_BYTES, int flushIntervalMs = DEFAULT_FLUSH_MS);
+        ~BatchedFileStream();
+    };
+
+};
+
+#endif
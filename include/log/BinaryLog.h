@@ -0,0 +1,298 @@
+/**
+ * @file BinaryLog.h
+ * @author maxwellzs
+ * @brief this file defines the binary logging mode
+ * the caller only writes the id of a static format, a TscClock tick and the raw
+ * arguments into a ring owned by its thread, the daemon of the ring logger
+ * formats the records later and writes them into the usual streams
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "Elements.h"
+#include "utils/TscClock.h"
+#include "log/LogRing.h"
+
+#ifndef BinaryLog_h
+#define BinaryLog_h
+
+namespace QQDommy
+{
+
+    class RingLogger;
+
+    const static size_t DEFAULT_BINARY_RING_SIZE = 1 << 18;
+    /// @brief the formats a process can have, each call site of the macros is one
+    const static size_t MAX_LOG_FORMATS = 1 << 16;
+    /// @brief longer string arguments are cut
+    const static size_t BINARY_STRING_LIMIT = 4096;
+    const static size_t BINARY_RECORD_ALIGN = 16;
+
+    /// @brief the type tag written before every argument
+    typedef enum
+    {
+        ARG_INT32 = 1,
+        ARG_UINT32,
+        ARG_INT64,
+        ARG_UINT64,
+        ARG_DOUBLE,
+        ARG_STRING,
+        ARG_POINTER
+    } BINARY_ARG;
+
+    /**
+     * @brief a printf format and where it is logged, one static object per call site
+     *
+     */
+    struct LogFormat
+    {
+        LogCPP::LEVELS level;
+        const char *format;
+        const char *file;
+        int line;
+        /// @brief 0 if the registry is full, such records are dropped
+        uint32_t id;
+        LogFormat(LogCPP::LEVELS level, const char *format, const char *file, int line);
+    };
+
+    struct BinaryRecordHeader
+    {
+        /// @brief 0 marks the padding before the ring wraps
+        uint32_t formatId;
+        /// @brief the whole record with the header, a multiple of BINARY_RECORD_ALIGN
+        uint32_t length;
+        uint64_t ticks;
+    };
+
+    /**
+     * @brief the records of one thread, it is the only producer and the daemon the only consumer
+     *
+     */
+    class BinaryLogRing
+    {
+    private:
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity;
+        /// @brief the padding written by the last reserve
+        size_t padding = 0;
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+
+    public:
+        /// @brief set by the thread when it exits, the daemon frees the ring once drained
+        std::atomic<bool> closed{false};
+        /// @brief set when the daemon is gone, the producer stops waiting for space
+        std::atomic<bool> abandoned{false};
+        /// @brief the ring the daemon sleeps on, woken after a commit, nullptr once the daemon is gone
+        std::atomic<LogRing *> consumer{nullptr};
+
+        /**
+         * @brief Construct a new Binary Log Ring object
+         *
+         * @param size the bytes of the ring, rounded up to a power of 2
+         */
+        explicit BinaryLogRing(size_t size);
+        /**
+         * @brief reserve a contiguous record, only called by the owning thread
+         *
+         * @param length the length of the record, aligned
+         * @return uint8_t* where the record is written, nullptr if the ring is full
+         */
+        uint8_t *reserve(size_t length)
+        {
+            uint64_t pos = head.load(std::memory_order_relaxed);
+            size_t offset = pos & (capacity - 1);
+            size_t room = capacity - offset;
+            padding = room < length ? room : 0;
+            if (pos + padding + length - tail.load(std::memory_order_acquire) > capacity)
+                return nullptr;
+            if (padding > 0)
+            {
+                BinaryRecordHeader pad = {0, (uint32_t)padding, 0};
+                memcpy(&data[offset], &pad, sizeof(pad));
+                offset = 0;
+            }
+            return &data[offset];
+        }
+        /// @brief publish the record reserved last
+        void commit(size_t length)
+        {
+            head.store(head.load(std::memory_order_relaxed) + padding + length, std::memory_order_release);
+            // the daemon sleeps on its text ring, it is only woken if it went to sleep
+            LogRing *sleeper = consumer.load(std::memory_order_acquire);
+            if (sleeper != nullptr)
+                sleeper->wake();
+        }
+        /**
+         * @brief visit the published records, only called by the daemon
+         * the records stay valid until release
+         *
+         * @tparam F void(const BinaryRecordHeader &, const uint8_t *args, size_t argsLength)
+         * @param visit called for every record
+         * @return uint64_t the position to release up to
+         */
+        template <typename F>
+        uint64_t peek(F &&visit)
+        {
+            uint64_t end = head.load(std::memory_order_acquire);
+            for (uint64_t pos = tail.load(std::memory_order_relaxed); pos < end;)
+            {
+                const uint8_t *record = &data[pos & (capacity - 1)];
+                BinaryRecordHeader header;
+                memcpy(&header, record, sizeof(header));
+                if (header.formatId != 0)
+                    visit(header, record + sizeof(header), header.length - sizeof(header));
+                pos += header.length;
+            }
+            return end;
+        }
+        void release(uint64_t pos);
+        bool empty() const;
+        size_t getCapacity() const;
+    };
+
+    class BinaryLog
+    {
+    private:
+        static inline thread_local BinaryLogRing *threadRing = nullptr;
+        BinaryLog();
+        static BinaryLogRing *attachThread();
+        /// @brief wait for the daemon while the ring is full
+        static uint8_t *waitForSpace(BinaryLogRing *ring, size_t length);
+
+        template <typename T>
+        static size_t argSize(const T &value)
+        {
+            typedef std::decay_t<T> D;
+            static_assert(!std::is_same_v<D, long double>, "long double can not be logged in binary");
+            if constexpr (std::is_same_v<D, char *> || std::is_same_v<D, const char *>)
+            {
+                size_t length = value == nullptr ? 0 : strnlen(value, BINARY_STRING_LIMIT);
+                return 1 + sizeof(uint32_t) + length;
+            }
+            else if constexpr (std::is_pointer_v<D>)
+                return 1 + sizeof(void *);
+            else if constexpr (std::is_floating_point_v<D>)
+                return 1 + sizeof(double);
+            else
+            {
+                static_assert(std::is_integral_v<D> || std::is_enum_v<D>, "only the arguments of printf can be logged in binary");
+                return 1 + (sizeof(D) > 4 ? 8 : 4);
+            }
+        }
+
+        template <typename T>
+        static void writeArg(uint8_t *&p, const T &value)
+        {
+            typedef std::decay_t<T> D;
+            if constexpr (std::is_same_v<D, char *> || std::is_same_v<D, const char *>)
+            {
+                uint32_t length = value == nullptr ? 0 : (uint32_t)strnlen(value, BINARY_STRING_LIMIT);
+                *p++ = ARG_STRING;
+                memcpy(p, &length, sizeof(length));
+                memcpy(p + sizeof(length), value, length);
+                p += sizeof(length) + length;
+            }
+            else if constexpr (std::is_pointer_v<D>)
+            {
+                const void *pointer = value;
+                *p++ = ARG_POINTER;
+                memcpy(p, &pointer, sizeof(pointer));
+                p += sizeof(pointer);
+            }
+            else if constexpr (std::is_floating_point_v<D>)
+            {
+                double number = value;
+                *p++ = ARG_DOUBLE;
+                memcpy(p, &number, sizeof(number));
+                p += sizeof(number);
+            }
+            else if constexpr (sizeof(D) > 4)
+            {
+                uint64_t number = (uint64_t)value;
+                *p++ = std::is_signed_v<D> ? ARG_INT64 : ARG_UINT64;
+                memcpy(p, &number, sizeof(number));
+                p += sizeof(number);
+            }
+            else
+            {
+                // promoted the way printf promotes them
+                uint32_t number = std::is_signed_v<D> ? (uint32_t)(int32_t)value : (uint32_t)value;
+                *p++ = std::is_signed_v<D> || sizeof(D) < 4 ? ARG_INT32 : ARG_UINT32;
+                memcpy(p, &number, sizeof(number));
+                p += sizeof(number);
+            }
+        }
+
+    public:
+        /**
+         * @brief record a log, use the *_BIN macros rather than calling it
+         * the strings are copied, the formatting is left to the daemon
+         *
+         * @param format the static format of the call site
+         * @param args the arguments of the format
+         */
+        template <typename... Args>
+        static void log(const LogFormat &format, const Args &...args)
+        {
+            BinaryLogRing *ring = threadRing;
+            if (ring == nullptr && (ring = attachThread()) == nullptr)
+                return;
+            if (format.id == 0)
+                return;
+            size_t length = sizeof(BinaryRecordHeader) + (argSize(args) + ... + 0);
+            length = (length + BINARY_RECORD_ALIGN - 1) & ~(BINARY_RECORD_ALIGN - 1);
+            uint8_t *p = ring->reserve(length);
+            if (p == nullptr && (p = waitForSpace(ring, length)) == nullptr)
+                return;
+            BinaryRecordHeader header = {format.id, (uint32_t)length, TscClock::now()};
+            memcpy(p, &header, sizeof(header));
+            p += sizeof(header);
+            (writeArg(p, args), ...);
+            ring->commit(length);
+        }
+        /**
+         * @brief register a format, called once per call site
+         *
+         * @param format the format, it must live as long as the process
+         * @return uint32_t the id, 0 if there are too many formats
+         */
+        static uint32_t registerFormat(const LogFormat *format);
+        static const LogFormat *getFormat(uint32_t id);
+        /**
+         * @brief append a record formatted with its printf format
+         *
+         * @param out where the text is appended
+         * @param format the printf format
+         * @param args the binary arguments
+         * @param length the length of the arguments, the padding after them is ignored
+         */
+        static void format(std::string &out, const char *format, const uint8_t *args, size_t length);
+        /**
+         * @brief set the size of the rings of the threads which did not log yet
+         *
+         * @param size the bytes of a ring
+         */
+        static void setRingSize(size_t size);
+        /**
+         * @brief set the logger whose daemon formats the records, the instance of RingLogger by default
+         * only affects the threads which did not log yet
+         *
+         * @param logger the logger
+         */
+        static void setTarget(RingLogger *logger);
+    };
+
+};
+
+#endif
@@ -0,0 +1,65 @@
+/**
+ * @file LogBuilder.h
+ * @author maxwellzs
+ * @brief this file defines how the stream and format style logging macros build
+ * their message, only done once the level passed the filter
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <type_traits>
+
+#ifndef LogBuilder_h
+#define LogBuilder_h
+
+namespace QQDommy
+{
+
+    class LogBuilder
+    {
+    private:
+        std::string text;
+        void appendSigned(long long value);
+        void appendUnsigned(unsigned long long value);
+        void appendDouble(double value);
+
+    public:
+        LogBuilder();
+        LogBuilder &operator<<(const std::string &value);
+        LogBuilder &operator<<(std::string_view value);
+        LogBuilder &operator<<(const char *value);
+        LogBuilder &operator<<(char value);
+        LogBuilder &operator<<(bool value);
+        LogBuilder &operator<<(const void *value);
+        /// @brief all the integers and floating points, without going through iostream
+        template <typename T>
+        std::enable_if_t<std::is_arithmetic_v<T>, LogBuilder &> operator<<(T value)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                appendDouble(value);
+            else if constexpr (std::is_signed_v<T>)
+                appendSigned(value);
+            else
+                appendUnsigned(value);
+            return *this;
+        }
+        const std::string &str() const;
+        /**
+         * @brief build a message the printf way
+         *
+         * @param format the printf format
+         * @param ... the arguments
+         * @return std::string the message
+         */
+        static std::string format(const char *format, ...) __attribute__((format(printf, 1, 2)));
+    };
+
+};
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file LogElements.h
+ * @author maxwellzs
+ * @brief this file defines the elements of the in tree loggers that need the time
+ * a message was logged rather than the time it is written
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <cstdint>
+#include "Elements.h"
+
+#ifndef LogElements_h
+#define LogElements_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief writes the time set before the compile, in the strftime format of TimeElement
+     *
+     */
+    class RecordTimeElement : public LogCPP::BaseElement
+    {
+    private:
+        std::string format;
+        int64_t timeNs = 0;
+
+    public:
+        RecordTimeElement(const std::string &format);
+        /**
+         * @brief set the time the next compile writes
+         *
+         * @param ns nanoseconds since the epoch
+         */
+        void setTime(int64_t ns);
+        const std::string &getFormat() const;
+        void CompileElement(std::string &builder) override;
+    };
+
+};
+
+#endif
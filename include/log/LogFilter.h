@@ -0,0 +1,71 @@
+/**
+ * @file LogFilter.h
+ * @author maxwellzs
+ * @brief this file defines the minimum level checked by the logging macros
+ * before the message is evaluated, a filtered log costs one relaxed load
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <atomic>
+#include <string>
+#include "Elements.h"
+
+#ifndef LogFilter_h
+#define LogFilter_h
+
+/// @brief levels below it are compiled out of the macros, e.g. -DQQ_LOG_MIN_LEVEL=1 drops DEBUG
+#ifndef QQ_LOG_MIN_LEVEL
+#define QQ_LOG_MIN_LEVEL 0
+#endif
+
+namespace QQDommy
+{
+
+    class LogFilter
+    {
+    private:
+        static std::atomic<int> minimum;
+        LogFilter();
+
+    public:
+        /**
+         * @brief whether a message of the level is emitted, can be called from any thread
+         *
+         * @param level the level of the message
+         * @return true if the level is at least the minimum
+         */
+        static bool enabled(LogCPP::LEVELS level)
+        {
+            return (int)level >= minimum.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief set the runtime minimum level, it can not go below QQ_LOG_MIN_LEVEL
+         *
+         * @param level the new minimum
+         */
+        static void setMinimum(LogCPP::LEVELS level);
+        static LogCPP::LEVELS getMinimum();
+        /**
+         * @brief parse the name of a level as written in logger.json
+         *
+         * @param name debug, info, warning, error or fatal
+         * @param level receives the level
+         * @return true if the name is a level
+         */
+        static bool parseLevel(const std::string &name, LogCPP::LEVELS &level);
+        /**
+         * @brief the name of a level as written in logger.json
+         *
+         * @param level the level
+         * @return const char* debug, info, warning, error or fatal
+         */
+        static const char *levelName(LogCPP::LEVELS level);
+    };
+
+};
+
+#endif
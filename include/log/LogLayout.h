@@ -0,0 +1,92 @@
+/**
+ * @file LogLayout.h
+ * @author maxwellzs
+ * @brief this file defines the layout of a log line, the elements of logger.json
+ * compiled once into literal segments and fields
+ * the constant elements are rendered once, the time is rendered again only when the second changes
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Elements.h"
+
+#ifndef LogLayout_h
+#define LogLayout_h
+
+namespace QQDommy
+{
+
+    const static size_t LEVEL_COUNT = LogCPP::FATAL + 1;
+
+    typedef enum
+    {
+        SEGMENT_LITERAL,
+        SEGMENT_LEVEL,
+        SEGMENT_TIME
+    } SEGMENT_KIND;
+
+    class LogLayout
+    {
+    private:
+        struct Segment
+        {
+            SEGMENT_KIND kind;
+            /// @brief the text of a literal, the strftime format of a time
+            std::string text;
+            /// @brief the second the cached time belongs to
+            int64_t second;
+            std::string cached;
+        };
+        std::vector<Segment> segments;
+        std::string levels[LEVEL_COUNT];
+
+    public:
+        void clear();
+        /**
+         * @brief append a literal, merged into the literal before it
+         *
+         * @param text the literal
+         */
+        void addLiteral(const std::string &text);
+        /**
+         * @brief append the level field
+         *
+         * @param levelTexts the text of every level
+         */
+        void addLevel(const std::string *levelTexts);
+        /**
+         * @brief append a time field
+         *
+         * @param format the strftime format
+         */
+        void addTime(const std::string &format);
+        /**
+         * @brief compile the elements of a logger into the layout, replaces the old one
+         * the elements other than RecordTimeElement are taken as constants
+         *
+         * @param levelElements the element of every level, compiled first
+         * @param elements the elements after the level
+         */
+        void compile(LogCPP::BaseElement *const *levelElements, const std::vector<LogCPP::BaseElement *> &elements);
+        /**
+         * @brief append a line, NOT thread safe, the time caches are updated
+         *
+         * @param out where the line is appended
+         * @param level the level of the message
+         * @param timeNs the time of the message, nanoseconds since the epoch
+         * @param msg the message
+         * @param length the length of the message
+         */
+        void render(std::string &out, LogCPP::LEVELS level, int64_t timeNs, const char *msg, size_t length);
+        size_t size() const;
+    };
+
+};
+
+#endif
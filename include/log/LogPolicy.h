@@ -0,0 +1,69 @@
+/**
+ * @file LogPolicy.h
+ * @author maxwellzs
+ * @brief this file defines what the ring logger does with a message when its ring is full
+ * every level has its own policy, read from the "queue" section of logger.json
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include "log/LogRing.h"
+#include "log/LogLayout.h"
+
+#ifndef LogPolicy_h
+#define LogPolicy_h
+
+namespace QQDommy
+{
+
+    /// @brief the daemon logs the messages dropped since the last summary at this interval
+    const static int DEFAULT_DROP_SUMMARY_MS = 10000;
+
+    typedef enum
+    {
+        /// @brief wait for the daemon, nothing is lost
+        POLICY_BLOCK,
+        /// @brief drop the message being logged
+        POLICY_DROP_NEWEST,
+        /// @brief drop the oldest message in the ring, whatever its level
+        POLICY_DROP_OLDEST,
+        /// @brief keep `keep` of every `every` messages once the ring is half full, drop the newest when full
+        POLICY_SAMPLE
+    } OVERFLOW_POLICY;
+
+    struct OverflowPolicy
+    {
+        OVERFLOW_POLICY policy = POLICY_BLOCK;
+        uint32_t keep = 1;
+        uint32_t every = 1;
+    };
+
+    struct LogQueueConfig
+    {
+        /// @brief the number of messages the ring holds
+        size_t capacity = DEFAULT_LOG_CAPACITY;
+        OverflowPolicy policies[LEVEL_COUNT];
+        /// @brief 0 turns the summary off
+        int summaryMs = DEFAULT_DROP_SUMMARY_MS;
+    };
+
+    struct LogQueueStats
+    {
+        uint64_t enqueued = 0;
+        /// @brief written into the streams by the daemon
+        uint64_t flushed = 0;
+        uint64_t dropped = 0;
+        uint64_t droppedLevels[LEVEL_COUNT] = {};
+        /// @brief the most messages seen waiting in the ring
+        size_t highWater = 0;
+        size_t capacity = 0;
+    };
+
+};
+
+#endif
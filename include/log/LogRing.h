@@ -0,0 +1,164 @@
+/**
+ * @file LogRing.h
+ * @author maxwellzs
+ * @brief this file defines the bounded multi producer single consumer ring behind the ring logger
+ * the messages are copied into slots allocated once, a producer never takes a lock and
+ * only wakes the consumer when it went to sleep on an empty ring
+ * a producer may also throw away the oldest message to make room for its own
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "Elements.h"
+#include "utils/TscClock.h"
+
+#ifndef LogRing_h
+#define LogRing_h
+
+namespace QQDommy
+{
+
+    const static size_t DEFAULT_LOG_CAPACITY = 8192;
+    /// @brief a slot takes 4 cache lines, longer messages are copied to the heap
+    const static size_t LOG_SLOT_TEXT = 256 - 32;
+
+    struct alignas(64) LogSlot
+    {
+        std::atomic<size_t> sequence;
+        LogCPP::LEVELS level;
+        uint32_t length;
+        /// @brief the TscClock tick of the call
+        uint64_t ticks;
+        /// @brief holds the message when it does not fit into text
+        char *overflow;
+        char text[LOG_SLOT_TEXT];
+    };
+
+    class LogRing
+    {
+    private:
+        std::unique_ptr<LogSlot[]> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        /// @brief advanced by the consumer, and by producers discarding the oldest message
+        alignas(64) std::atomic<size_t> dequeuePos{0};
+        /// @brief the messages consumed by drain, only written by the consumer
+        std::atomic<uint64_t> drained{0};
+        /// @brief the deepest the ring was seen by the consumer
+        std::atomic<size_t> highWater{0};
+        /// @brief the futex the consumer sleeps on, bumped by every wake up
+        alignas(64) std::atomic<uint32_t> signal{0};
+        std::atomic<bool> consumerWaiting{false};
+        /// @brief how many times a producer had to wake the consumer
+        std::atomic<uint64_t> wakeups{0};
+
+        LogSlot *reserve(size_t &pos);
+        void publish(LogSlot *slot, size_t pos);
+        /// @brief claim the oldest published slot, nullptr if the ring is empty
+        LogSlot *claim(size_t &pos);
+        void noteDepth();
+
+    public:
+        /**
+         * @brief Construct a new Log Ring object
+         *
+         * @param capacity the number of slots, rounded up to a power of 2
+         */
+        explicit LogRing(size_t capacity = DEFAULT_LOG_CAPACITY);
+        ~LogRing();
+        LogRing(const LogRing &) = delete;
+        LogRing &operator=(const LogRing &) = delete;
+        /**
+         * @brief copy a message into the ring, can be called from any thread
+         *
+         * @param level the level of the message
+         * @param msg the message
+         * @param length the length of the message
+         * @return true if copied
+         * @return false if the ring is full
+         */
+        bool tryPush(LogCPP::LEVELS level, const char *msg, size_t length);
+        /**
+         * @brief copy a message into the ring, waits for the consumer while the ring is full
+         *
+         * @param level the level of the message
+         * @param msg the message
+         * @param length the length of the message
+         */
+        void push(LogCPP::LEVELS level, const char *msg, size_t length);
+        /**
+         * @brief consume the messages in the ring, only called by the consumer
+         *
+         * @tparam F void(LEVELS, uint64_t ticks, const char *, size_t), the text is only valid during the call
+         * @param consume called for every message in order
+         * @param maxBatch the most messages consumed by this call
+         * @return size_t the number of messages consumed
+         */
+        template <typename F>
+        size_t drain(F &&consume, size_t maxBatch = SIZE_MAX)
+        {
+            noteDepth();
+            size_t count = 0, pos;
+            while (count < maxBatch)
+            {
+                LogSlot *slot = claim(pos);
+                if (slot == nullptr)
+                    break;
+                if (slot->overflow != nullptr)
+                {
+                    consume(slot->level, slot->ticks, slot->overflow, slot->length);
+                    delete[] slot->overflow;
+                    slot->overflow = nullptr;
+                }
+                else
+                    consume(slot->level, slot->ticks, slot->text, slot->length);
+                slot->sequence.store(pos + mask + 1, std::memory_order_release);
+                count++;
+            }
+            if (count > 0)
+                drained.store(drained.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+            return count;
+        }
+        /**
+         * @brief throw away the oldest message to make room, can be called from any thread
+         *
+         * @param level set to the level of the message thrown away
+         * @return true if a message was thrown away
+         * @return false if the ring is empty
+         */
+        bool discardOldest(LogCPP::LEVELS &level);
+        /**
+         * @brief put the consumer to sleep until a message is pushed, only called by the consumer
+         *
+         * @param timeoutMs the longest time to sleep
+         * @param ready optional, whether the other queues of the consumer hold work, looked at once it is marked waiting
+         */
+        void wait(int timeoutMs, const std::function<bool()> &ready = nullptr);
+        /// @brief wake the consumer if it is sleeping
+        void notify();
+        /// @brief wake the consumer if it is sleeping, called by the producers of the other queues it waits for after they publish
+        void wake();
+        bool empty() const;
+        /// @brief the messages waiting in the ring, only a hint while producers are pushing
+        size_t size() const;
+        size_t getCapacity() const;
+        uint64_t getWakeups() const;
+        /// @brief the messages ever pushed into the ring
+        uint64_t getEnqueued() const;
+        /// @brief the messages ever consumed by drain
+        uint64_t getDrained() const;
+        /// @brief the most messages seen waiting at the start of a drain
+        size_t getHighWater() const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file LoggerConfig.h
+ * @author maxwellzs
+ * @brief this file defines the reader of logger.json shared by the in tree loggers
+ * the streams "console" and "file" are batched, a stream may set "batchBytes" and "flushMs",
+ * a file may also set "rotateBytes", "rotateDaily" and "maxFiles"
+ * the optional "queue" sets the "capacity" of the ring logger, the "summaryMs" of its drop summary
+ * and the "policies" of the levels, e.g. "debug": {"policy": "sample", "keep": 1, "every": 10}
+ * the policies are "block", "dropNewest", "dropOldest" and "sample"
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Loggers.h"
+#include "log/LogPolicy.h"
+#include "log/LogElements.h"
+
+#ifndef LoggerConfig_h
+#define LoggerConfig_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief an element of the config, exactly one of the two is set
+     * the elements are owned by their own types since LogCPP::BaseElement has no virtual destructor
+     *
+     */
+    struct ConfigElement
+    {
+        std::unique_ptr<LogCPP::ConstantStringElement> constant;
+        std::unique_ptr<RecordTimeElement> time;
+    };
+
+    class LoggerConfig
+    {
+    private:
+        LoggerConfig();
+
+    public:
+        /**
+         * @brief add the streams of a config file to a logger and apply its "minLevel"
+         * throws LoggerConfigException if the file can not be read
+         *
+         * @param path the path of the config file
+         * @param logger receives the streams
+         * @param elements receives the elements in order, nullptr if the logger has its own layout
+         */
+        static void load(const std::string &path, LogCPP::BaseLogger &logger, std::vector<ConfigElement> *elements);
+        /**
+         * @brief read the "queue" section of a config file, the defaults are kept for what is missing
+         * throws LoggerConfigException if the file can not be read
+         *
+         * @param path the path of the config file
+         * @return LogQueueConfig the capacity, the policies and the summary interval
+         */
+        static LogQueueConfig loadQueue(const std::string &path);
+        /**
+         * @brief the text of a json string, without the quotes JsonCPP keeps around it
+         *
+         * @param value the json value
+         * @return std::string the text
+         */
+        static std::string text(JsonCPP::JsonInstance &value);
+        /**
+         * @brief the value of a json integer
+         *
+         * @param value the json value
+         * @param fallback returned if the value is missing or negative
+         * @return size_t the value
+         */
+        static size_t integer(JsonCPP::JsonInstance &value, size_t fallback);
+    };
+
+};
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file RingLogger.h
+ * @author maxwellzs
+ * @brief this file defines an asynchronous logger built on the lock free log ring
+ * callers only copy the message into the ring, the daemon thread renders the
+ * lines with the compiled layout and writes them into the streams
+ * the daemon also formats the records of the binary logging mode
+ * it reads the same logger.json as the loggers of LogCPP
+ * when the ring is full every level follows its overflow policy, the drops are counted
+ * and summarized by the daemon
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "Loggers.h"
+#include "log/LogRing.h"
+#include "log/LogPolicy.h"
+#include "log/LogElements.h"
+#include "log/LogLayout.h"
+#include "log/BatchedStream.h"
+#include "log/BinaryLog.h"
+
+#ifndef RingLogger_h
+#define RingLogger_h
+
+namespace QQDommy
+{
+
+    /// @brief the longest time the daemon sleeps before checking for the stop flag
+    const static int LOG_DAEMON_IDLE_MS = 100;
+    /// @brief the empty polls the daemon makes before going to sleep
+    const static unsigned LOG_DAEMON_SPINS = 64;
+
+    class RingLogger : public LogCPP::BaseLogger
+    {
+    private:
+        static RingLogger *instance;
+        LogRing ring;
+        std::thread daemon;
+        /// @brief the daemon is started once, by Start, the first log or SafeDelete
+        std::once_flag startOnce;
+        std::atomic<bool> shouldStop{false};
+        /// @brief set once the daemon is gone, later logs are written by the caller
+        std::atomic<bool> stopped{false};
+        std::mutex directMutex;
+        /// @brief compiled after the level, in the order of the config, owned below
+        std::vector<LogCPP::BaseElement *> elements;
+        /// @brief the owners of the elements by their own types, LogCPP::BaseElement has no virtual destructor
+        std::vector<std::unique_ptr<RecordTimeElement>> timeElements;
+        std::vector<std::unique_ptr<LogCPP::ConstantStringElement>> constantElements;
+        /// @brief the level and the elements compiled, rebuilt when an element is added
+        LogLayout layout;
+        TscCalibration calibration;
+        uint64_t calibratedAt = 0;
+        /// @brief reused for every line
+        std::string line;
+
+        /// @brief read by the producers, set before logging
+        OverflowPolicy policies[LEVEL_COUNT];
+        std::atomic<uint64_t> sampled[LEVEL_COUNT];
+        std::atomic<uint64_t> dropped[LEVEL_COUNT];
+        /// @brief the drops already summarized, only touched by the daemon
+        uint64_t reported[LEVEL_COUNT] = {};
+        int summaryMs;
+        uint64_t summaryAt = 0;
+
+        struct BinaryEntry
+        {
+            uint64_t ticks;
+            const LogFormat *format;
+            const uint8_t *args;
+            size_t length;
+        };
+        /// @brief guards binaryRings, only taken to attach a thread and by the daemon
+        std::mutex binaryMutex;
+        std::vector<BinaryLogRing *> binaryRings;
+        /// @brief the rings drained by the daemon, copied from binaryRings so the lock is not held while writing
+        std::vector<BinaryLogRing *> binaryDraining;
+        std::vector<BinaryEntry> binaryBatch;
+        std::vector<uint64_t> binaryEnds;
+        std::string binaryText;
+
+        void Run();
+        void Write(LogCPP::LEVELS level, uint64_t ticks, const char *msg, size_t length);
+        void CompileLayout();
+        /// @brief put a message into the ring following the policy of its level
+        void Enqueue(LogCPP::LEVELS level, const char *msg, size_t length);
+        /// @brief write a warning with the drops since the last summary, if any
+        void ReportDrops(uint64_t ticks);
+        /// @brief the streams that gather lines, found among the streams when they change
+        std::vector<BatchedStream *> batchedStreams;
+        size_t scannedStreams = 0;
+        /// @brief hand the old batches to the writers, or wait for them when syncing
+        void FlushStreams(bool sync);
+        /// @brief format the records of all the binary rings, ordered by their ticks
+        size_t DrainBinary();
+        /// @brief whether a binary ring holds records, the daemon does not sleep then
+        bool BinaryPending();
+
+    public:
+        /**
+         * @brief Construct a new Ring Logger object, the daemon waits for Start
+         * add the streams and elements before Start, they are not guarded
+         *
+         * @param capacity the number of messages the ring holds
+         */
+        explicit RingLogger(size_t capacity = DEFAULT_LOG_CAPACITY);
+        /**
+         * @brief Construct a new Ring Logger object with the overflow policies of each level
+         *
+         * @param config the capacity, the policies and the summary interval
+         */
+        explicit RingLogger(const LogQueueConfig &config);
+        ~RingLogger();
+        RingLogger(const RingLogger &) = delete;
+        RingLogger &operator=(const RingLogger &) = delete;
+        /**
+         * @brief add the elements and streams described by a logger config file
+         * an optional "minLevel" sets the minimum level of the logging macros
+         * throws LoggerConfigException if the file can not be read
+         *
+         * @param path the path of the config file
+         */
+        void LoadConfig(const std::string &path);
+        /**
+         * @brief append an element compiled after the level, rendered per line
+         * it is compiled into the layout at once
+         *
+         * @param element the new element
+         */
+        void AppendElement(std::unique_ptr<RecordTimeElement> element);
+        /**
+         * @brief append a constant compiled after the level
+         *
+         * @param element the new element
+         */
+        void AppendElement(std::unique_ptr<LogCPP::ConstantStringElement> element);
+        /**
+         * @brief start the daemon once the streams and elements are added, nothing is added after
+         * the first log starts it as well, later calls do nothing
+         *
+         */
+        void Start();
+        void Log(LogCPP::LEVELS level, const std::string &msg) override;
+        /**
+         * @brief let the daemon format the records of a binary ring, called by BinaryLog
+         *
+         * @param ring the ring of a thread
+         */
+        void AttachBinary(BinaryLogRing *ring);
+        /**
+         * @brief block until every message submitted is written, then stop the daemon
+         *
+         */
+        void SafeDelete() override;
+        const LogRing &getRing() const;
+        /**
+         * @brief the counters of the queue, read without stopping the producers
+         *
+         * @return LogQueueStats the counters
+         */
+        LogQueueStats GetStats() const;
+        /**
+         * @brief Get the single instance, configured with the config path of LogCPP
+         *
+         * @return BaseLogger& the instance
+         */
+        static BaseLogger &GetInstance();
+    };
+
+};
+
+#endif
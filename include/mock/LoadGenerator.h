@@ -0,0 +1,100 @@
+/**
+ * @file LoadGenerator.h
+ * @author maxwellzs
+ * @brief this file defines a load generator simulating many oicq clients on one loop
+ * every client connects, logs in, sends its messages one after another and acks the
+ * pushes, the latencies of all the requests are collected into one report
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include "net/EventLoop.h"
+
+#ifndef LoadGenerator_h
+#define LoadGenerator_h
+
+namespace QQDommy
+{
+
+    class SimulatedClient;
+
+    struct LoadConfig
+    {
+        std::string ip = "127.0.0.1";
+        uint16_t port = 0;
+        /// @brief the clients connected at the same time
+        size_t clients = 100;
+        /// @brief the messages each client sends after the login
+        size_t messagesPerClient = 100;
+        std::string password = "admin";
+        /// @brief the uin of the first client, the others follow
+        uint64_t firstUin = 10000;
+        int timeoutMs = 10000;
+    };
+
+    struct LoadReport
+    {
+        /// @brief the clients that logged in and sent all their messages
+        size_t sessions = 0;
+        size_t failed = 0;
+        double seconds = 0;
+        /// @brief the time until the last client logged in
+        double loginSeconds = 0;
+        uint64_t packetsSent = 0;
+        uint64_t packetsReceived = 0;
+        /// @brief the latencies of the requests in microseconds
+        uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0;
+        double connectionsPerSecond() const { return loginSeconds > 0 ? sessions / loginSeconds : 0; }
+        double packetsPerSecond() const { return seconds > 0 ? (packetsSent + packetsReceived) / seconds : 0; }
+        std::string toString() const;
+    };
+
+    class LoadGenerator
+    {
+    private:
+        EventLoop &loop;
+        LoadConfig config;
+        std::vector<std::unique_ptr<SimulatedClient>> clients;
+        /// @brief the latency of every request, in microseconds
+        std::vector<uint32_t> latencies;
+        size_t running = 0;
+        uint64_t startNs = 0;
+        uint64_t lastLoginNs = 0;
+        LoadReport report;
+
+    public:
+        /**
+         * @brief Construct a new Load Generator object
+         *
+         * @param loop the loop of the clients, it must not be running
+         * @param config the load
+         */
+        LoadGenerator(EventLoop &loop, const LoadConfig &config);
+        ~LoadGenerator();
+        LoadGenerator(const LoadGenerator &) = delete;
+        LoadGenerator &operator=(const LoadGenerator &) = delete;
+        /**
+         * @brief run the loop until every client is finished
+         *
+         * @return LoadReport the result
+         */
+        LoadReport run();
+        /// @brief the following are called by the clients
+        void recordLatency(uint64_t startNs);
+        void recordLogin();
+        void finish(bool succeeded, uint64_t sent, uint64_t received);
+        const LoadConfig &getConfig() const;
+        EventLoop &getLoop();
+        static uint64_t nowNs();
+    };
+
+};
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file MockProtocol.h
+ * @author maxwellzs
+ * @brief this file defines the subset of oicq spoken between the mock server and
+ * the simulated clients: frames, tea encrypted tlv payloads and an md5 password check
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include "utils/ByteBuffer.h"
+#include "encrypt/Tea.h"
+#include "utils/HexLiteral.h"
+
+#ifndef MockProtocol_h
+#define MockProtocol_h
+
+namespace QQDommy
+{
+
+    /// @brief commands of the frames
+    const static uint32_t CMD_LOGIN = 0x0810;
+    const static uint32_t CMD_HEARTBEAT = 0x0058;
+    const static uint32_t CMD_SEND_MESSAGE = 0x00CD;
+    const static uint32_t CMD_PUSH_MESSAGE = 0x00CE;
+    const static uint32_t CMD_PUSH_ACK = 0x00CF;
+
+    /// @brief tags of the tlvs inside the payloads
+    const static uint16_t TLV_UIN = 0x0001;
+    const static uint16_t TLV_PASSWORD_MD5 = 0x0002;
+    const static uint16_t TLV_RESULT = 0x0003;
+    const static uint16_t TLV_SESSION_KEY = 0x0004;
+    const static uint16_t TLV_MESSAGE = 0x0005;
+    const static uint16_t TLV_PUSH_ID = 0x0006;
+
+    /// @brief the login result carried by TLV_RESULT
+    const static uint8_t LOGIN_OK = 0;
+    const static uint8_t LOGIN_WRONG_PASSWORD = 1;
+
+    /// @brief the key both sides use before a session key is agreed on
+    constexpr static std::array<uint8_t, TEA_KEY_SIZE> MOCK_SHARE_KEY = "95 7C 3A AF BF 6F AF 1D 2C 2F 19 A5 EA 04 E5 1C"_hex;
+
+    class MockProtocol
+    {
+    private:
+        MockProtocol();
+
+    public:
+        /**
+         * @brief build the encrypted payload of CMD_LOGIN
+         *
+         * @param out where the payload is written
+         * @param cipher a cipher of MOCK_SHARE_KEY
+         * @param uin the account
+         * @param password the plain password, only its md5 is sent
+         */
+        static void buildLogin(ByteBuffer &out, TeaCipher &cipher, uint64_t uin, const std::string &password);
+        /**
+         * @brief read the reply of CMD_LOGIN
+         *
+         * @param payload the encrypted payload
+         * @param cipher a cipher of MOCK_SHARE_KEY
+         * @param sessionKey receives the 16 bytes session key on success
+         * @return true if the login succeeded
+         */
+        static bool parseLoginReply(ByteBuffer &payload, const TeaCipher &cipher, uint8_t *sessionKey);
+        /**
+         * @brief build a tea encrypted payload holding one tlv
+         *
+         * @param out where the payload is written
+         * @param cipher the cipher of the session key
+         * @param tag the tag of the tlv
+         * @param value the value of the tlv
+         * @param length the length of the value
+         */
+        static void buildSealed(ByteBuffer &out, TeaCipher &cipher, uint16_t tag, const uint8_t *value, size_t length);
+    };
+
+};
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file MockServer.h
+ * @author maxwellzs
+ * @brief this file defines a local stand-in for the oicq server, used to benchmark
+ * the whole stack over loopback without touching the real servers
+ * it completes the scripted login, acknowledges messages and heartbeats and
+ * pushes bursts of synthetic messages to every logged in session
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include "net/EventLoop.h"
+#include "net/Acceptor.h"
+
+#ifndef MockServer_h
+#define MockServer_h
+
+namespace QQDommy
+{
+
+    class MockSession;
+
+    struct MockServerConfig
+    {
+        /// @brief the password every account must log in with
+        std::string password = "admin";
+        /// @brief synthetic messages pushed per burst, 0 disables the pushes
+        size_t pushBurst = 0;
+        /// @brief the time between two bursts
+        int pushIntervalMs = 100;
+    };
+
+    /**
+     * @brief the counters of the server, can be read from any thread
+     *
+     */
+    struct MockServerStats
+    {
+        std::atomic<uint64_t> connections{0};
+        std::atomic<uint64_t> logins{0};
+        std::atomic<uint64_t> failedLogins{0};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> heartbeats{0};
+        std::atomic<uint64_t> pushes{0};
+        std::atomic<uint64_t> pushAcks{0};
+    };
+
+    class MockServer
+    {
+    private:
+        EventLoop &loop;
+        MockServerConfig config;
+        MockServerStats stats;
+        Acceptor acceptor;
+        std::vector<std::unique_ptr<MockSession>> sessions;
+        /// @brief closed sessions whose connection can be reused
+        std::vector<MockSession *> idleSessions;
+        void accept(int fd);
+
+    public:
+        /**
+         * @brief Construct a new Mock Server object, all the work is done on the loop
+         *
+         * @param loop the loop serving the connections
+         * @param config the behaviour of the server
+         */
+        MockServer(EventLoop &loop, const MockServerConfig &config = MockServerConfig());
+        ~MockServer();
+        MockServer(const MockServer &) = delete;
+        MockServer &operator=(const MockServer &) = delete;
+        /**
+         * @brief start listening, must be called on the thread of the loop or before it runs
+         *
+         * @param ip the local address
+         * @param port the port, 0 to let the kernel choose
+         * @return uint16_t the port bound
+         */
+        uint16_t listen(const std::string &ip, uint16_t port);
+        const MockServerStats &getStats() const;
+        /// @brief called by a session when its connection is closed
+        void release(MockSession *session);
+        const MockServerConfig &getConfig() const;
+        MockServerStats &mutableStats();
+    };
+
+};
+
+#endif
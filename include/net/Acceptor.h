@@ -0,0 +1,62 @@
+/**
+ * @file Acceptor.h
+ * @author maxwellzs
+ * @brief this file defines the listening socket used by local servers,
+ * e.g. the loopback stand-in servers in tests
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <functional>
+#include "net/EventLoop.h"
+
+#ifndef Acceptor_h
+#define Acceptor_h
+
+namespace QQDommy
+{
+
+    /// @brief receives the fd of every accepted socket, already non-blocking
+    typedef std::function<void(int)> AcceptCallback;
+    /// @brief the length of the accept queue, large enough for connection storms
+    const static int DEFAULT_BACKLOG = 4096;
+
+    class Acceptor : public EventHandler
+    {
+    private:
+        EventLoop &loop;
+        AcceptCallback callback;
+        int listenFd = -1;
+
+    public:
+        /**
+         * @brief Construct a new Acceptor object
+         *
+         * @param loop the loop where the listening socket is registered
+         * @param callback called with every new socket
+         */
+        Acceptor(EventLoop &loop, const AcceptCallback &callback);
+        ~Acceptor();
+        Acceptor(const Acceptor &) = delete;
+        Acceptor &operator=(const Acceptor &) = delete;
+        /**
+         * @brief bind and start listening
+         *
+         * @param ip the local address
+         * @param port the port, 0 to let the kernel choose
+         * @param backlog the length of the accept queue
+         * @return uint16_t the port actually bound
+         */
+        uint16_t listen(const std::string &ip, uint16_t port, int backlog = DEFAULT_BACKLOG);
+        /// @brief accept until EAGAIN
+        void handleEvent(uint32_t events) override;
+    };
+
+};
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file Connection.h
+ * @author maxwellzs
+ * @brief this file defines the non-blocking tcp connection driven by the event loop
+ * every connection owns a receive and a send buffer, the socket reads into and writes
+ * from these buffers directly
+ * the packets sent during a turn of the loop are corked in the send buffer and written
+ * together at the end of the turn, or earlier once the cork holds too many bytes or
+ * its first packet waited too long, so a burst of small packets costs one syscall
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include "utils/ByteBuffer.h"
+#include "net/EventLoop.h"
+
+#ifndef Connection_h
+#define Connection_h
+
+namespace QQDommy
+{
+
+    class Connection;
+
+    typedef enum
+    {
+        IDLE,
+        CONNECTING,
+        CONNECTED,
+        CLOSED
+    } CONNECTION_STATE;
+
+    typedef enum
+    {
+        INBOUND,
+        OUTBOUND
+    } DIRECTION;
+
+    /// @brief the bytes reserved in the receive buffer before each read
+    const static size_t READ_CHUNK_SIZE = 16 * 1024;
+    /// @brief default time allowed for a connect to complete
+    const static int DEFAULT_CONNECT_TIMEOUT = 5000;
+    /// @brief the corked bytes written at once without waiting for the end of the turn
+    const static size_t DEFAULT_CORK_BYTES = 64 * 1024;
+    /// @brief how long a corked packet may wait when a turn runs long
+    const static int DEFAULT_CORK_DELAY_US = 200;
+
+    /**
+     * @brief what the sends of a connection cost
+     *
+     */
+    struct SendStats
+    {
+        /// @brief the calls of send
+        uint64_t packets = 0;
+        /// @brief the send and writev syscalls made for them
+        uint64_t syscalls = 0;
+        uint64_t bytes = 0;
+        double syscallsPerPacket() const { return packets > 0 ? (double)syscalls / packets : 0; }
+    };
+
+    /**
+     * @brief receives the callbacks of a connection
+     * all the callbacks are called on the thread of the event loop
+     *
+     */
+    class ConnectionHandler
+    {
+    public:
+        /// @brief the connection has been established
+        virtual void onConnected(Connection & /*conn*/) {}
+        /**
+         * @brief new data has arrived
+         * the handler consumes what it can from the buffer, the rest is kept
+         * and presented again together with the next data
+         *
+         * @param conn the connection
+         * @param input the receive buffer of the connection
+         */
+        virtual void onMessage(Connection &conn, ByteBuffer &input) = 0;
+        /**
+         * @brief the connection is closed, this is the last callback
+         * the connection must not be destroyed inside any callback, but it
+         * can be reused by calling connect again
+         *
+         * @param conn the connection
+         * @param error 0 if closed normally, the errno otherwise (ETIMEDOUT on connect timeout)
+         */
+        virtual void onClosed(Connection & /*conn*/, int /*error*/) {}
+    };
+
+    /**
+     * @brief observes the raw bytes flowing through a connection, e.g. to record a trace
+     *
+     */
+    class ConnectionTap
+    {
+    public:
+        /**
+         * @brief called with every chunk received into or sent from the connection buffers
+         *
+         * @param direction INBOUND or OUTBOUND
+         * @param data the bytes, only valid during the call
+         * @param length the number of bytes
+         */
+        virtual void tap(DIRECTION direction, const uint8_t *data, size_t length) = 0;
+    };
+
+    class Connection : public EventHandler, public TurnEndHandler
+    {
+    private:
+        EventLoop &loop;
+        ConnectionHandler &handler;
+        int fd = -1;
+        CONNECTION_STATE state = IDLE;
+        ByteBuffer inputBuffer;
+        ByteBuffer outputBuffer;
+        /// @brief closes the socket with ETIMEDOUT if the connect takes too long
+        TimerId connectTimer = 0;
+        ConnectionTap *connectionTap = nullptr;
+        /// @brief 0 writes every packet at once
+        size_t corkBytes = DEFAULT_CORK_BYTES;
+        uint64_t corkDelayTicks;
+        /// @brief the send buffer holds packets waiting for the end of the turn
+        bool corked = false;
+        /// @brief the TscClock tick of the first corked packet
+        uint64_t corkedAt = 0;
+        /// @brief the kernel did not take everything, the rest waits for EPOLLOUT
+        bool blocked = false;
+        SendStats stats;
+        /// @brief register the socket on the loop
+        void attach(int socketFd, CONNECTION_STATE newState);
+        /// @brief read until EAGAIN, required by edge triggered mode
+        void handleRead();
+        /**
+         * @brief write the send buffer and then the extra bytes with one writev, until
+         * everything is written or EAGAIN, what is left is kept in the send buffer
+         *
+         * @param extra bytes following the send buffer, not copied unless they are left
+         * @param length the number of extra bytes
+         */
+        void handleWrite(const uint8_t *extra = nullptr, size_t length = 0);
+        void finishConnect();
+        /**
+         * @brief close the socket and notify the handler
+         *
+         * @param error the errno reported to the handler
+         */
+        void shutdown(int error);
+
+    public:
+        /**
+         * @brief Construct a new idle Connection object
+         *
+         * @param loop the loop that drives this connection
+         * @param handler the receiver of the callbacks
+         */
+        Connection(EventLoop &loop, ConnectionHandler &handler);
+        ~Connection();
+        Connection(const Connection &) = delete;
+        Connection &operator=(const Connection &) = delete;
+
+        /**
+         * @brief start a non-blocking connect, the result is reported through the handler
+         *
+         * @param ip the ipv4 address in dotted form
+         * @param port the port of the server
+         * @param timeoutMs the connection is closed with ETIMEDOUT if not established in time
+         */
+        void connect(const std::string &ip, uint16_t port, int timeoutMs = DEFAULT_CONNECT_TIMEOUT);
+        /**
+         * @brief take over a socket that is already connected, e.g. one from the acceptor
+         *
+         * @param socketFd the connected socket
+         */
+        void adopt(int socketFd);
+        /**
+         * @brief send the data, the part not accepted by the kernel is kept in the send buffer
+         * data sent before the connection is established is flushed once connected
+         *
+         * @param src the data
+         * @param length the length of the data
+         */
+        void send(const void *src, size_t length);
+        /**
+         * @brief send all the readable bytes of the buffer, the buffer is consumed
+         *
+         * @param buffer the buffer to send
+         */
+        void send(ByteBuffer &buffer);
+        /// @brief close the connection, the handler receives onClosed with error 0
+        void close();
+        /**
+         * @brief observe the bytes of this connection
+         *
+         * @param tap the observer, nullptr to remove it
+         */
+        void setTap(ConnectionTap *tap);
+        CONNECTION_STATE getState() const;
+        int getFd() const;
+        /// @brief the number of bytes waiting in the send buffer
+        size_t pendingBytes() const;
+        /**
+         * @brief set how the packets of a turn are corked
+         *
+         * @param bytes the corked bytes written without waiting for the end of the turn, 0 disables corking
+         * @param delayUs how long the first corked packet may wait
+         */
+        void setCork(size_t bytes, int delayUs = DEFAULT_CORK_DELAY_US);
+        const SendStats &getSendStats() const;
+        EventLoop &getLoop();
+        void handleEvent(uint32_t events) override;
+        /// @brief write the packets corked during the turn
+        void onTurnEnd() override;
+    };
+
+};
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file EventLoop.h
+ * @author maxwellzs
+ * @brief this file defines the epoll based event loop that drives the connections
+ * one loop runs on one thread and can drive thousands of non-blocking sockets
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <sys/epoll.h>
+#include "utils/MpscQueue.h"
+#include "utils/TimerWheel.h"
+
+#ifndef EventLoop_h
+#define EventLoop_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief thrown when a system call of the network layer fails
+     *
+     */
+    class NetworkException : public std::exception
+    {
+    private:
+        std::string msg;
+
+    public:
+        /**
+         * @brief create the exception from the failed call and the errno
+         *
+         * @param call the name of the failed call
+         * @param error the errno when the call failed
+         */
+        NetworkException(const std::string &call, int error);
+        const char *what() const noexcept override;
+    };
+
+    /**
+     * @brief a base class that receives the readiness events of a file descriptor
+     *
+     */
+    class EventHandler
+    {
+    public:
+        /**
+         * @brief called by the loop when the registered fd is ready
+         *
+         * @param events the epoll event mask
+         */
+        virtual void handleEvent(uint32_t events) = 0;
+    };
+
+    /**
+     * @brief a base class of what is finished at the end of a turn of the loop, e.g. the
+     * packets a connection corked during the turn
+     *
+     */
+    class TurnEndHandler
+    {
+    public:
+        /// @brief called once on the thread of the loop after the events, timers and tasks of the turn
+        virtual void onTurnEnd() = 0;
+    };
+
+    /// @brief the number of events fetched by one epoll_wait
+    const static size_t DEFAULT_MAX_EVENTS = 1024;
+    /// @brief the number of tasks that can wait in the mailbox of a loop
+    const static size_t DEFAULT_TASK_CAPACITY = 65536;
+
+    /// @brief a task run on the thread of the loop
+    typedef std::function<void()> LoopTask;
+
+    class EventLoop : public EventHandler
+    {
+    private:
+        int epollFd = -1;
+        /// @brief eventfd used to wake the loop from another thread
+        int wakeFd = -1;
+        std::atomic<bool> running{false};
+        /// @brief set by stop, also before run is entered, a stopped loop does not run again
+        std::atomic<bool> stopRequested{false};
+        std::vector<epoll_event> events;
+        /// @brief heartbeats, request and connect timeouts of everything on this loop
+        TimerWheel timers;
+        /// @brief tasks posted from other threads
+        MpscQueue<LoopTask> tasks;
+        /// @brief set once a wakeup is on the way, so a burst of posts costs one write
+        std::atomic<bool> notified{false};
+        /// @brief written by the thread entering run, read by the others
+        std::atomic<std::thread::id> loopThread;
+        /// @brief set while the events, timers and tasks of a turn are handled
+        bool inTurn = false;
+        /// @brief called at the end of the current turn, swapped with draining to be run
+        std::vector<TurnEndHandler *> turnEnd;
+        std::vector<TurnEndHandler *> draining;
+        /// @brief the rate of TscClock, calibrated once when the first loop is built
+        double nsPerTick;
+        /// @brief run the tasks posted so far
+        void runTasks();
+        /// @brief run the turn end handlers, including the ones they schedule
+        void runTurnEnd();
+
+    public:
+        /**
+         * @brief Construct a new Event Loop object
+         *
+         * @param maxEvents the number of events handled in one turn at most
+         * @param taskCapacity the size of the mailbox
+         * @param tickMs the resolution of the timers
+         * the first loop calibrates TscClock, it blocks for the calibration once
+         */
+        EventLoop(size_t maxEvents = DEFAULT_MAX_EVENTS, size_t taskCapacity = DEFAULT_TASK_CAPACITY, int tickMs = DEFAULT_TICK_MS);
+        ~EventLoop();
+        EventLoop(const EventLoop &) = delete;
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        /**
+         * @brief register, modify or remove a fd on the epoll instance
+         *
+         * @param fd the file descriptor
+         * @param mask the epoll events, e.g. EPOLLIN | EPOLLET
+         * @param handler the handler called when the fd is ready
+         */
+        void add(int fd, uint32_t mask, EventHandler *handler);
+        void modify(int fd, uint32_t mask, EventHandler *handler);
+        void remove(int fd);
+
+        /**
+         * @brief run the callback on this loop after the delay, loop thread only
+         *
+         * @param delayMs the delay in milliseconds
+         * @param callback the callback
+         * @return TimerId used to cancel the timer
+         */
+        TimerId runAfter(int delayMs, const TimerCallback &callback);
+        /**
+         * @brief run the callback periodically until cancelled, loop thread only
+         *
+         * @param intervalMs the period in milliseconds
+         * @param callback the callback
+         * @return TimerId used to cancel the timer
+         */
+        TimerId runEvery(int intervalMs, const TimerCallback &callback);
+        bool cancelTimer(TimerId id);
+        /**
+         * @brief call the handler at the end of the current turn, loop thread only
+         * the handler must be scheduled only once per turn
+         *
+         * @param handler the handler, it is cancelled before it is destroyed, even by a handler of the same turn
+         */
+        void runAtTurnEnd(TurnEndHandler *handler);
+        /// @brief forget a handler scheduled by runAtTurnEnd
+        void cancelTurnEnd(TurnEndHandler *handler);
+        /// @brief whether the caller is inside a turn, so that work deferred to its end will run
+        bool isInTurn() const;
+        TimerWheel &getTimers();
+        /// @brief the ticks of TscClock in the given microseconds, without calibrating
+        uint64_t ticksIn(int delayUs) const;
+
+        /**
+         * @brief wait for the events once and dispatch them
+         *
+         * @param timeoutMs the max time to wait, -1 waits forever
+         * @return int the number of events dispatched
+         */
+        int runOnce(int timeoutMs);
+        /// @brief run until stop is called, returns at once if it was called before
+        void run();
+        /// @brief stop the loop, can be called from any thread, before run as well
+        void stop();
+        /// @brief interrupt the current epoll_wait, can be called from any thread
+        void wakeup();
+        bool isRunning() const;
+        /// @brief whether stop was called, the mailbox is never drained again
+        bool isStopped() const;
+        /**
+         * @brief run the task on the thread of the loop, can be called from any thread
+         * the mailbox is lock free, the loop is woken at most once per batch of posts
+         *
+         * @param task the task
+         * @return true if posted
+         * @return false if the mailbox is full
+         */
+        bool post(LoopTask task);
+        /// @brief whether the caller runs on the thread currently running the loop
+        bool isInLoopThread() const;
+        /// @brief drains the wakeup eventfd and runs the posted tasks
+        void handleEvent(uint32_t events) override;
+    };
+
+};
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * @file Executor.h
+ * @author maxwellzs
+ * @brief this file defines the work stealing pool running the cpu bound work, decryption,
+ * tlv decoding and the handlers, away from the threads of the event loops
+ * every worker owns a chase-lev deque, the jobs a job submits go to the deque of its
+ * worker and idle workers steal the oldest jobs of the others, jobs submitted from
+ * other threads go to the lock free inbox of a worker first
+ * the jobs of one key, e.g. the uin of a session, run one at a time in the order
+ * they were submitted, on the worker that ran the key last unless it is stolen
+ * a job may own move only state, so a ByteBuffer is moved to the worker and back
+ * to the loop without copying its bytes
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <type_traits>
+#include "net/EventLoop.h"
+#include "utils/WorkDeque.h"
+
+#ifndef Executor_h
+#define Executor_h
+
+namespace QQDommy
+{
+
+    /// @brief the keys are spread over this many strands, two keys on one strand share its order
+    const static size_t EXECUTOR_STRANDS = 4096;
+    /// @brief the jobs a strand runs before it lets the other strands have the worker
+    const static size_t STRAND_BATCH = 32;
+
+    /**
+     * @brief a link of the intrusive queues
+     *
+     */
+    struct JobNode
+    {
+        std::atomic<JobNode *> next{nullptr};
+    };
+
+    /**
+     * @brief a unit of work, it frees itself once run
+     *
+     */
+    class Job : public JobNode
+    {
+    public:
+        virtual ~Job() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename F>
+    class FunctionJob : public Job
+    {
+    private:
+        F function;
+
+    public:
+        template <typename G>
+        explicit FunctionJob(G &&function) : function(std::forward<G>(function)) {}
+        void run() override
+        {
+            function();
+            delete this;
+        }
+    };
+
+    /**
+     * @brief the unbounded intrusive multi producer single consumer queue of Vyukov
+     * producers only exchange one pointer
+     *
+     */
+    class JobQueue
+    {
+    private:
+        alignas(64) std::atomic<JobNode *> head;
+        alignas(64) JobNode *tail;
+        JobNode stub;
+
+    public:
+        JobQueue();
+        JobQueue(const JobQueue &) = delete;
+        JobQueue &operator=(const JobQueue &) = delete;
+        /// @brief from any thread
+        void push(JobNode *node);
+        /**
+         * @brief consumer only
+         *
+         * @return Job* nullptr if empty or a push is half done
+         */
+        Job *pop();
+    };
+
+    class Executor;
+
+    /**
+     * @brief the jobs of the keys hashed to it, scheduled as one job while it has any
+     *
+     */
+    class Strand : public Job
+    {
+    private:
+        Executor *executor = nullptr;
+        JobQueue jobs;
+        std::atomic<size_t> pending{0};
+        /// @brief the worker that ran the strand last, where it is scheduled again
+        std::atomic<size_t> lastWorker{0};
+        friend class Executor;
+
+    public:
+        /// @brief run a batch of the jobs, the strand is never freed
+        void run() override;
+    };
+
+    /**
+     * @brief the counters of the pool
+     *
+     */
+    struct ExecutorStats
+    {
+        /// @brief the jobs run, a batch of a strand counts as one
+        uint64_t executed = 0;
+        /// @brief the jobs taken from the deque of another worker
+        uint64_t stolen = 0;
+        /// @brief the times a worker went to sleep for want of jobs
+        uint64_t parked = 0;
+    };
+
+    class Executor
+    {
+    private:
+        struct alignas(64) Worker
+        {
+            size_t index;
+            /// @brief the state of the victims picked, never 0
+            uint64_t seed;
+            WorkDeque<Job> deque;
+            JobQueue inbox;
+            std::thread thread;
+            /// @brief bumped to wake the worker while it is parked
+            std::atomic<uint32_t> wakeups{0};
+            std::atomic<bool> sleeping{false};
+            std::atomic<uint64_t> executed{0};
+            std::atomic<uint64_t> stolen{0};
+            std::atomic<uint64_t> parked{0};
+        };
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::unique_ptr<Strand[]> strands;
+        std::atomic<bool> running{true};
+        /// @brief the workers parked or about to park
+        std::atomic<size_t> idle{0};
+        /// @brief the inbox of the next job submitted from outside the pool
+        std::atomic<size_t> nextInbox{0};
+        static thread_local Worker *currentWorker;
+        static thread_local Executor *currentExecutor;
+
+        void work(Worker &worker);
+        /// @brief a job of the own deque or inbox, or stolen from another worker
+        Job *find(Worker &worker);
+        /// @brief queue a job on the inbox of the preferred worker, or the own deque if called from a worker
+        void schedule(Job *job, size_t preferred);
+        /// @brief wake a parked worker to steal the jobs of the caller
+        void wakeAny();
+        friend class Strand;
+
+    public:
+        /**
+         * @brief Construct a new Executor object and start the workers
+         *
+         * @param workerCount the number of workers, 0 for one per available core
+         * @param pinThreads pin every worker to its own core
+         */
+        explicit Executor(size_t workerCount = 0, bool pinThreads = false);
+        /// @brief run the jobs already submitted, then stop the workers
+        ~Executor();
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        /**
+         * @brief run a function on any worker, from any thread
+         *
+         * @param function a callable, it may own move only state
+         */
+        template <typename F>
+        void submit(F &&function)
+        {
+            schedule(new FunctionJob<std::decay_t<F>>(std::forward<F>(function)), SIZE_MAX);
+        }
+        /**
+         * @brief run a function after the ones submitted before with the same key, from any thread
+         *
+         * @param key e.g. the uin of the session whose packets must stay in order
+         * @param function a callable, it may own move only state
+         */
+        template <typename F>
+        void submit(uint64_t key, F &&function)
+        {
+            enqueue(key, new FunctionJob<std::decay_t<F>>(std::forward<F>(function)));
+        }
+        /**
+         * @brief run the work in the order of the key, then hand its result to done on the loop
+         * e.g. the decryption and decoding of a frame, whose result goes back to the connection
+         *
+         * @param key the key ordering the work
+         * @param loop the loop running done
+         * @param work returns the result, it may be move only like a ByteBuffer
+         * @param done called with the result on the thread of the loop
+         */
+        template <typename Work, typename Done>
+        void offload(uint64_t key, EventLoop &loop, Work &&work, Done &&done)
+        {
+            submit(key, [&loop, work = std::forward<Work>(work), done = std::forward<Done>(done)]() mutable
+                   {
+                // a loop task is copied, so the result and the callback travel by pointer
+                auto finish = std::make_shared<std::decay_t<Done>>(std::move(done));
+                if constexpr (std::is_void_v<decltype(work())>)
+                {
+                    work();
+                    postToLoop(loop, [finish]() { (*finish)(); });
+                }
+                else
+                {
+                    auto result = std::make_shared<decltype(work())>(work());
+                    postToLoop(loop, [finish, result]() { (*finish)(std::move(*result)); });
+                } });
+        }
+        /// @brief queue a job on the strand of the key
+        void enqueue(uint64_t key, Job *job);
+        /**
+         * @brief post to a loop, waiting while its mailbox is full and the loop is not stopped
+         * a loop that stopped never drains its mailbox, the task is dropped and counted then
+         *
+         * @param loop the loop
+         * @param task the task
+         * @return true if posted, false if dropped
+         */
+        static bool postToLoop(EventLoop &loop, LoopTask task);
+        size_t size() const;
+        ExecutorStats getStats() const;
+        /**
+         * @brief the index of the worker running the caller
+         *
+         * @return int -1 outside the pool
+         */
+        static int currentIndex();
+    };
+
+};
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file ShardedRuntime.h
+ * @author maxwellzs
+ * @brief this file defines the runtime that runs one event loop per core
+ * every account is assigned to one shard by the hash of its uin, all the work of the
+ * account runs on the thread of that shard, so the packet path never takes a lock
+ * shards only talk through the lock free mailbox of their loops
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include "net/EventLoop.h"
+#include "utils/BufferPool.h"
+
+#ifndef ShardedRuntime_h
+#define ShardedRuntime_h
+
+namespace QQDommy
+{
+
+    class Shard
+    {
+    private:
+        size_t index;
+        /// @brief the cpu the thread is pinned to, -1 when not pinned
+        int cpu;
+        EventLoop loop;
+        /// @brief buffers used by the connections of this shard only
+        BufferPool pool;
+        std::thread thread;
+        static thread_local Shard *currentShard;
+
+    public:
+        /**
+         * @brief Construct a new Shard object, the thread is not started yet
+         *
+         * @param index the index of the shard in the runtime
+         * @param cpu the cpu to pin the thread to, -1 to leave it to the scheduler
+         */
+        Shard(size_t index, int cpu);
+        Shard(const Shard &) = delete;
+        Shard &operator=(const Shard &) = delete;
+        /// @brief start the thread running the loop
+        void start();
+        /// @brief stop the loop and wait for the thread
+        void stop();
+        EventLoop &getLoop();
+        BufferPool &getPool();
+        size_t getIndex() const;
+        int getCpu() const;
+        /**
+         * @brief the shard whose thread is calling
+         *
+         * @return Shard* nullptr if called outside the runtime
+         */
+        static Shard *current();
+    };
+
+    /// @brief a task run on the shard owning an account
+    typedef std::function<void(Shard &)> ShardTask;
+
+    class ShardedRuntime
+    {
+    private:
+        std::vector<std::unique_ptr<Shard>> shards;
+        bool started = false;
+
+    public:
+        /**
+         * @brief Construct a new Sharded Runtime object
+         *
+         * @param shardCount the number of shards, 0 for one per available core
+         * @param pinThreads pin every shard to its own core
+         */
+        ShardedRuntime(size_t shardCount = 0, bool pinThreads = true);
+        /// @brief stops all the shards
+        ~ShardedRuntime();
+        ShardedRuntime(const ShardedRuntime &) = delete;
+        ShardedRuntime &operator=(const ShardedRuntime &) = delete;
+        void start();
+        void stop();
+        /**
+         * @brief the shard owning the account, the same uin always gives the same shard
+         *
+         * @param uin the qq number of the account
+         * @return size_t the index of the shard
+         */
+        size_t shardIndexOf(uint64_t uin) const;
+        Shard &shardOf(uint64_t uin);
+        Shard &getShard(size_t index);
+        size_t size() const;
+        /**
+         * @brief run the task on the shard owning the account, can be called from any thread
+         *
+         * @param uin the qq number of the account
+         * @param task the task
+         * @return true if posted
+         * @return false if the mailbox of the shard is full
+         */
+        bool submit(uint64_t uin, const ShardTask &task);
+    };
+
+};
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file Arena.h
+ * @author maxwellzs
+ * @brief this file defines a bump allocator handing out memory from large blocks
+ * nothing allocated from an arena is freed on its own, the whole arena is released at once
+ * so only trivially destructible objects should live in it
+ * an arena is NOT thread safe
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef Arena_h
+#define Arena_h
+
+namespace QQDommy
+{
+
+    /// @brief the size of a block, larger allocations get a block of their own
+    const static size_t DEFAULT_ARENA_BLOCK = 16 * 1024;
+
+    class Arena
+    {
+    private:
+        struct Block
+        {
+            char *data;
+            size_t size;
+        };
+        std::vector<Block> blocks;
+        size_t blockSize;
+        /// @brief the free space of the last block
+        char *cursor = nullptr;
+        char *limit = nullptr;
+        size_t used = 0;
+
+        void *grow(size_t size, size_t align);
+
+    public:
+        /**
+         * @brief Construct a new Arena object, no memory is taken before the first allocation
+         *
+         * @param blockSize the size of a block
+         */
+        explicit Arena(size_t blockSize = DEFAULT_ARENA_BLOCK);
+        ~Arena();
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+        /**
+         * @brief take memory from the arena
+         *
+         * @param size the number of bytes
+         * @param align a power of 2
+         * @return void* the memory, valid until the arena is reset
+         */
+        void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+        {
+            uintptr_t at = ((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1);
+            if (cursor == nullptr || at + size > (uintptr_t)limit)
+                return grow(size, align);
+            cursor = (char *)(at + size);
+            used += size;
+            return (void *)at;
+        }
+        /**
+         * @brief take an uninitialized array from the arena
+         *
+         * @tparam T a trivially destructible type
+         * @param count the number of elements
+         * @return T* the array
+         */
+        template <typename T>
+        T *allocateArray(size_t count)
+        {
+            return static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+        }
+        /**
+         * @brief drop everything allocated, the blocks are merged into one kept for the next use
+         *
+         */
+        void reset();
+        /// @brief the bytes handed out since the last reset
+        size_t getUsed() const;
+        /// @brief the bytes of all the blocks held
+        size_t getReserved() const;
+    };
+
+};
+
+#endif
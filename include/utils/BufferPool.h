@@ -0,0 +1,63 @@
+/**
+ * @file BufferPool.h
+ * @author maxwellzs
+ * @brief this file defines a pool of byte buffers that can be reused without reallocation
+ * a pool is NOT thread safe, every shard of the runtime owns its own pool
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <vector>
+#include "utils/ByteBuffer.h"
+
+#ifndef BufferPool_h
+#define BufferPool_h
+
+namespace QQDommy
+{
+
+    /// @brief the capacity of the buffers created by the pool
+    const static size_t DEFAULT_POOLED_BUFFER_SIZE = 4096;
+    /// @brief how many released buffers the pool keeps at most
+    const static size_t DEFAULT_POOL_LIMIT = 1024;
+
+    class BufferPool
+    {
+    private:
+        std::vector<ByteBuffer> freeBuffers;
+        size_t bufferSize;
+        size_t limit;
+        /// @brief the number of buffers handed out that had to be allocated
+        size_t allocated = 0;
+
+    public:
+        /**
+         * @brief Construct a new Buffer Pool object
+         *
+         * @param bufferSize the initial capacity of a new buffer
+         * @param limit the number of free buffers kept, the rest is freed
+         */
+        BufferPool(size_t bufferSize = DEFAULT_POOLED_BUFFER_SIZE, size_t limit = DEFAULT_POOL_LIMIT);
+        /**
+         * @brief take an empty buffer from the pool, allocate one if the pool is empty
+         *
+         * @return ByteBuffer the empty buffer
+         */
+        ByteBuffer acquire();
+        /**
+         * @brief give a buffer back, its content is dropped but the memory is kept
+         * read only views are ignored
+         *
+         * @param buffer the buffer no longer used
+         */
+        void release(ByteBuffer &&buffer);
+        size_t freeCount() const;
+        size_t allocatedCount() const;
+    };
+
+};
+
+#endif
@@ -17,9 +17,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <string>
+#include <string_view>
+#include <array>
+#include <limits>
+#include <type_traits>
 #include <map>
 #include <exception>
 #include <sstream>
+#include "utils/Utf8.h"
+#include "utils/HexLiteral.h"
 
 #ifndef ByteBuffer_h
 #define ByteBuffer_h
@@ -71,10 +77,20 @@ namespace QQDommy
         const char *what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT override;
     };
 
+    /**
+     * @brief thrown when a string read is not valid utf-8
+     *
+     */
+    class IllegalStringException : public std::exception
+    {
+    public:
+        const char *what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT override;
+    };
+
     const static std::map<int8_t, char> HEX_CHAR = {
         {0, '0'}, {1, '1'}, {2, '2'}, {3, '3'}, {4, '4'}, {5, '5'}, {6, '6'}, {7, '7'}, {8, '8'}, {9, '9'}, {10, 'A'}, {11, 'B'}, {12, 'C'}, {13, 'D'}, {14, 'E'}, {15, 'F'}};
     const static std::map<char, int8_t> HEX_VAL = {
-        {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3}, {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7}, {'8', 8}, {'9', 9}, {'A', 0xa}, {'B', 0xb}, {'C', 0xc}, {'D', 0xd}, {'E', 0xe}, {'E', 0xf}};
+        {'0', 0}, {'1', 1}, {'2', 2}, {'3', 3}, {'4', 4}, {'5', 5}, {'6', 6}, {'7', 7}, {'8', 8}, {'9', 9}, {'A', 0xa}, {'B', 0xb}, {'C', 0xc}, {'D', 0xd}, {'E', 0xe}, {'F', 0xf}};
     const static size_t DEFAULT_BUFFER_SIZE = 64;
 
     class ByteBuffer
@@ -88,7 +104,12 @@ namespace QQDommy
         size_t capacity = DEFAULT_BUFFER_SIZE;
         /// @brief if writing an read only buffer . throw a @ReadOnlyBufferException
         bool isReadOnly = false;
-        void resize();
+        /**
+         * @brief grow the buffer until at least the given number of bytes fits
+         *
+         * @param required the total capacity required
+         */
+        void resize(size_t required);
         /**
          * @brief decide whether the buffer needs a resize
          *
@@ -97,11 +118,29 @@ namespace QQDommy
         void check_resize(size_t s);
         void check_readOnly();
         void check_outOfBound(size_t val);
+        /**
+         * @brief create a read only view over memory owned by someone else
+         *
+         * @param view the start of the memory
+         * @param length the number of readable bytes
+         */
+        ByteBuffer(const uint8_t *view, size_t length);
 
     public:
         /// @brief create an empty buffer
         ByteBuffer();
+        /**
+         * @brief create an empty buffer with the given initial capacity
+         *
+         * @param initialCapacity the number of bytes allocated up front
+         */
+        explicit ByteBuffer(size_t initialCapacity);
         ~ByteBuffer();
+        /// @brief a buffer owns its memory, so it can only be moved
+        ByteBuffer(const ByteBuffer &) = delete;
+        ByteBuffer &operator=(const ByteBuffer &) = delete;
+        ByteBuffer(ByteBuffer &&other) noexcept;
+        ByteBuffer &operator=(ByteBuffer &&other) noexcept;
         /**
          * @brief belows are the functions that alters or read from the buffer
          *
@@ -135,6 +174,7 @@ namespace QQDommy
          * @brief write a string of bytes in the form of hex data
          * e.g. std::string DATA("1A 2B 34 55");
          * every character must be in the form of the data in hex char, other throw
+         * the pairs are separated by white space, the same grammar as _hex
          *
          * @return ByteBuffer&
          */
@@ -154,6 +194,55 @@ namespace QQDommy
          */
         ByteBuffer &writeBuffer(ByteBuffer &ref);
 
+        /**
+         * @brief read a string after its big endian length, e.g. readString<uint16_t>() for a nickname
+         * nothing is copied, the view points into the buffer and is valid until the buffer is written
+         * nothing is consumed if the string is not complete
+         *
+         * @tparam LenT the type of the length, uint8_t, uint16_t or uint32_t
+         * @param checkUtf8 throw IllegalStringException if the string is not valid utf-8
+         * @return std::string_view the string
+         */
+        template <typename LenT>
+        std::string_view readString(bool checkUtf8 = false)
+        {
+            static_assert(std::is_unsigned_v<LenT> && sizeof(LenT) <= 4, "the length is an unsigned integer of at most 4 bytes");
+            check_outOfBound(sizeof(LenT));
+            size_t length = 0;
+            for (size_t i = 0; i < sizeof(LenT); i++)
+                length = (length << 8) | data[readIndex + i];
+            check_outOfBound(sizeof(LenT) + length);
+            const char *text = (const char *)data + readIndex + sizeof(LenT);
+            if (checkUtf8 && !Utf8::validate(text, length))
+                throw IllegalStringException();
+            readIndex += sizeof(LenT) + length;
+            return std::string_view(text, length);
+        }
+
+        /**
+         * @brief write a string after its big endian length
+         * throws BufferOutOfBoundException if the length does not fit in LenT
+         *
+         * @tparam LenT the type of the length, uint8_t, uint16_t or uint32_t
+         * @param text the string
+         * @return ByteBuffer& this
+         */
+        template <typename LenT>
+        ByteBuffer &writeString(std::string_view text)
+        {
+            static_assert(std::is_unsigned_v<LenT> && sizeof(LenT) <= 4, "the length is an unsigned integer of at most 4 bytes");
+            if (text.size() > std::numeric_limits<LenT>::max())
+                throw BufferOutOfBoundException();
+            check_readOnly();
+            check_resize(sizeof(LenT) + text.size());
+            for (size_t i = 0; i < sizeof(LenT); i++)
+                data[writeIndex + i] = (uint8_t)(text.size() >> (8 * (sizeof(LenT) - 1 - i)));
+            if (!text.empty())
+                memcpy(data + writeIndex + sizeof(LenT), text.data(), text.size());
+            writeIndex += sizeof(LenT) + text.size();
+            return *this;
+        }
+
         /**
          * @brief slice will return a new byte buffer with new pointer
          * and new read & write index
@@ -164,6 +253,15 @@ namespace QQDommy
          */
         ByteBuffer slice(size_t length);
         ByteBuffer slice(size_t offset, size_t length);
+        /**
+         * @brief wrap memory owned by others into a READ ONLY buffer, nothing is copied
+         * the memory must outlive the returned buffer
+         *
+         * @param src the start of the data
+         * @param length the length of the data
+         * @return ByteBuffer the view
+         */
+        static ByteBuffer wrap(const uint8_t *src, size_t length);
 
         /**
          * @brief let the visitor to visit the buffer
@@ -172,6 +270,68 @@ namespace QQDommy
          * @return ByteBuffer& this
          */
         ByteBuffer &doVisit(const BufferVisitor &visitor);
+
+        /**
+         * @brief belows are the raw access used by the io layer
+         * the socket reads directly into the writable region and writes directly
+         * from the readable region, so no intermediate copy is needed
+         *
+         * @return size_t the number of bytes not yet read
+         */
+        size_t readableBytes() const;
+        /// @brief the number of bytes that can be written without a resize
+        size_t writableBytes() const;
+        /// @brief pointer to the first unread byte
+        const uint8_t *readPointer() const;
+        /// @brief pointer to the first unwritten byte, call ensureWritable first
+        uint8_t *writePointer();
+        /**
+         * @brief make sure at least the given number of bytes can be written
+         * without reallocation, compacting the consumed bytes first when possible
+         *
+         * @param length the number of bytes about to be written
+         * @return ByteBuffer& this
+         */
+        ByteBuffer &ensureWritable(size_t length);
+        /**
+         * @brief mark bytes written through writePointer as valid data
+         *
+         * @param length the number of bytes written
+         * @return ByteBuffer& this
+         */
+        ByteBuffer &commitWrite(size_t length);
+        /**
+         * @brief consume bytes without reading them
+         *
+         * @param length the number of bytes to skip
+         * @return ByteBuffer& this
+         */
+        ByteBuffer &skip(size_t length);
+        /**
+         * @brief write a block of raw bytes with one memcpy
+         *
+         * @param src the source of the data
+         * @param length the length of the data
+         * @return ByteBuffer& this
+         */
+        ByteBuffer &writeBytes(const void *src, size_t length);
+        /**
+         * @brief write a constant such as "1A 2B"_hex with one memcpy
+         *
+         * @param bytes the bytes
+         * @return ByteBuffer& this
+         */
+        template <size_t N>
+        ByteBuffer &writeBytes(const std::array<uint8_t, N> &bytes)
+        {
+            return writeBytes(bytes.data(), N);
+        }
+        /// @brief move the unread bytes to the beginning of the buffer
+        void compact();
+        /// @brief drop all the data, keeping the allocated memory
+        void clear();
+        /// @brief whether this buffer is a read only view
+        bool readOnly() const;
     };
 
 };
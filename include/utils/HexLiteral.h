@@ -0,0 +1,105 @@
+/**
+ * @file HexLiteral.h
+ * @author maxwellzs
+ * @brief this file defines the hex literals of the protocol constants
+ * "1A 2B 3C"_hex is parsed by the compiler into a std::array<uint8_t, 3>, a digit
+ * without its pair or a character that is not hex fails the build, so the fixed
+ * tlvs, signatures and keys cost a memcpy when a packet is built
+ * the digits go in pairs separated by white space, the grammar of ByteBuffer::writeHexString
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#ifndef HexLiteral_h
+#define HexLiteral_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief the value of a hex digit in either case
+     *
+     * @return int from 0 to 15, -1 if c is not a hex digit
+     */
+    constexpr int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    /// @brief the white space separating the pairs of a hex text
+    constexpr bool isHexSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    /**
+     * @brief the text of a hex literal checked at compile time, the template argument of _hex
+     *
+     */
+    template <size_t N>
+    struct HexText
+    {
+        char text[N] = {};
+        /// @brief the bytes the text stands for
+        size_t bytes = 0;
+
+        consteval HexText(const char (&literal)[N])
+        {
+            for (size_t i = 0; i < N; i++)
+                text[i] = literal[i];
+            // the terminating 0 is not part of the text
+            for (size_t i = 0; i + 1 < N;)
+            {
+                if (isHexSpace(text[i]))
+                {
+                    i++;
+                    continue;
+                }
+                // evaluated at compile time, the throw stops the build
+                if (i + 2 >= N || hexValue(text[i]) < 0 || hexValue(text[i + 1]) < 0 ||
+                    (i + 3 < N && !isHexSpace(text[i + 2])))
+                    throw "a hex literal is made of pairs of hex digits separated by white space";
+                bytes++;
+                i += 2;
+            }
+        }
+    };
+
+    /**
+     * @brief "95 7C 3A AF"_hex is the std::array<uint8_t, 4> of the bytes
+     *
+     */
+    template <HexText T>
+    consteval std::array<uint8_t, T.bytes> operator""_hex()
+    {
+        std::array<uint8_t, T.bytes> result = {};
+        size_t written = 0;
+        for (size_t i = 0; written < T.bytes;)
+        {
+            if (isHexSpace(T.text[i]))
+            {
+                i++;
+                continue;
+            }
+            result[written++] = (uint8_t)(hexValue(T.text[i]) << 4 | hexValue(T.text[i + 1]));
+            i += 2;
+        }
+        return result;
+    }
+
+};
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file Metrics.h
+ * @author maxwellzs
+ * @brief this file defines the counters, gauges and latency histograms of the library
+ * every thread updates its own shard with plain relaxed stores, there is no shared
+ * cache line and no locked instruction on the hot path, a snapshot merges the shards
+ * the metrics are declared as statics next to the code they measure,
+ * build with -DQQ_METRICS=0 to compile the updates out
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "utils/TscClock.h"
+
+#ifndef Metrics_h
+#define Metrics_h
+
+#ifndef QQ_METRICS
+#define QQ_METRICS 1
+#endif
+
+namespace QQDommy
+{
+
+    /// @brief the ids of every kind, id 0 takes the metrics registered beyond the limit
+    const static size_t MAX_COUNTERS = 256;
+    const static size_t MAX_GAUGES = 64;
+    const static size_t MAX_HISTOGRAMS = 64;
+    /// @brief every power of 2 is split into 2^HISTOGRAM_SUB_BITS buckets, about 6% apart
+    const static unsigned HISTOGRAM_SUB_BITS = 4;
+    /// @brief values from 2^HISTOGRAM_MAX_EXPONENT up share the last bucket
+    const static unsigned HISTOGRAM_MAX_EXPONENT = 44;
+    const static size_t HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS;
+
+    typedef enum
+    {
+        /// @brief recorded and exported as they are
+        UNIT_NONE,
+        /// @brief recorded in TscClock ticks, exported in nanoseconds
+        UNIT_TICKS
+    } METRIC_UNIT;
+
+    struct HistogramShard
+    {
+        std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS];
+        std::atomic<uint64_t> sum;
+    };
+
+    /// @brief the metrics of one thread, only written by that thread
+    struct MetricsShard
+    {
+        std::atomic<uint64_t> counters[MAX_COUNTERS];
+        /// @brief allocated the first time the thread records into the histogram
+        std::atomic<HistogramShard *> histograms[MAX_HISTOGRAMS];
+    };
+
+    struct CounterSnapshot
+    {
+        std::string name;
+        std::string help;
+        uint64_t value;
+    };
+
+    struct GaugeSnapshot
+    {
+        std::string name;
+        std::string help;
+        int64_t value;
+    };
+
+    struct HistogramSnapshot
+    {
+        std::string name;
+        std::string help;
+        uint64_t count = 0;
+        double sum = 0;
+        /// @brief the upper bound and the count of every bucket with a value, in order
+        std::vector<std::pair<double, uint64_t>> buckets;
+        /**
+         * @brief the upper bound of the bucket holding a quantile
+         *
+         * @param quantile from 0 to 1
+         * @return double the bound, 0 if the histogram is empty
+         */
+        double percentile(double quantile) const;
+    };
+
+    struct MetricsSnapshot
+    {
+        std::vector<CounterSnapshot> counters;
+        std::vector<GaugeSnapshot> gauges;
+        std::vector<HistogramSnapshot> histograms;
+        /// @brief the wall clock of the snapshot in milliseconds
+        int64_t timestampMs = 0;
+    };
+
+    class Metrics
+    {
+    private:
+        static inline thread_local MetricsShard *localShard = nullptr;
+        Metrics();
+        /// @brief create the shard of the calling thread, it is merged into the totals when the thread exits
+        static MetricsShard *attach();
+        static HistogramShard *attachHistogram(MetricsShard *shard, uint32_t id);
+
+    public:
+        static uint32_t registerCounter(const char *name, const char *help);
+        static std::atomic<int64_t> *registerGauge(const char *name, const char *help);
+        static uint32_t registerHistogram(const char *name, const char *help, METRIC_UNIT unit);
+        /// @brief the shard of the calling thread
+        static MetricsShard *shard()
+        {
+            MetricsShard *shard = localShard;
+            return shard != nullptr ? shard : attach();
+        }
+        static HistogramShard *histogram(MetricsShard *shard, uint32_t id)
+        {
+            HistogramShard *histogram = shard->histograms[id].load(std::memory_order_relaxed);
+            return histogram != nullptr ? histogram : attachHistogram(shard, id);
+        }
+        /// @brief the bucket of a value, log-linear
+        static size_t bucketOf(uint64_t value)
+        {
+            if (value < (1u << HISTOGRAM_SUB_BITS))
+                return value;
+            unsigned exponent = 63 - __builtin_clzll(value);
+            if (exponent >= HISTOGRAM_MAX_EXPONENT)
+                return HISTOGRAM_BUCKETS - 1;
+            return ((exponent - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) +
+                   ((value >> (exponent - HISTOGRAM_SUB_BITS)) & ((1u << HISTOGRAM_SUB_BITS) - 1));
+        }
+        /// @brief the largest value of a bucket
+        static uint64_t bucketLimit(size_t bucket);
+        /**
+         * @brief merge the shards of all the threads, the living ones are read while they run
+         *
+         * @return MetricsSnapshot the metrics in the order they were registered
+         */
+        static MetricsSnapshot snapshot();
+    };
+
+    /**
+     * @brief a monotonic count, e.g. the bytes copied
+     *
+     */
+    class Counter
+    {
+    private:
+        uint32_t id;
+
+    public:
+        Counter(const char *name, const char *help) : id(Metrics::registerCounter(name, help)) {}
+        void add(uint64_t amount = 1) const
+        {
+#if QQ_METRICS
+            // only this thread writes the slot, no locked instruction is needed
+            std::atomic<uint64_t> &slot = Metrics::shard()->counters[id];
+            slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+#endif
+        }
+    };
+
+    /**
+     * @brief a value that goes up and down, e.g. the connections open
+     * it is shared by the threads, so it is meant for the slow paths
+     *
+     */
+    class Gauge
+    {
+    private:
+        std::atomic<int64_t> *value;
+
+    public:
+        Gauge(const char *name, const char *help) : value(Metrics::registerGauge(name, help)) {}
+        void set(int64_t current) const { value->store(current, std::memory_order_relaxed); }
+        void add(int64_t delta) const { value->fetch_add(delta, std::memory_order_relaxed); }
+    };
+
+    /**
+     * @brief the distribution of a value, e.g. the time to encode a packet
+     *
+     */
+    class Histogram
+    {
+    private:
+        uint32_t id;
+
+    public:
+        Histogram(const char *name, const char *help, METRIC_UNIT unit = UNIT_NONE)
+            : id(Metrics::registerHistogram(name, help, unit)) {}
+        void record(uint64_t value) const
+        {
+#if QQ_METRICS
+            HistogramShard *shard = Metrics::histogram(Metrics::shard(), id);
+            std::atomic<uint64_t> &bucket = shard->buckets[Metrics::bucketOf(value)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            shard->sum.store(shard->sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+#endif
+        }
+    };
+
+    /**
+     * @brief records the ticks from its construction to its destruction into a UNIT_TICKS histogram
+     *
+     */
+    class ScopedTimer
+    {
+    private:
+        const Histogram &histogram;
+#if QQ_METRICS
+        uint64_t start = TscClock::now();
+#endif
+
+    public:
+        explicit ScopedTimer(const Histogram &histogram) : histogram(histogram) {}
+        ~ScopedTimer()
+        {
+#if QQ_METRICS
+            histogram.record(TscClock::now() - start);
+#endif
+        }
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+    };
+
+};
+
+#endif
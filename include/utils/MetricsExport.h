@@ -0,0 +1,70 @@
+/**
+ * @file MetricsExport.h
+ * @author maxwellzs
+ * @brief this file defines the text forms of a metrics snapshot, json for the dashboard
+ * and the prometheus text format for a node exporter reading a local file or a pipe
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <string>
+#include <exception>
+#include "utils/Metrics.h"
+#include "utils/ByteBuffer.h"
+
+#ifndef MetricsExport_h
+#define MetricsExport_h
+
+namespace QQDommy
+{
+
+    class MetricsExportException : public std::exception
+    {
+    private:
+        std::string reason;
+
+    public:
+        MetricsExportException(const std::string &path, const std::string &error);
+        const char *what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT override;
+    };
+
+    class MetricsExport
+    {
+    private:
+        MetricsExport();
+
+    public:
+        /**
+         * @brief write a snapshot as one json object
+         * the histograms carry their count, sum, p50, p90, p99, max and the buckets with a value
+         *
+         * @param snapshot the snapshot
+         * @param out the buffer, the text is appended
+         */
+        static void toJson(const MetricsSnapshot &snapshot, ByteBuffer &out);
+        /**
+         * @brief write a snapshot in the prometheus text format
+         * the buckets of a histogram are cumulative, the last one is +Inf
+         *
+         * @param snapshot the snapshot
+         * @param out the buffer, the text is appended
+         */
+        static void toPrometheus(const MetricsSnapshot &snapshot, ByteBuffer &out);
+        /**
+         * @brief write the readable bytes of a buffer to a file or a named pipe
+         * a regular file is written aside and renamed, a reader never sees half of it
+         * a pipe whose reader goes away fails with EPIPE, SIGPIPE is blocked while writing it
+         * throws MetricsExportException when the path cannot be written
+         *
+         * @param path the path of the file or the pipe
+         * @param text the text, it is not consumed
+         */
+        static void writeFile(const std::string &path, const ByteBuffer &text);
+    };
+
+};
+
+#endif
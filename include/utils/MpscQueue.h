@@ -0,0 +1,147 @@
+/**
+ * @file MpscQueue.h
+ * @author maxwellzs
+ * @brief this file defines a bounded multi producer single consumer queue
+ * producers only contend on one atomic counter, the consumer takes no lock at all
+ * every cell carries a sequence number telling whether it is free or filled
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#ifndef MpscQueue_h
+#define MpscQueue_h
+
+namespace QQDommy
+{
+
+    template <typename T>
+    class MpscQueue
+    {
+    private:
+        struct alignas(64) Cell
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        /// @brief producers and the consumer are kept on different cache lines
+        alignas(64) std::atomic<size_t> enqueuePos{0};
+        alignas(64) std::atomic<size_t> dequeuePos{0};
+
+        /**
+         * @brief reserve a free cell for a producer
+         *
+         * @return Cell* the reserved cell, nullptr if the queue is full
+         */
+        Cell *reserve(size_t &pos)
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell *cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        return cell;
+                }
+                else if (diff < 0)
+                    return nullptr;
+                else
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        /**
+         * @brief Construct a new Mpsc Queue object
+         *
+         * @param capacity the number of cells, rounded up to a power of 2
+         */
+        explicit MpscQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            cells.reset(new Cell[size]);
+            mask = size - 1;
+            for (size_t i = 0; i < size; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        /**
+         * @brief push a value, can be called from any thread
+         *
+         * @param value the value moved into the queue
+         * @return true if pushed
+         * @return false if the queue is full, the value is left untouched
+         */
+        bool push(T &&value)
+        {
+            size_t pos;
+            Cell *cell = reserve(pos);
+            if (cell == nullptr)
+                return false;
+            cell->value = std::move(value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+        bool push(const T &value)
+        {
+            T copy(value);
+            return push(std::move(copy));
+        }
+
+        /**
+         * @brief pop a value, must only be called from the consumer thread
+         *
+         * @param out where the value is moved to
+         * @return true if a value was popped
+         * @return false if the queue is empty
+         */
+        bool pop(T &out)
+        {
+            // only the consumer writes the position, relaxed is enough
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            Cell *cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+                return false;
+            out = std::move(cell->value);
+            cell->value = T();
+            // the cell becomes free for the producer one lap later
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// @brief the number of values in the queue, only exact when no one is pushing
+        size_t sizeApprox() const
+        {
+            size_t head = enqueuePos.load(std::memory_order_relaxed);
+            size_t tail = dequeuePos.load(std::memory_order_relaxed);
+            return head > tail ? head - tail : 0;
+        }
+
+        size_t getCapacity() const
+        {
+            return mask + 1;
+        }
+    };
+
+};
+
+#endif
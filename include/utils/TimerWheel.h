@@ -0,0 +1,130 @@
+/**
+ * @file TimerWheel.h
+ * @author maxwellzs
+ * @brief this file defines the hashed hierarchical timer wheel used for heartbeats,
+ * token refresh and request timeouts
+ * inserting and cancelling a timer is O(1), all the timers of one tick expire together,
+ * and the timer nodes are pooled so scheduling does not allocate in steady state
+ * the wheel is NOT thread safe, it belongs to the thread of one event loop
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+
+#ifndef TimerWheel_h
+#define TimerWheel_h
+
+namespace QQDommy
+{
+
+    /// @brief identifies a scheduled timer, 0 is never a valid id
+    typedef uint64_t TimerId;
+    typedef std::function<void()> TimerCallback;
+
+    /// @brief the length of one tick in milliseconds
+    const static int DEFAULT_TICK_MS = 10;
+    /// @brief the first level has 256 slots, every higher level 64
+    const static size_t WHEEL_LEVEL0_BITS = 8;
+    const static size_t WHEEL_LEVEL_BITS = 6;
+    const static size_t WHEEL_LEVELS = 4;
+    /// @brief the number of timer nodes allocated at once
+    const static size_t TIMER_CHUNK_SIZE = 1024;
+
+    class TimerWheel
+    {
+    private:
+        /// @brief the links of the intrusive list, the slots only hold the sentinel
+        struct TimerLink
+        {
+            TimerLink *prev = this;
+            TimerLink *next = this;
+        };
+        struct TimerNode : public TimerLink
+        {
+            uint64_t expire = 0;
+            /// @brief in ticks, 0 for a one shot timer
+            uint64_t interval = 0;
+            uint32_t index = 0;
+            uint32_t generation = 1;
+            bool active = false;
+            bool firing = false;
+            bool cancelled = false;
+            TimerCallback callback;
+        };
+
+        std::chrono::steady_clock::time_point start;
+        std::chrono::milliseconds tick;
+        /// @brief the next tick to be processed
+        uint64_t currentTick = 0;
+        size_t count = 0;
+        std::vector<TimerLink> slots[WHEEL_LEVELS];
+        std::vector<std::unique_ptr<TimerNode[]>> chunks;
+        std::vector<uint32_t> freeNodes;
+
+        TimerNode *allocate();
+        void recycle(TimerNode *node);
+        TimerNode *find(TimerId id);
+        /// @brief link the node into the slot matching its expire tick
+        void place(TimerNode *node);
+        static void unlink(TimerLink *link);
+        /// @brief move the timers of a higher level slot down to lower levels
+        void cascade(size_t level, size_t index);
+        /// @brief run every timer expiring at the current tick
+        size_t processTick();
+        uint64_t ticksOf(std::chrono::steady_clock::time_point t) const;
+
+    public:
+        /**
+         * @brief Construct a new Timer Wheel object
+         *
+         * @param tickMs the resolution of the wheel
+         */
+        TimerWheel(int tickMs = DEFAULT_TICK_MS);
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+        /**
+         * @brief schedule a timer
+         *
+         * @param delayMs the delay before the first expiry, rounded up to a tick
+         * @param callback called on expiry
+         * @param intervalMs when not 0 the timer repeats with this period until cancelled
+         * @return TimerId the id used to cancel the timer
+         */
+        TimerId schedule(int delayMs, const TimerCallback &callback, int intervalMs = 0);
+        /**
+         * @brief cancel a timer, it is safe to cancel an expired or cancelled timer
+         * a timer can cancel itself or others from inside its callback
+         *
+         * @param id the id of the timer
+         * @return true if the timer was pending
+         */
+        bool cancel(TimerId id);
+        /**
+         * @brief expire all the timers up to the given time
+         *
+         * @param now the current time
+         * @return size_t the number of callbacks called
+         */
+        size_t advance(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+        /**
+         * @brief the time until the next timer may expire, used as the wait timeout of the loop
+         *
+         * @param now the current time
+         * @return int milliseconds to wait, -1 if there are no timers
+         */
+        int nextTimeout(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) const;
+        /// @brief the number of pending timers
+        size_t size() const;
+    };
+
+};
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file Tracing.h
+ * @author maxwellzs
+ * @brief this file defines the spans showing where the time of one flow goes, e.g. a login
+ * a flow is sampled when its root scope opens, only the spans of the sampled flows are
+ * recorded, the others cost a thread local load and a branch
+ * a span is a static name and two TscClock ticks written into the ring of its thread,
+ * the rings are collected later and exported in the trace event format of chrome
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include "utils/TscClock.h"
+#include "utils/ByteBuffer.h"
+
+#ifndef Tracing_h
+#define Tracing_h
+
+namespace QQDommy
+{
+
+    /// @brief the events kept per thread, the oldest are overwritten
+    const static size_t TRACE_RING_SIZE = 8192;
+
+    typedef enum
+    {
+        /// @brief runs on one thread without suspending, nested by time on its thread
+        SPAN_SYNC,
+        /// @brief may suspend, e.g. waiting for a response, shown on the track of its flow
+        SPAN_ASYNC
+    } SPAN_KIND;
+
+    struct TraceEvent
+    {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+        /// @brief the flow the event belongs to
+        uint64_t flow;
+        SPAN_KIND kind;
+        /// @brief the thread which recorded the event
+        int tid;
+    };
+
+    /**
+     * @brief the events of one thread, written by that thread only
+     * a reader copies the slots between two counters and drops those overwritten meanwhile
+     *
+     */
+    class TraceRing
+    {
+    private:
+        struct Slot
+        {
+            std::atomic<const char *> name;
+            std::atomic<uint64_t> start;
+            std::atomic<uint64_t> end;
+            std::atomic<uint64_t> flow;
+            std::atomic<SPAN_KIND> kind;
+        };
+        std::unique_ptr<Slot[]> slots;
+        /// @brief the writes started, then the writes finished
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<uint64_t> committed{0};
+
+    public:
+        int tid;
+        /// @brief set by Tracer::nameThread, a static string
+        std::atomic<const char *> threadName{nullptr};
+        /// @brief the thread has exited, the ring is freed once collected
+        std::atomic<bool> closed{false};
+
+        explicit TraceRing(int tid);
+        void push(const char *name, uint64_t start, uint64_t end, uint64_t flow, SPAN_KIND kind)
+        {
+            uint64_t index = claimed.load(std::memory_order_relaxed);
+            claimed.store(index + 1, std::memory_order_relaxed);
+            // a reader seeing any field of this write also sees the claim
+            std::atomic_thread_fence(std::memory_order_release);
+            Slot &slot = slots[index & (TRACE_RING_SIZE - 1)];
+            slot.name.store(name, std::memory_order_relaxed);
+            slot.start.store(start, std::memory_order_relaxed);
+            slot.end.store(end, std::memory_order_relaxed);
+            slot.flow.store(flow, std::memory_order_relaxed);
+            slot.kind.store(kind, std::memory_order_relaxed);
+            committed.store(index + 1, std::memory_order_release);
+        }
+        /**
+         * @brief copy the events still in the ring, oldest first
+         *
+         * @param events the events are appended
+         */
+        void copyTo(std::vector<TraceEvent> &events) const;
+    };
+
+    class Tracer
+    {
+    private:
+        static inline thread_local TraceRing *localRing = nullptr;
+        /// @brief the flow running on this thread, 0 when it is not sampled
+        static inline thread_local uint64_t currentFlow = 0;
+        /// @brief the root scopes left before the next sampled one
+        static inline thread_local uint32_t countdown = 0;
+        Tracer();
+        static TraceRing *attach();
+        static bool sampleSlow();
+
+    public:
+        /**
+         * @brief trace one flow in every given number, 0 disables the tracing
+         * 100 samples 1% of the flows
+         *
+         * @param every the interval of the sampled flows
+         */
+        static void setSampling(uint32_t every);
+        /// @brief decide whether the flow starting now is sampled
+        static bool sample()
+        {
+            if (countdown > 1)
+            {
+                countdown--;
+                return false;
+            }
+            return sampleSlow();
+        }
+        /// @brief a new flow id, never 0
+        static uint64_t newFlow();
+        static uint64_t flow() { return currentFlow; }
+        static void setFlow(uint64_t flow) { currentFlow = flow; }
+        /**
+         * @brief leave the flow before a coroutine suspends, other flows run on the thread meanwhile
+         *
+         * @return uint64_t the flow, give it back to resume
+         */
+        static uint64_t suspend() { return std::exchange(currentFlow, 0); }
+        static void resume(uint64_t flow) { currentFlow = flow; }
+        static void record(const char *name, uint64_t start, uint64_t end, uint64_t flow, SPAN_KIND kind)
+        {
+            TraceRing *ring = localRing;
+            (ring != nullptr ? ring : attach())->push(name, start, end, flow, kind);
+        }
+        /// @brief the name of the calling thread in the trace, a static string
+        static void nameThread(const char *name);
+        /**
+         * @brief copy the events of all the threads, the rings of the exited threads are freed
+         *
+         * @return std::vector<TraceEvent> the events of every thread, oldest first
+         */
+        static std::vector<TraceEvent> collect();
+        /**
+         * @brief write events as a json trace for chrome://tracing or perfetto
+         * the spans are complete events, the async events are begin and end pairs on
+         * the track of their flow, the times are in microseconds from the first event
+         *
+         * @param events the events
+         * @param out the buffer, the text is appended
+         */
+        static void toChrome(const std::vector<TraceEvent> &events, ByteBuffer &out);
+    };
+
+    /**
+     * @brief the root of a flow, decides the sampling and traces the whole flow as an async event
+     * it may be kept across co_await, the awaiters of the library leave and resume the flow
+     *
+     */
+    class TraceScope
+    {
+    private:
+        const char *name;
+        uint64_t flow = 0;
+        uint64_t previous;
+        uint64_t start = 0;
+
+    public:
+        explicit TraceScope(const char *name) : name(name), previous(Tracer::flow())
+        {
+            if (!Tracer::sample())
+            {
+                Tracer::setFlow(0);
+                return;
+            }
+            flow = Tracer::newFlow();
+            Tracer::setFlow(flow);
+            start = TscClock::now();
+        }
+        ~TraceScope()
+        {
+            if (flow != 0)
+                Tracer::record(name, start, TscClock::now(), flow, SPAN_ASYNC);
+            Tracer::setFlow(previous);
+        }
+        bool sampled() const { return flow != 0; }
+        TraceScope(const TraceScope &) = delete;
+        TraceScope &operator=(const TraceScope &) = delete;
+    };
+
+    /**
+     * @brief a span of the flow running on this thread, nothing is recorded outside a sampled flow
+     * it must not be kept across co_await
+     *
+     */
+    class TraceSpan
+    {
+    private:
+        const char *name;
+        uint64_t flow;
+        uint64_t start = 0;
+
+    public:
+        explicit TraceSpan(const char *name) : name(name), flow(Tracer::flow())
+        {
+            if (flow != 0)
+                start = TscClock::now();
+        }
+        ~TraceSpan()
+        {
+            if (flow != 0)
+                Tracer::record(name, start, TscClock::now(), flow, SPAN_SYNC);
+        }
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+    };
+
+};
+
+#endif
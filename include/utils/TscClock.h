@@ -0,0 +1,78 @@
+/**
+ * @file TscClock.h
+ * @author maxwellzs
+ * @brief this file defines a cheap timestamp for the hot paths, the time stamp counter
+ * of the cpu where there is one, and its conversion to the wall clock done later
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef TscClock_h
+#define TscClock_h
+
+namespace QQDommy
+{
+
+    /**
+     * @brief maps the ticks to the wall clock, a snapshot can be used from any thread
+     *
+     */
+    struct TscCalibration
+    {
+        uint64_t baseTicks = 0;
+        /// @brief CLOCK_MONOTONIC at baseTicks, the rate is measured against it so a step of the wall clock never skews it
+        int64_t baseNs = 0;
+        double nsPerTick = 1;
+        /// @brief CLOCK_REALTIME minus CLOCK_MONOTONIC at the last calibration, only used to render the wall clock
+        int64_t realtimeOffsetNs = 0;
+        int64_t toRealtimeNs(uint64_t ticks) const
+        {
+            return baseNs + realtimeOffsetNs + (int64_t)((double)(int64_t)(ticks - baseTicks) * nsPerTick);
+        }
+    };
+
+    class TscClock
+    {
+    private:
+        TscClock();
+
+    public:
+        /// @brief the current tick, the counter is invariant on every cpu we run on
+        static uint64_t now()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+#endif
+        }
+        /**
+         * @brief measure the rate of the ticks against the monotonic clock and the offset of the wall clock
+         * the first call blocks about 10 ms, later calls refine it over a longer span
+         * call it from a background thread now and then
+         *
+         * @return TscCalibration the calibration
+         */
+        static TscCalibration calibrate();
+        /**
+         * @brief the last calibration, calibrate first if there is none
+         *
+         * @return TscCalibration the calibration
+         */
+        static TscCalibration calibration();
+    };
+
+};
+
+#endif
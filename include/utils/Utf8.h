@@ -0,0 +1,48 @@
+/**
+ * @file Utf8.h
+ * @author maxwellzs
+ * @brief this file defines the validation of the utf-8 text carried by the packets
+ * with avx2 the text is checked 32 bytes at a time by table lookups, the way of
+ * simdjson, without branching on the content, elsewhere a scalar check skips the
+ * ascii 8 bytes at a time
+ * overlong forms, surrogates and code points above U+10FFFF are rejected
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef Utf8_h
+#define Utf8_h
+
+namespace QQDommy
+{
+
+    class Utf8
+    {
+    private:
+        Utf8();
+
+    public:
+        /**
+         * @brief check a text with the fastest way the cpu supports
+         *
+         * @param text the text
+         * @param length the length in bytes
+         * @return true the text is valid utf-8
+         * @return false the text is not
+         */
+        static bool validate(const char *text, size_t length);
+        /// @brief the check without simd, the reference of the vectorized one
+        static bool validateScalar(const char *text, size_t length);
+        /// @brief whether validate uses simd on this cpu
+        static bool vectorized();
+    };
+
+};
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file WorkDeque.h
+ * @author maxwellzs
+ * @brief this file defines the chase-lev work stealing deque
+ * the owner pushes and pops at the bottom without a locked instruction unless one
+ * item is left, thieves take from the top with one compare and swap
+ * the deque grows when full, the former arrays are kept until the deque is destroyed
+ * since a thief may still read from them
+ * the memory orders follow "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#ifndef WorkDeque_h
+#define WorkDeque_h
+
+namespace QQDommy
+{
+
+    const static size_t DEFAULT_DEQUE_CAPACITY = 1024;
+
+    /**
+     * @brief a deque of pointers, nullptr is returned when there is nothing to take
+     *
+     * @tparam T the type pointed to
+     */
+    template <typename T>
+    class WorkDeque
+    {
+    private:
+        struct Ring
+        {
+            size_t mask;
+            std::unique_ptr<std::atomic<T *>[]> items;
+            explicit Ring(size_t capacity) : mask(capacity - 1), items(new std::atomic<T *>[capacity]) {}
+            size_t capacity() const { return mask + 1; }
+            T *get(int64_t index) const { return items[index & mask].load(std::memory_order_relaxed); }
+            void put(int64_t index, T *item) { items[index & mask].store(item, std::memory_order_relaxed); }
+        };
+
+        /// @brief thieves and the owner are kept on different cache lines
+        alignas(64) std::atomic<int64_t> top{0};
+        alignas(64) std::atomic<int64_t> bottom{0};
+        std::atomic<Ring *> ring;
+        /// @brief every ring ever used, only touched by the owner
+        std::vector<std::unique_ptr<Ring>> rings;
+
+        Ring *grow(Ring *old, int64_t from, int64_t to)
+        {
+            Ring *bigger = new Ring(old->capacity() * 2);
+            for (int64_t i = from; i < to; i++)
+                bigger->put(i, old->get(i));
+            rings.emplace_back(bigger);
+            ring.store(bigger, std::memory_order_release);
+            return bigger;
+        }
+
+    public:
+        /**
+         * @brief Construct a new Work Deque object
+         *
+         * @param capacity the initial capacity, rounded up to a power of 2
+         */
+        explicit WorkDeque(size_t capacity = DEFAULT_DEQUE_CAPACITY)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            rings.emplace_back(new Ring(size));
+            ring.store(rings.back().get(), std::memory_order_relaxed);
+        }
+        WorkDeque(const WorkDeque &) = delete;
+        WorkDeque &operator=(const WorkDeque &) = delete;
+
+        /// @brief add an item at the bottom, owner only
+        void push(T *item)
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed);
+            int64_t t = top.load(std::memory_order_acquire);
+            Ring *current = ring.load(std::memory_order_relaxed);
+            if (b - t > (int64_t)current->capacity() - 1)
+                current = grow(current, t, b);
+            current->put(b, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+
+        /// @brief take the newest item, owner only
+        T *pop()
+        {
+            int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            Ring *current = ring.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top.load(std::memory_order_relaxed);
+            if (t > b)
+            {
+                // empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            T *item = current->get(b);
+            if (t == b)
+            {
+                // the last item, a thief may race for it
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        /// @brief take the oldest item, from any thread
+        T *steal()
+        {
+            int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+            T *item = ring.load(std::memory_order_acquire)->get(t);
+            // another thief or the owner got it first
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+            return item;
+        }
+
+        /// @brief whether the deque looked empty, a hint only
+        bool empty() const
+        {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+    };
+
+};
+
+#endif
@@ -0,0 +1,422 @@
+#include "core/EventBus.h"
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+namespace QQDommy
+{
+
+    typedef enum
+    {
+        BUS_SLOT_FREE = 0,
+        /// @brief taken by a subscriber setting its cursor, not waited for yet
+        BUS_SLOT_CLAIMED,
+        BUS_SLOT_ACTIVE,
+        /// @brief in a poll, the publisher neither evicts it nor writes past its cursor
+        BUS_SLOT_READING,
+        /// @brief cut loose by the publisher, the subscriber starts over at the newest event
+        BUS_SLOT_EVICTED
+    } BUS_SLOT_STATE;
+
+    struct alignas(64) BusSlot
+    {
+        /// @brief the state in the low half and the pid of the subscriber in the high half, changed
+        /// together so that a slot is never taken from the process that just reclaimed it
+        std::atomic<uint64_t> owner;
+        /// @brief the position of the next event to read
+        std::atomic<uint64_t> cursor;
+        std::atomic<uint64_t> lost;
+    };
+
+    /// @brief the part of the header checked before the bus is mapped
+    struct BusLayout
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t maxSubscribers;
+        uint64_t capacity;
+    };
+
+    struct BusHeader
+    {
+        BusLayout layout;
+        /// @brief the position past the newest event, the only word read by every subscriber on every poll
+        alignas(64) std::atomic<uint64_t> head;
+        /// @brief the sequence of the newest event, published or dropped
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> dropped;
+        std::atomic<uint64_t> evictions;
+        alignas(64) BusSlot slots[BUS_MAX_SUBSCRIBERS];
+    };
+
+    struct BusEventHeader
+    {
+        uint32_t length;
+        uint16_t type;
+        uint16_t reserved;
+        uint64_t sequence;
+    };
+
+    // the header is shared between processes, so nothing in it may hide a lock
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(sizeof(BusHeader) <= BUS_HEADER_SIZE);
+    static_assert(sizeof(BusEventHeader) == BUS_EVENT_ALIGN);
+
+};
+
+/// @brief the bytes an event takes in the ring
+static size_t eventSize(size_t length)
+{
+    return (QQDommy::BUS_EVENT_ALIGN + length + QQDommy::BUS_EVENT_ALIGN - 1) & ~(QQDommy::BUS_EVENT_ALIGN - 1);
+}
+
+static uint64_t slotOwner(uint32_t state, int32_t pid)
+{
+    return (uint64_t)(uint32_t)pid << 32 | state;
+}
+
+static uint32_t stateOf(uint64_t owner)
+{
+    return (uint32_t)owner;
+}
+
+static int32_t pidOf(uint64_t owner)
+{
+    return (int32_t)(owner >> 32);
+}
+
+/// @brief whether the process is known to be gone, a pid of another namespace counts as alive
+static bool processGone(int32_t pid)
+{
+    return pid > 0 && kill(pid, 0) < 0 && errno == ESRCH;
+}
+
+QQDommy::EventBusException::EventBusException(const std::string &msg)
+{
+    this->msg = "event bus error : " + msg;
+}
+
+const char *QQDommy::EventBusException::what() const noexcept
+{
+    return msg.c_str();
+}
+
+QQDommy::EventPublisher::EventPublisher(const std::string &name, size_t capacity) : name(name), capacity(capacity)
+{
+    if (capacity < BUS_HEADER_SIZE || (capacity & (capacity - 1)) != 0)
+        throw EventBusException("the capacity must be a power of 2 of at least a page");
+    mappedSize = BUS_HEADER_SIZE + capacity;
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        throw EventBusException("can't open " + name);
+    // a second publisher would interleave its events with the first
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+    {
+        ::close(fd);
+        throw EventBusException(name + " has another publisher");
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        ::close(fd);
+        throw EventBusException("can't stat " + name);
+    }
+    BusLayout existing = {};
+    bool resumed = (size_t)st.st_size == mappedSize && pread(fd, &existing, sizeof(existing), 0) == sizeof(existing) &&
+                   existing.magic == BUS_MAGIC && existing.version == BUS_VERSION && existing.capacity == capacity;
+    if (!resumed && st.st_size != 0)
+    {
+        // the subscribers of a bus of another layout keep their mapping, which is never written again
+        ::close(fd);
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0)
+            throw EventBusException("can't recreate " + name);
+        // another publisher may have recreated it first
+        if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+        {
+            ::close(fd);
+            throw EventBusException(name + " has another publisher");
+        }
+    }
+    if (!resumed && ftruncate(fd, mappedSize) < 0)
+    {
+        ::close(fd);
+        throw EventBusException("can't size " + name);
+    }
+    // populated now, so that publishing does not fault the pages in
+    void *address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        ::close(fd);
+        throw EventBusException("can't map " + name);
+    }
+    mapped = static_cast<uint8_t *>(address);
+    header = reinterpret_cast<BusHeader *>(mapped);
+    ring = mapped + BUS_HEADER_SIZE;
+    if (resumed)
+    {
+        // the subscribers carry on where the former publisher stopped
+        head = header->head.load(std::memory_order_acquire);
+        sequence = header->sequence.load(std::memory_order_relaxed);
+        return;
+    }
+    header->layout.version = BUS_VERSION;
+    header->layout.maxSubscribers = BUS_MAX_SUBSCRIBERS;
+    header->layout.capacity = capacity;
+    // the magic goes last, a subscriber finding it sees the rest
+    std::atomic_ref<uint32_t>(header->layout.magic).store(BUS_MAGIC, std::memory_order_release);
+}
+
+QQDommy::EventPublisher::~EventPublisher()
+{
+    munmap(mapped, mappedSize);
+    ::close(fd);
+}
+
+uint64_t QQDommy::EventPublisher::gate(uint64_t need)
+{
+    // pairs with the fence of a subscriber attaching, one of the two sees the other
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint64_t lowest = head;
+    for (BusSlot &slot : header->slots)
+    {
+        uint64_t owner = slot.owner.load(std::memory_order_acquire);
+        uint32_t state = stateOf(owner);
+        // an evicted subscriber that died never comes back to take its slot
+        if (state == BUS_SLOT_EVICTED && processGone(pidOf(owner)))
+            slot.owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_FREE, 0), std::memory_order_acq_rel);
+        if (state != BUS_SLOT_ACTIVE && state != BUS_SLOT_READING)
+            continue;
+        uint64_t cursor = slot.cursor.load(std::memory_order_acquire);
+        if (head + need - cursor > capacity)
+        {
+            // one holding the ring full may have died, in a poll or between two
+            if (processGone(pidOf(owner)))
+            {
+                if (slot.owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_FREE, 0), std::memory_order_acq_rel))
+                    continue;
+            }
+            // a living subscriber between two polls is evicted
+            else if (state == BUS_SLOT_ACTIVE &&
+                     slot.owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_EVICTED, pidOf(owner)), std::memory_order_acq_rel))
+            {
+                header->evictions.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            // it began a poll, its cursor stands
+            cursor = slot.cursor.load(std::memory_order_acquire);
+        }
+        lowest = std::min(lowest, cursor);
+    }
+    return lowest + capacity;
+}
+
+bool QQDommy::EventPublisher::publish(uint16_t type, const void *data, size_t length)
+{
+    if (type == BUS_PADDING)
+        throw EventBusException("the type BUS_PADDING is reserved");
+    size_t size = eventSize(length);
+    if (size > capacity / 4)
+        throw EventBusException("an event of " + std::to_string(length) + " bytes does not fit the bus");
+    size_t offset = head & (capacity - 1);
+    size_t room = capacity - offset;
+    // an event never wraps, the end of the ring is skipped
+    size_t need = room < size ? room + size : size;
+    sequence++;
+    if (head + need > limit && head + need > (limit = gate(need)))
+    {
+        // the subscribers see the gap in the sequences
+        header->dropped.fetch_add(1, std::memory_order_relaxed);
+        header->sequence.store(sequence, std::memory_order_relaxed);
+        return false;
+    }
+    if (room < size)
+    {
+        BusEventHeader *padding = reinterpret_cast<BusEventHeader *>(ring + offset);
+        padding->length = room - BUS_EVENT_ALIGN;
+        padding->type = BUS_PADDING;
+        padding->sequence = 0;
+        head += room;
+        offset = 0;
+    }
+    BusEventHeader *event = reinterpret_cast<BusEventHeader *>(ring + offset);
+    event->length = length;
+    event->type = type;
+    event->reserved = 0;
+    event->sequence = sequence;
+    memcpy(event + 1, data, length);
+    head += size;
+    header->sequence.store(sequence, std::memory_order_relaxed);
+    header->head.store(head, std::memory_order_release);
+    return true;
+}
+
+bool QQDommy::EventPublisher::publish(uint16_t type, const ByteBuffer &payload)
+{
+    return publish(type, payload.readPointer(), payload.readableBytes());
+}
+
+QQDommy::BusStats QQDommy::EventPublisher::getStats() const
+{
+    BusStats stats;
+    stats.dropped = header->dropped.load(std::memory_order_relaxed);
+    stats.published = sequence - stats.dropped;
+    stats.evictions = header->evictions.load(std::memory_order_relaxed);
+    for (BusSlot &slot : header->slots)
+    {
+        uint32_t state = stateOf(slot.owner.load(std::memory_order_acquire));
+        if (state == BUS_SLOT_FREE)
+            continue;
+        stats.subscribers++;
+        if (state == BUS_SLOT_ACTIVE || state == BUS_SLOT_READING)
+            stats.maxLag = std::max(stats.maxLag, head - slot.cursor.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+void QQDommy::EventPublisher::unlink(const std::string &name)
+{
+    shm_unlink(name.c_str());
+}
+
+QQDommy::EventSubscriber::EventSubscriber(const std::string &name)
+{
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0)
+        throw EventBusException("there is no bus " + name);
+    struct stat st;
+    BusLayout existing = {};
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < BUS_HEADER_SIZE ||
+        pread(fd, &existing, sizeof(existing), 0) != sizeof(existing) ||
+        existing.magic != BUS_MAGIC || existing.version != BUS_VERSION ||
+        (size_t)st.st_size != BUS_HEADER_SIZE + existing.capacity)
+    {
+        ::close(fd);
+        throw EventBusException(name + " is not an event bus");
+    }
+    capacity = existing.capacity;
+    mappedSize = st.st_size;
+    void *address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    // the mapping holds the memory, the descriptor is not needed any more
+    ::close(fd);
+    if (address == MAP_FAILED)
+        throw EventBusException("can't map " + name);
+    mapped = static_cast<uint8_t *>(address);
+    header = reinterpret_cast<BusHeader *>(mapped);
+    ring = mapped + BUS_HEADER_SIZE;
+
+    // a free slot, otherwise the slot of a subscriber that died without leaving it
+    pid = getpid();
+    for (int pass = 0; pass < 2 && slot == nullptr; pass++)
+    {
+        for (BusSlot &candidate : header->slots)
+        {
+            uint64_t owner = candidate.owner.load(std::memory_order_acquire);
+            if (pass == 0 ? stateOf(owner) != BUS_SLOT_FREE : !processGone(pidOf(owner)))
+                continue;
+            // the pid is part of the word, a slot reclaimed by another subscriber meanwhile fails the exchange
+            if (candidate.owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_CLAIMED, pid), std::memory_order_acq_rel))
+            {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+    if (slot == nullptr)
+    {
+        munmap(mapped, mappedSize);
+        throw EventBusException("all the slots of " + name + " are taken");
+    }
+    slot->lost.store(0, std::memory_order_relaxed);
+    attach();
+}
+
+QQDommy::EventSubscriber::~EventSubscriber()
+{
+    slot->owner.store(slotOwner(BUS_SLOT_FREE, 0), std::memory_order_release);
+    munmap(mapped, mappedSize);
+}
+
+void QQDommy::EventSubscriber::attach()
+{
+    // the publisher ignores the slot until it is active, it may write over any position read before
+    slot->cursor.store(header->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    slot->owner.store(slotOwner(BUS_SLOT_ACTIVE, pid), std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // a head read after the publisher can see the slot is safe to start from
+    cursor = header->head.load(std::memory_order_acquire);
+    slot->cursor.store(cursor, std::memory_order_release);
+}
+
+size_t QQDommy::EventSubscriber::poll(BusHandler &handler, size_t maxEvents)
+{
+    uint64_t owner = slotOwner(BUS_SLOT_ACTIVE, pid);
+    if (!slot->owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_READING, pid), std::memory_order_acq_rel))
+    {
+        if (owner != slotOwner(BUS_SLOT_EVICTED, pid))
+            throw EventBusException("the slot of the subscriber was taken over");
+        // the events skipped show up as a gap in the sequences
+        evicted++;
+        attach();
+        owner = slotOwner(BUS_SLOT_ACTIVE, pid);
+        if (!slot->owner.compare_exchange_strong(owner, slotOwner(BUS_SLOT_READING, pid), std::memory_order_acq_rel))
+            return 0;
+    }
+    uint64_t end = header->head.load(std::memory_order_acquire);
+    size_t handled = 0;
+    try
+    {
+        while (cursor < end && handled < maxEvents)
+        {
+            uint8_t *at = ring + (cursor & (capacity - 1));
+            const BusEventHeader *event = reinterpret_cast<const BusEventHeader *>(at);
+            if (event->type != BUS_PADDING)
+            {
+                if (expected != 0 && event->sequence > expected)
+                    lost += event->sequence - expected;
+                expected = event->sequence + 1;
+                ByteBuffer payload = ByteBuffer::wrap(at + BUS_EVENT_ALIGN, event->length);
+                handler.onEvent(BusEvent{event->type, event->sequence, payload});
+                handled++;
+            }
+            cursor += eventSize(event->length);
+            // released one by one, the publisher may write again behind the reader
+            slot->cursor.store(cursor, std::memory_order_release);
+        }
+    }
+    catch (...)
+    {
+        // the event that threw counts as read
+        cursor += eventSize(reinterpret_cast<const BusEventHeader *>(ring + (cursor & (capacity - 1)))->length);
+        slot->cursor.store(cursor, std::memory_order_release);
+        slot->owner.store(slotOwner(BUS_SLOT_ACTIVE, pid), std::memory_order_release);
+        throw;
+    }
+    slot->lost.store(lost, std::memory_order_relaxed);
+    slot->owner.store(slotOwner(BUS_SLOT_ACTIVE, pid), std::memory_order_release);
+    return handled;
+}
+
+uint64_t QQDommy::EventSubscriber::lag() const
+{
+    return header->head.load(std::memory_order_acquire) - cursor;
+}
+
+uint64_t QQDommy::EventSubscriber::getLost() const
+{
+    return lost;
+}
+
+uint64_t QQDommy::EventSubscriber::getEvictions() const
+{
+    return evicted;
+}
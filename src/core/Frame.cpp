@@ -0,0 +1,46 @@
+#include "core/Frame.h"
+#include "utils/Metrics.h"
+
+static const QQDommy::Histogram encodeTime("frame_encode_ns", "time to encode a frame", QQDommy::UNIT_TICKS);
+static const QQDommy::Histogram decodeTime("frame_decode_ns", "time to decode a complete frame", QQDommy::UNIT_TICKS);
+
+/// @brief read a big endian u32 without touching the read index
+static uint32_t peek_uint32Be(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void QQDommy::FrameCodec::encode(ByteBuffer &out, uint32_t sequence, uint32_t command, const uint8_t *payload, size_t length)
+{
+    if (length + FRAME_HEADER_SIZE > MAX_FRAME_LENGTH)
+        throw MalformedFrameException();
+    ScopedTimer timer(encodeTime);
+    out.write_uint32((uint32_t)(length + FRAME_HEADER_SIZE))
+        .write_uint32(sequence)
+        .write_uint32(command)
+        .writeBytes(payload, length);
+}
+
+bool QQDommy::FrameCodec::decode(ByteBuffer &in, Frame &frame)
+{
+    size_t available = in.readableBytes();
+    if (available < FRAME_HEADER_SIZE)
+        return false;
+    const uint8_t *head = in.readPointer();
+    uint32_t length = peek_uint32Be(head);
+    if (length < FRAME_HEADER_SIZE || length > MAX_FRAME_LENGTH)
+        throw MalformedFrameException();
+    if (available < length)
+        return false;
+    ScopedTimer timer(decodeTime);
+    frame.sequence = peek_uint32Be(head + 4);
+    frame.command = peek_uint32Be(head + 8);
+    frame.payload = ByteBuffer::wrap(head + FRAME_HEADER_SIZE, length - FRAME_HEADER_SIZE);
+    in.skip(length);
+    return true;
+}
+
+const char *QQDommy::MalformedFrameException::what() const noexcept
+{
+    return "the length of the frame is malformed";
+}
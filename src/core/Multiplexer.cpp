@@ -0,0 +1,194 @@
+#include "core/Multiplexer.h"
+#include <limits>
+
+/// @brief steady clock in nanoseconds, stored in the atomic deadline
+static int64_t to_nanos(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+QQDommy::RequestFailedException::RequestFailedException(REQUEST_STATUS status) : status(status)
+{
+}
+
+QQDommy::REQUEST_STATUS QQDommy::RequestFailedException::getStatus() const
+{
+    return status;
+}
+
+const char *QQDommy::RequestFailedException::what() const noexcept
+{
+    return status == TIMED_OUT ? "the request timed out" : "the request was cancelled";
+}
+
+QQDommy::SequenceMultiplexer::SequenceMultiplexer(size_t capacity)
+{
+    size_t size = MAX_PENDING_PROBE;
+    while (size < capacity)
+        size <<= 1;
+    slots.reset(new PendingSlot[size]);
+    mask = size - 1;
+}
+
+uint32_t QQDommy::SequenceMultiplexer::nextSequence()
+{
+    uint32_t seq = source->fetch_add(1, std::memory_order_relaxed) + 1;
+    // 0 is left for unsolicited frames
+    while (seq == 0)
+        seq = source->fetch_add(1, std::memory_order_relaxed) + 1;
+    return seq;
+}
+
+void QQDommy::SequenceMultiplexer::bindSequence(std::atomic<uint32_t> &counter)
+{
+    source = &counter;
+}
+
+bool QQDommy::SequenceMultiplexer::expect(uint32_t seq, const ResponseCallback &callback, int timeoutMs)
+{
+    int64_t deadline = timeoutMs > 0
+                           ? to_nanos(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs))
+                           : std::numeric_limits<int64_t>::max();
+    // a sequence still pending keeps its waiter, the response could only reach one of the two
+    // the responses, cancels and timeouts stay lock free, they only ever remove entries
+    std::lock_guard<std::mutex> lock(registering);
+    uint64_t key = (uint64_t)seq + KEY_OFFSET;
+    for (size_t i = 0; i < MAX_PENDING_PROBE; i++)
+    {
+        if (slots[(seq + i) & mask].key.load(std::memory_order_acquire) == key)
+            return false;
+    }
+    // sequences are allocated in order, so neighbours almost never collide
+    for (size_t i = 0; i < MAX_PENDING_PROBE; i++)
+    {
+        PendingSlot &slot = slots[(seq + i) & mask];
+        uint64_t expected = EMPTY_KEY;
+        if (slot.key.load(std::memory_order_relaxed) != EMPTY_KEY ||
+            !slot.key.compare_exchange_strong(expected, BUSY_KEY, std::memory_order_acquire))
+            continue;
+        slot.callback = callback;
+        slot.deadline.store(deadline, std::memory_order_relaxed);
+        pending.fetch_add(1, std::memory_order_relaxed);
+        // publish, the fields above become visible with the key
+        slot.key.store(key, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+std::future<QQDommy::ByteBuffer> QQDommy::SequenceMultiplexer::expect(uint32_t seq, int timeoutMs)
+{
+    auto promise = std::make_shared<std::promise<ByteBuffer>>();
+    std::future<ByteBuffer> result = promise->get_future();
+    bool registered = expect(
+        seq, [promise](REQUEST_STATUS status, Frame *frame)
+        {
+            if (status != RESPONDED)
+            {
+                promise->set_exception(std::make_exception_ptr(RequestFailedException(status)));
+                return;
+            }
+            // the payload lives in the receive buffer, the future needs its own copy
+            ByteBuffer copy(frame->payload.readableBytes());
+            copy.writeBytes(frame->payload.readPointer(), frame->payload.readableBytes());
+            promise->set_value(std::move(copy)); },
+        timeoutMs);
+    if (!registered)
+        promise->set_exception(std::make_exception_ptr(RequestFailedException(CANCELLED)));
+    return result;
+}
+
+QQDommy::SequenceMultiplexer::PendingSlot *QQDommy::SequenceMultiplexer::claim(uint32_t seq)
+{
+    uint64_t key = (uint64_t)seq + KEY_OFFSET;
+    for (size_t i = 0; i < MAX_PENDING_PROBE; i++)
+    {
+        PendingSlot &slot = slots[(seq + i) & mask];
+        uint64_t expected = key;
+        if (slot.key.load(std::memory_order_relaxed) == key &&
+            slot.key.compare_exchange_strong(expected, BUSY_KEY, std::memory_order_acquire))
+            return &slot;
+    }
+    return nullptr;
+}
+
+void QQDommy::SequenceMultiplexer::finish(PendingSlot *slot, REQUEST_STATUS status, Frame *frame)
+{
+    ResponseCallback callback = std::move(slot->callback);
+    slot->callback = nullptr;
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    slot->key.store(EMPTY_KEY, std::memory_order_release);
+    // the slot can be reused before the callback runs, the callback is a local copy
+    if (callback)
+        callback(status, frame);
+}
+
+bool QQDommy::SequenceMultiplexer::dispatch(Frame &frame)
+{
+    PendingSlot *slot = claim(frame.sequence);
+    if (slot == nullptr)
+        return false;
+    finish(slot, RESPONDED, &frame);
+    return true;
+}
+
+bool QQDommy::SequenceMultiplexer::cancel(uint32_t seq)
+{
+    PendingSlot *slot = claim(seq);
+    if (slot == nullptr)
+        return false;
+    finish(slot, CANCELLED, nullptr);
+    return true;
+}
+
+bool QQDommy::SequenceMultiplexer::timeout(uint32_t seq)
+{
+    PendingSlot *slot = claim(seq);
+    if (slot == nullptr)
+        return false;
+    finish(slot, TIMED_OUT, nullptr);
+    return true;
+}
+
+size_t QQDommy::SequenceMultiplexer::cancelAll()
+{
+    size_t cancelled = 0;
+    for (size_t i = 0; i <= mask; i++)
+    {
+        uint64_t key = slots[i].key.load(std::memory_order_acquire);
+        if (key < KEY_OFFSET || !slots[i].key.compare_exchange_strong(key, BUSY_KEY, std::memory_order_acquire))
+            continue;
+        finish(&slots[i], CANCELLED, nullptr);
+        cancelled++;
+    }
+    return cancelled;
+}
+
+size_t QQDommy::SequenceMultiplexer::expire(std::chrono::steady_clock::time_point now)
+{
+    int64_t current = to_nanos(now);
+    size_t expired = 0;
+    for (size_t i = 0; i <= mask; i++)
+    {
+        PendingSlot &slot = slots[i];
+        uint64_t key = slot.key.load(std::memory_order_acquire);
+        if (key < KEY_OFFSET || slot.deadline.load(std::memory_order_relaxed) > current)
+            continue;
+        // the response may win the race, then the request is not expired
+        if (!slot.key.compare_exchange_strong(key, BUSY_KEY, std::memory_order_acquire))
+            continue;
+        finish(&slot, TIMED_OUT, nullptr);
+        expired++;
+    }
+    return expired;
+}
+
+size_t QQDommy::SequenceMultiplexer::pendingCount() const
+{
+    return pending.load(std::memory_order_relaxed);
+}
+
+size_t QQDommy::SequenceMultiplexer::getCapacity() const
+{
+    return mask + 1;
+}
@@ -0,0 +1,207 @@
+#include "core/PacketTrace.h"
+#include "utils/Metrics.h"
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const QQDommy::Counter failedFlushes("trace_failed_flushes_total", "final trace flushes that failed, the tail of the trace is lost");
+
+static uint64_t peek_uint(const uint8_t *p, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static int64_t wall_nanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+QQDommy::TraceFileException::TraceFileException(const std::string &msg)
+{
+    this->msg = "trace error : " + msg;
+}
+
+const char *QQDommy::TraceFileException::what() const noexcept
+{
+    return msg.c_str();
+}
+
+QQDommy::TraceRecorder::TraceRecorder(const std::string &path, bool decrypted)
+    : startNs(wall_nanos()), output(TRACE_FLUSH_SIZE * 2)
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw TraceFileException("can't open " + path);
+    output.write_uint32(TRACE_MAGIC)
+        .write_uint16(TRACE_VERSION)
+        .write_uint16(decrypted ? TRACE_FLAG_DECRYPTED : 0)
+        .write_uint64(startNs);
+}
+
+QQDommy::TraceRecorder::~TraceRecorder()
+{
+    // a destructor can't throw, the tail of the trace is counted as lost instead
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+        failedFlushes.add();
+    }
+    ::close(fd);
+}
+
+void QQDommy::TraceRecorder::writeRecord(DIRECTION direction, TRACE_KIND kind, const uint8_t *data, size_t length)
+{
+    output.write_uint64(wall_nanos() - startNs)
+        .write_uint8(direction)
+        .write_uint8(kind)
+        .write_uint16(0)
+        .write_uint32((uint32_t)length)
+        .writeBytes(data, length);
+    if (output.readableBytes() >= TRACE_FLUSH_SIZE)
+        flush();
+}
+
+void QQDommy::TraceRecorder::tap(DIRECTION direction, const uint8_t *data, size_t length)
+{
+    ByteBuffer &pending = partial[direction];
+    pending.writeBytes(data, length);
+    while (pending.readableBytes() >= FRAME_HEADER_SIZE)
+    {
+        size_t frameLength = peek_uint(pending.readPointer(), 4);
+        // not a stream of frames, keep the chunk as it is rather than losing it
+        if (frameLength < FRAME_HEADER_SIZE || frameLength > MAX_FRAME_LENGTH)
+            frameLength = pending.readableBytes();
+        if (pending.readableBytes() < frameLength)
+            break;
+        writeRecord(direction, FRAME_RECORD, pending.readPointer(), frameLength);
+        pending.skip(frameLength);
+    }
+    pending.compact();
+}
+
+void QQDommy::TraceRecorder::recordPayload(DIRECTION direction, const uint8_t *data, size_t length)
+{
+    writeRecord(direction, PAYLOAD_RECORD, data, length);
+}
+
+void QQDommy::TraceRecorder::flush()
+{
+    while (output.readableBytes() > 0)
+    {
+        ssize_t n = ::write(fd, output.readPointer(), output.readableBytes());
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw TraceFileException("failed to write the trace");
+        output.skip(n);
+    }
+    output.clear();
+}
+
+QQDommy::TraceReplayer::TraceReplayer(const std::string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw TraceFileException("can't open " + path);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < TRACE_HEADER_SIZE)
+    {
+        ::close(fd);
+        throw TraceFileException(path + " is not a trace");
+    }
+    void *address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the fd is closed
+    ::close(fd);
+    if (address == MAP_FAILED)
+        throw TraceFileException("can't map " + path);
+    // the trace is read front to back
+    madvise(address, st.st_size, MADV_SEQUENTIAL);
+    mapped = static_cast<const uint8_t *>(address);
+    mappedSize = st.st_size;
+    if (peek_uint(mapped, 4) != TRACE_MAGIC || peek_uint(mapped + 4, 2) != TRACE_VERSION)
+    {
+        munmap(address, mappedSize);
+        throw TraceFileException(path + " is not a trace");
+    }
+    flags = (uint16_t)peek_uint(mapped + 6, 2);
+    startNs = peek_uint(mapped + 8, 8);
+}
+
+QQDommy::TraceReplayer::~TraceReplayer()
+{
+    munmap(const_cast<uint8_t *>(mapped), mappedSize);
+}
+
+bool QQDommy::TraceReplayer::next(TraceRecord &record)
+{
+    if (position + TRACE_RECORD_HEADER_SIZE > mappedSize)
+        return false;
+    const uint8_t *head = mapped + position;
+    size_t length = peek_uint(head + 12, 4);
+    // a trace cut off by a crash ends at the last complete record
+    if (position + TRACE_RECORD_HEADER_SIZE + length > mappedSize)
+        return false;
+    record.offsetNs = peek_uint(head, 8);
+    record.direction = head[8] == OUTBOUND ? OUTBOUND : INBOUND;
+    record.kind = head[9] == PAYLOAD_RECORD ? PAYLOAD_RECORD : FRAME_RECORD;
+    record.data = ByteBuffer::wrap(head + TRACE_RECORD_HEADER_SIZE, length);
+    position += TRACE_RECORD_HEADER_SIZE + length;
+    return true;
+}
+
+void QQDommy::TraceReplayer::rewind()
+{
+    position = TRACE_HEADER_SIZE;
+}
+
+QQDommy::ReplayStats QQDommy::TraceReplayer::replay(const ReplayCallback &callback, REPLAY_MODE mode)
+{
+    ReplayStats stats;
+    TraceRecord record;
+    Frame frame;
+    auto begin = std::chrono::steady_clock::now();
+    while (next(record))
+    {
+        if (record.kind != FRAME_RECORD)
+            continue;
+        if (mode == ORIGINAL_TIMING)
+            std::this_thread::sleep_until(begin + std::chrono::nanoseconds(record.offsetNs));
+        stats.bytes += record.data.readableBytes();
+        try
+        {
+            while (FrameCodec::decode(record.data, frame))
+            {
+                callback(record.direction, frame);
+                stats.frames++;
+            }
+        }
+        catch (const MalformedFrameException &e)
+        {
+            // a chunk that was not framed when recorded, nothing to decode
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return stats;
+}
+
+bool QQDommy::TraceReplayer::hasDecryptedPayloads() const
+{
+    return flags & TRACE_FLAG_DECRYPTED;
+}
+
+uint64_t QQDommy::TraceReplayer::getStartTime() const
+{
+    return startNs;
+}
@@ -0,0 +1,167 @@
+#include "core/Request.h"
+
+QQDommy::CancelToken::CancelToken() : state(std::make_shared<CancelState>())
+{
+}
+
+void QQDommy::CancelToken::cancel()
+{
+    if (state->cancelled)
+        return;
+    state->cancelled = true;
+    std::function<void()> callback = std::move(state->onCancel);
+    state->onCancel = nullptr;
+    if (callback)
+        callback();
+}
+
+bool QQDommy::CancelToken::isCancelled() const
+{
+    return state->cancelled;
+}
+
+void QQDommy::CancelToken::setCallback(const std::function<void()> &callback)
+{
+    state->onCancel = callback;
+}
+
+QQDommy::RequestAwaiter::RequestAwaiter(Connection &conn, SequenceMultiplexer &mux, uint32_t command,
+                                        const uint8_t *payload, size_t length, int timeoutMs, CancelToken *token)
+    : conn(conn), mux(mux), command(command), payload(payload), length(length), timeoutMs(timeoutMs), token(token),
+      flow(Tracer::flow())
+{
+}
+
+bool QQDommy::RequestAwaiter::await_ready() const noexcept
+{
+    return false;
+}
+
+void QQDommy::RequestAwaiter::complete(REQUEST_STATUS status, Frame *frame, std::coroutine_handle<> handle)
+{
+    if (timer != 0)
+        conn.getLoop().cancelTimer(timer);
+    if (token != nullptr)
+        token->setCallback(nullptr);
+    response.status = status;
+    if (flow != 0)
+        Tracer::record("request wait", sentAt, TscClock::now(), flow, SPAN_ASYNC);
+    if (frame != nullptr)
+    {
+        // the frame lives in the receive buffer, keep a copy for the coroutine
+        response.command = frame->command;
+        response.payload.clear();
+        response.payload.writeBytes(frame->payload.readPointer(), frame->payload.readableBytes());
+    }
+    // inside await_suspend the coroutine is not suspended yet, it goes on once that returns false
+    if (suspending)
+    {
+        completedInline = true;
+        return;
+    }
+    // resuming may finish the coroutine and free this awaiter, nothing can follow
+    handle.resume();
+}
+
+bool QQDommy::RequestAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    if ((token != nullptr && token->isCancelled()) || conn.getState() == CLOSED || conn.getState() == IDLE)
+        return false;
+    uint32_t seq = mux.nextSequence();
+    suspending = true;
+    if (!mux.expect(seq, [this, handle](REQUEST_STATUS status, Frame *frame)
+                    { complete(status, frame, handle); },
+                    0))
+    {
+        suspending = false;
+        return false;
+    }
+    SequenceMultiplexer *target = &mux;
+    if (timeoutMs > 0)
+        timer = conn.getLoop().runAfter(timeoutMs, [this, target, seq]()
+                                        {
+            timer = 0;
+            target->timeout(seq); });
+    if (token != nullptr)
+        token->setCallback([target, seq]()
+                           { target->cancel(seq); });
+    {
+        // encode straight into the send path, the response may only arrive on a later turn
+        TraceSpan span("request send");
+        ByteBuffer frame(FRAME_HEADER_SIZE + length);
+        FrameCodec::encode(frame, seq, command, payload, length);
+        // a send failing at once closes the connection, which cancels the request right here
+        conn.send(frame);
+    }
+    suspending = false;
+    if (completedInline)
+        return false;
+    // other flows run on this thread until the response
+    Tracer::suspend();
+    if (flow != 0)
+        sentAt = TscClock::now();
+    return true;
+}
+
+QQDommy::Response QQDommy::RequestAwaiter::await_resume()
+{
+    Tracer::resume(flow);
+    return std::move(response);
+}
+
+QQDommy::RequestAwaiter QQDommy::request(Connection &conn, SequenceMultiplexer &mux, uint32_t command, const ByteBuffer &payload,
+                                         int timeoutMs, CancelToken *token)
+{
+    return RequestAwaiter(conn, mux, command, payload.readPointer(), payload.readableBytes(), timeoutMs, token);
+}
+
+QQDommy::DelayAwaiter::DelayAwaiter(EventLoop &loop, int delayMs) : loop(loop), delayMs(delayMs), flow(Tracer::flow())
+{
+}
+
+bool QQDommy::DelayAwaiter::await_ready() const noexcept
+{
+    return delayMs <= 0;
+}
+
+void QQDommy::DelayAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    Tracer::suspend();
+    loop.runAfter(delayMs, [handle]()
+                  { handle.resume(); });
+}
+
+QQDommy::DelayAwaiter QQDommy::delay(EventLoop &loop, int delayMs)
+{
+    return DelayAwaiter(loop, delayMs);
+}
+
+QQDommy::FrameDispatcher::FrameDispatcher(SequenceMultiplexer &mux) : mux(mux)
+{
+}
+
+void QQDommy::FrameDispatcher::onMessage(Connection &conn, ByteBuffer &input)
+{
+    Frame frame;
+    try
+    {
+        while (FrameCodec::decode(input, frame))
+        {
+            if (!mux.dispatch(frame))
+                onPush(conn, frame);
+            // a resumed flow may have closed the connection
+            if (conn.getState() != CONNECTED)
+                return;
+        }
+    }
+    catch (const MalformedFrameException &e)
+    {
+        // the stream can not be resynchronized
+        conn.close();
+    }
+}
+
+void QQDommy::FrameDispatcher::onClosed(Connection & /*conn*/, int /*error*/)
+{
+    mux.cancelAll();
+}
@@ -0,0 +1,272 @@
+#include "core/SessionStore.h"
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <zlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+namespace QQDommy
+{
+
+    struct SessionFileHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        /// @brief 1 after the store was closed, 0 while it is open
+        uint16_t clean;
+        uint32_t recordSize;
+        uint32_t reserved;
+        uint64_t capacity;
+    };
+
+    struct SessionCopy
+    {
+        /// @brief 0 is never written
+        uint64_t generation;
+        /// @brief the crc32 of the generation and the state
+        uint32_t checksum;
+        uint32_t reserved;
+        SessionState state;
+    };
+
+    struct alignas(64) SessionRecord
+    {
+        /// @brief advanced on every request, apart from the copies which are rewritten on a login
+        std::atomic<uint32_t> sequence;
+        SessionCopy copies[2];
+    };
+
+    // the states are copied with memcpy and the records live in the mapping
+    static_assert(std::is_trivially_copyable_v<SessionState>);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+    static_assert(sizeof(SessionFileHeader) <= SESSION_HEADER_SIZE);
+
+};
+
+static uint32_t checksum(uint64_t generation, const QQDommy::SessionState &state)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef *)&generation, sizeof(generation));
+    return (uint32_t)crc32(crc, (const Bytef *)&state, sizeof(state));
+}
+
+/// @brief the valid copy of the highest generation, nullptr if none is
+static const QQDommy::SessionCopy *newest(const QQDommy::SessionRecord &record)
+{
+    const QQDommy::SessionCopy *best = nullptr;
+    for (const QQDommy::SessionCopy &copy : record.copies)
+    {
+        if (copy.generation == 0 || copy.checksum != checksum(copy.generation, copy.state))
+            continue;
+        if (best == nullptr || copy.generation > best->generation)
+            best = &copy;
+    }
+    return best;
+}
+
+QQDommy::SessionStoreException::SessionStoreException(const std::string &msg)
+{
+    this->msg = "session store error : " + msg;
+}
+
+const char *QQDommy::SessionStoreException::what() const noexcept
+{
+    return msg.c_str();
+}
+
+QQDommy::SessionStore::SessionStore(const std::string &path, size_t capacity, bool durable) : durable(durable)
+{
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        throw SessionStoreException("can't open " + path);
+    // two processes writing the same records would corrupt them
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0)
+    {
+        ::close(fd);
+        throw SessionStoreException(path + " is used by another process");
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        ::close(fd);
+        throw SessionStoreException("can't stat " + path);
+    }
+    SessionFileHeader existing = {};
+    bool created = st.st_size == 0;
+    if (!created)
+    {
+        if ((size_t)st.st_size < SESSION_HEADER_SIZE || pread(fd, &existing, sizeof(existing), 0) != sizeof(existing) ||
+            existing.magic != SESSION_MAGIC || existing.version != SESSION_VERSION ||
+            existing.recordSize != sizeof(SessionRecord) ||
+            (size_t)st.st_size < SESSION_HEADER_SIZE + existing.capacity * sizeof(SessionRecord))
+        {
+            ::close(fd);
+            throw SessionStoreException(path + " is not a session store");
+        }
+        capacity = std::max(capacity, (size_t)existing.capacity);
+    }
+    this->capacity = capacity;
+    mappedSize = SESSION_HEADER_SIZE + capacity * sizeof(SessionRecord);
+    // the new records are holes of zeros, which are free slots
+    if ((size_t)st.st_size < mappedSize && ftruncate(fd, mappedSize) < 0)
+    {
+        ::close(fd);
+        throw SessionStoreException("can't grow " + path);
+    }
+    void *address = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        ::close(fd);
+        throw SessionStoreException("can't map " + path);
+    }
+    // every record is read on open
+    madvise(address, mappedSize, MADV_WILLNEED);
+    mapped = static_cast<uint8_t *>(address);
+    header = reinterpret_cast<SessionFileHeader *>(mapped);
+    records = reinterpret_cast<SessionRecord *>(mapped + SESSION_HEADER_SIZE);
+    if (created)
+    {
+        header->magic = SESSION_MAGIC;
+        header->version = SESSION_VERSION;
+        header->recordSize = sizeof(SessionRecord);
+        header->clean = 1;
+    }
+    header->capacity = capacity;
+
+    for (size_t slot = capacity; slot-- > 0;)
+    {
+        const SessionCopy *copy = newest(records[slot]);
+        if (copy == nullptr || copy->state.uin == 0 || !index.emplace(copy->state.uin, slot).second)
+        {
+            freeSlots.push_back(slot);
+            continue;
+        }
+        // the sequences advanced before a crash of the host may be lost, the server must not see one twice
+        if (!header->clean)
+            records[slot].sequence.fetch_add(SEQUENCE_RESUME_GAP, std::memory_order_relaxed);
+    }
+    // the mark is on the disk before any record changes
+    header->clean = 0;
+    msync(mapped, SESSION_HEADER_SIZE, MS_SYNC);
+}
+
+QQDommy::SessionStore::~SessionStore()
+{
+    msync(mapped, mappedSize, MS_SYNC);
+    header->clean = 1;
+    msync(mapped, SESSION_HEADER_SIZE, MS_SYNC);
+    munmap(mapped, mappedSize);
+    // the lock goes with the fd
+    ::close(fd);
+}
+
+void QQDommy::SessionStore::write(size_t slot, const SessionState &state)
+{
+    SessionRecord &record = records[slot];
+    const SessionCopy *current = newest(record);
+    uint64_t generation = current != nullptr ? current->generation + 1 : 1;
+    SessionCopy &target = current == &record.copies[0] ? record.copies[1] : record.copies[0];
+    memcpy(&target.state, &state, sizeof(state));
+    // a copy cut by a crash fails its checksum and the former one is read
+    target.checksum = checksum(generation, state);
+    std::atomic_signal_fence(std::memory_order_release);
+    target.generation = generation;
+    if (durable)
+        syncSlot(slot);
+}
+
+void QQDommy::SessionStore::syncSlot(size_t slot)
+{
+    static const size_t page = sysconf(_SC_PAGESIZE);
+    size_t begin = SESSION_HEADER_SIZE + slot * sizeof(SessionRecord);
+    size_t aligned = begin & ~(page - 1);
+    msync(mapped + aligned, begin + sizeof(SessionRecord) - aligned, MS_SYNC);
+}
+
+bool QQDommy::SessionStore::load(uint64_t uin, SessionState &state) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(uin);
+    if (found == index.end())
+        return false;
+    const SessionCopy *copy = newest(records[found->second]);
+    if (copy == nullptr)
+        return false;
+    memcpy(&state, &copy->state, sizeof(state));
+    return true;
+}
+
+void QQDommy::SessionStore::save(const SessionState &state)
+{
+    if (state.uin == 0)
+        throw SessionStoreException("a session needs an uin");
+    if (state.tgtLength > SESSION_TOKEN_SIZE || state.d2Length > SESSION_TOKEN_SIZE)
+        throw SessionStoreException("the token of " + std::to_string(state.uin) + " is too long");
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(state.uin);
+    size_t slot;
+    if (found != index.end())
+        slot = found->second;
+    else
+    {
+        if (freeSlots.empty())
+            throw SessionStoreException("the store is full with " + std::to_string(capacity) + " sessions");
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        // the sequence goes on from the former account, a multiplexer may still be bound to it
+        index.emplace(state.uin, slot);
+    }
+    write(slot, state);
+}
+
+bool QQDommy::SessionStore::remove(uint64_t uin)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(uin);
+    if (found == index.end())
+        return false;
+    // an empty state is written like any other, so the removal is as safe as a save
+    write(found->second, SessionState());
+    freeSlots.push_back(found->second);
+    index.erase(found);
+    return true;
+}
+
+std::atomic<uint32_t> &QQDommy::SessionStore::sequence(uint64_t uin)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto found = index.find(uin);
+    if (found == index.end())
+        throw SessionStoreException(std::to_string(uin) + " has no session");
+    return records[found->second].sequence;
+}
+
+std::vector<uint64_t> QQDommy::SessionStore::accounts() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<uint64_t> result;
+    result.reserve(index.size());
+    for (auto &entry : index)
+        result.push_back(entry.first);
+    return result;
+}
+
+size_t QQDommy::SessionStore::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return index.size();
+}
+
+size_t QQDommy::SessionStore::getCapacity() const
+{
+    return capacity;
+}
+
+void QQDommy::SessionStore::sync()
+{
+    msync(mapped, mappedSize, MS_SYNC);
+}
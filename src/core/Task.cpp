@@ -0,0 +1,77 @@
+#include "core/Task.h"
+#include <new>
+
+/// @brief the size class of a frame, FRAME_SIZE_CLASSES if too large for the pool
+static size_t size_class(size_t size)
+{
+    return (size + QQDommy::FRAME_SIZE_CLASS - 1) / QQDommy::FRAME_SIZE_CLASS - 1;
+}
+
+QQDommy::FramePool &QQDommy::FramePool::local()
+{
+    static thread_local FramePool pool;
+    return pool;
+}
+
+QQDommy::FramePool::~FramePool()
+{
+    for (size_t i = 0; i < FRAME_SIZE_CLASSES; i++)
+    {
+        while (freeLists[i] != nullptr)
+        {
+            FreeFrame *frame = freeLists[i];
+            freeLists[i] = frame->next;
+            ::operator delete(frame);
+        }
+    }
+}
+
+void *QQDommy::FramePool::allocate(size_t size)
+{
+    size_t index = size_class(size);
+    if (index >= FRAME_SIZE_CLASSES)
+        return ::operator new(size);
+    FramePool &pool = local();
+    FreeFrame *frame = pool.freeLists[index];
+    if (frame == nullptr)
+        return ::operator new((index + 1) * FRAME_SIZE_CLASS);
+    pool.freeLists[index] = frame->next;
+    pool.freeCounts[index]--;
+    return frame;
+}
+
+void QQDommy::FramePool::release(void *frame, size_t size)
+{
+    size_t index = size_class(size);
+    FramePool &pool = local();
+    // frames freed on another thread simply join that thread's pool
+    if (index >= FRAME_SIZE_CLASSES || pool.freeCounts[index] >= FRAME_POOL_LIMIT)
+    {
+        ::operator delete(frame);
+        return;
+    }
+    FreeFrame *node = static_cast<FreeFrame *>(frame);
+    node->next = pool.freeLists[index];
+    pool.freeLists[index] = node;
+    pool.freeCounts[index]++;
+}
+
+void *QQDommy::TaskPromiseBase::operator new(size_t size)
+{
+    return FramePool::allocate(size);
+}
+
+void QQDommy::TaskPromiseBase::operator delete(void *frame, size_t size)
+{
+    FramePool::release(frame, size);
+}
+
+bool QQDommy::spawn(EventLoop &loop, Task<void> task)
+{
+    std::coroutine_handle<> handle = task.detach();
+    if (loop.post([handle]()
+                  { handle.resume(); }))
+        return true;
+    handle.destroy();
+    return false;
+}
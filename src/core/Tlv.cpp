@@ -1,6 +1,57 @@
 #include "core/Tlv.h"
+#include "utils/Metrics.h"
+
+static const QQDommy::Counter tlvEncoded("tlv_encoded_total", "tlv records encoded");
+static const QQDommy::Counter tlvEncodedBytes("tlv_encoded_bytes_total", "bytes of the tlv records encoded, headers included");
+static const QQDommy::Counter tlvDecoded("tlv_decoded_total", "tlv records decoded");
 
 void QQDommy::TestTlvPack::visit(ByteBuffer &ref) const
 {
     ref.writeByteVector({0xab,0xcd});
-}
\ No newline at end of file
+}
+
+QQDommy::BytesTlvPack::BytesTlvPack(uint16_t tag, const uint8_t *value, size_t length)
+    : tag(tag), value(value), length(length)
+{
+    // a longer value would overrun its u16 length into the records behind it
+    if (length > UINT16_MAX)
+        throw BufferOutOfBoundException();
+}
+
+QQDommy::BytesTlvPack::BytesTlvPack(uint16_t tag, const ByteBuffer &value)
+    : BytesTlvPack(tag, value.readPointer(), value.readableBytes())
+{
+}
+
+void QQDommy::BytesTlvPack::visit(ByteBuffer &ref) const
+{
+    ref.write_uint16(tag).write_uint16((uint16_t)length).writeBytes(value, length);
+    tlvEncoded.add();
+    tlvEncodedBytes.add(TLV_HEADER_SIZE + length);
+}
+
+QQDommy::Uint64TlvPack::Uint64TlvPack(uint16_t tag, uint64_t value) : tag(tag), value(value)
+{
+}
+
+void QQDommy::Uint64TlvPack::visit(ByteBuffer &ref) const
+{
+    ref.write_uint16(tag).write_uint16(sizeof(value)).write_uint64(value);
+    tlvEncoded.add();
+    tlvEncodedBytes.add(TLV_HEADER_SIZE + sizeof(value));
+}
+
+bool QQDommy::TlvReader::next(ByteBuffer &in, uint16_t &tag, ByteBuffer &value)
+{
+    if (in.readableBytes() < TLV_HEADER_SIZE)
+        return false;
+    const uint8_t *head = in.readPointer();
+    size_t length = ((size_t)head[2] << 8) | head[3];
+    if (in.readableBytes() < TLV_HEADER_SIZE + length)
+        return false;
+    tag = (uint16_t)((head[0] << 8) | head[1]);
+    value = ByteBuffer::wrap(head + TLV_HEADER_SIZE, length);
+    in.skip(TLV_HEADER_SIZE + length);
+    tlvDecoded.add();
+    return true;
+}
@@ -1,4 +1,9 @@
 #include "encrypt/Md5.h"
+#include "utils/Metrics.h"
+#include "utils/Tracing.h"
+
+static const QQDommy::Counter blocksHashed("md5_blocks_total", "64 byte blocks hashed");
+static const QQDommy::Histogram digestTime("md5_digest_ns", "time to hash the blocks of a digest", QQDommy::UNIT_TICKS);
 
 void QQDommy::Md5Processor::transform(size_t startIndex)
 {
@@ -143,6 +148,9 @@ QQDommy::ByteBuffer QQDommy::Md5Processor::digest32()
     size_t block = 0;
     size_t all = (raw.size() * 8) / 512;
     ByteBuffer output;
+    ScopedTimer timer(digestTime);
+    TraceSpan span("md5 digest");
+    blocksHashed.add(all);
     while (block < all)
     {
         transform(block * 64);
@@ -0,0 +1,126 @@
+#include "encrypt/Tea.h"
+#include "utils/Tracing.h"
+#include <chrono>
+
+static uint64_t load_uint64Be(const uint8_t *p)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static void store_uint64Be(uint8_t *p, uint64_t value)
+{
+    for (size_t i = 8; i > 0; i--)
+    {
+        p[i - 1] = value & 0xff;
+        value >>= 8;
+    }
+}
+
+QQDommy::TeaCipher::TeaCipher(const uint8_t *key)
+{
+    for (size_t i = 0; i < 4; i++)
+        this->key[i] = ((uint32_t)key[i * 4] << 24) | ((uint32_t)key[i * 4 + 1] << 16) |
+                       ((uint32_t)key[i * 4 + 2] << 8) | (uint32_t)key[i * 4 + 3];
+    seed = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() | 1;
+}
+
+uint32_t QQDommy::TeaCipher::nextRandom()
+{
+    // xorshift64
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (uint32_t)(seed >> 32);
+}
+
+uint64_t QQDommy::TeaCipher::encodeBlock(uint64_t block) const
+{
+    uint32_t v0 = block >> 32, v1 = (uint32_t)block, sum = 0;
+    for (size_t i = 0; i < 16; i++)
+    {
+        sum += TEA_DELTA;
+        v0 += ((v1 << 4) + key[0]) ^ (v1 + sum) ^ ((v1 >> 5) + key[1]);
+        v1 += ((v0 << 4) + key[2]) ^ (v0 + sum) ^ ((v0 >> 5) + key[3]);
+    }
+    return ((uint64_t)v0 << 32) | v1;
+}
+
+uint64_t QQDommy::TeaCipher::decodeBlock(uint64_t block) const
+{
+    uint32_t v0 = block >> 32, v1 = (uint32_t)block, sum = TEA_DELTA * 16;
+    for (size_t i = 0; i < 16; i++)
+    {
+        v1 -= ((v0 << 4) + key[2]) ^ (v0 + sum) ^ ((v0 >> 5) + key[3]);
+        v0 -= ((v1 << 4) + key[0]) ^ (v1 + sum) ^ ((v1 >> 5) + key[1]);
+        sum -= TEA_DELTA;
+    }
+    return ((uint64_t)v0 << 32) | v1;
+}
+
+size_t QQDommy::TeaCipher::encryptedLength(size_t length)
+{
+    // 1 byte header, 2 to 9 bytes of random fill, the data, 7 zero bytes
+    size_t fill = 10 - (length + 1) % 8;
+    return fill + length + 7;
+}
+
+void QQDommy::TeaCipher::encrypt(ByteBuffer &out, const uint8_t *data, size_t length)
+{
+    TraceSpan span("tea encrypt");
+    size_t fill = 10 - (length + 1) % 8;
+    size_t total = fill + length + 7;
+    out.ensureWritable(total);
+    uint8_t *dst = out.writePointer();
+    for (size_t i = 0; i < fill; i++)
+        dst[i] = (uint8_t)nextRandom();
+    // the low 3 bits of the first byte tell the length of the fill
+    dst[0] = (uint8_t)((fill - 3) | 0xF8);
+    memcpy(dst + fill, data, length);
+    memset(dst + fill + length, 0, 7);
+
+    uint64_t iv1 = 0, iv2 = 0;
+    for (size_t i = 0; i < total; i += 8)
+    {
+        uint64_t holder = load_uint64Be(dst + i) ^ iv1;
+        iv1 = encodeBlock(holder) ^ iv2;
+        iv2 = holder;
+        store_uint64Be(dst + i, iv1);
+    }
+    out.commitWrite(total);
+}
+
+void QQDommy::TeaCipher::decrypt(ByteBuffer &out, const uint8_t *data, size_t length) const
+{
+    TraceSpan span("tea decrypt");
+    if (length < 16 || length % 8 != 0)
+        throw TeaDecryptException();
+    // decrypt in place in the free part of the output, then drop the padding
+    out.ensureWritable(length);
+    uint8_t *dst = out.writePointer();
+    uint64_t iv1, iv2 = 0, holder = 0;
+    for (size_t i = 0; i < length; i += 8)
+    {
+        iv1 = load_uint64Be(data + i);
+        iv2 = decodeBlock(iv2 ^ iv1);
+        store_uint64Be(dst + i, iv2 ^ holder);
+        holder = iv1;
+    }
+    size_t fill = (dst[0] & 7) + 3;
+    for (size_t i = length - 7; i < length; i++)
+    {
+        if (dst[i] != 0)
+            throw TeaDecryptException();
+    }
+    if (fill + 7 > length)
+        throw TeaDecryptException();
+    memmove(dst, dst + fill, length - fill - 7);
+    out.commitWrite(length - fill - 7);
+}
+
+const char *QQDommy::TeaDecryptException::what() const noexcept
+{
+    return "failed to decrypt with the tea key";
+}
@@ -0,0 +1,178 @@
+#include "encrypt/Zlib.h"
+#include <algorithm>
+#include <climits>
+
+/// @brief the smallest free space handed to zlib, the buffer grows below it
+const static size_t ZLIB_MIN_ROOM = QQDommy::ZLIB_CHUNK / 16;
+
+static int windowBits(QQDommy::ZLIB_FORMAT format)
+{
+    switch (format)
+    {
+    case QQDommy::ZLIB_FORMAT_GZIP:
+        return MAX_WBITS + 16;
+    case QQDommy::ZLIB_FORMAT_RAW:
+        return -MAX_WBITS;
+    default:
+        return MAX_WBITS;
+    }
+}
+
+/// @brief the free space of the buffer, grown when it is too small to be worth a call
+static size_t room(QQDommy::ByteBuffer &out)
+{
+    if (out.writableBytes() < ZLIB_MIN_ROOM)
+        out.ensureWritable(QQDommy::ZLIB_CHUNK);
+    return std::min(out.writableBytes(), (size_t)UINT_MAX);
+}
+
+QQDommy::ZlibException::ZlibException(const std::string &msg)
+{
+    this->msg = "zlib error : " + msg;
+}
+
+const char *QQDommy::ZlibException::what() const noexcept
+{
+    return msg.c_str();
+}
+
+QQDommy::Inflater::Inflater(size_t limit, ZLIB_FORMAT format) : limit(limit)
+{
+    if (inflateInit2(&stream, windowBits(format)) != Z_OK)
+        throw ZlibException("can't initialize the inflater");
+}
+
+QQDommy::Inflater::~Inflater()
+{
+    inflateEnd(&stream);
+}
+
+size_t QQDommy::Inflater::inflate(const uint8_t *data, size_t length, ByteBuffer &out, size_t sizeHint)
+{
+    if (finished)
+        reset();
+    if (sizeHint > 0)
+        out.ensureWritable(std::min(sizeHint, limit - stream.total_out));
+    stream.next_in = const_cast<Bytef *>(data);
+    size_t fed = std::min(length, (size_t)UINT_MAX);
+    stream.avail_in = (uInt)fed;
+    while (true)
+    {
+        // one byte over the limit is allowed, producing it means the limit is exceeded
+        size_t given = std::min(room(out), limit - stream.total_out + 1);
+        stream.next_out = out.writePointer();
+        stream.avail_out = (uInt)given;
+        int result = ::inflate(&stream, Z_NO_FLUSH);
+        if (stream.total_out > limit)
+        {
+            reset();
+            throw ZlibException("inflated beyond the limit of " + std::to_string(limit) + " bytes");
+        }
+        out.commitWrite(given - stream.avail_out);
+        if (result == Z_STREAM_END)
+        {
+            finished = true;
+            break;
+        }
+        // no progress is possible without more input
+        if (result == Z_BUF_ERROR)
+            break;
+        if (result != Z_OK)
+        {
+            std::string reason = stream.msg != nullptr ? stream.msg : "corrupt data";
+            reset();
+            throw ZlibException(reason);
+        }
+        // zlib had room left, all the input it could take is consumed
+        if (stream.avail_out != 0)
+            break;
+    }
+    return fed - stream.avail_in;
+}
+
+bool QQDommy::Inflater::inflate(ByteBuffer &in, ByteBuffer &out, size_t sizeHint)
+{
+    in.skip(inflate(in.readPointer(), in.readableBytes(), out, sizeHint));
+    return finished;
+}
+
+bool QQDommy::Inflater::done() const
+{
+    return finished;
+}
+
+void QQDommy::Inflater::reset()
+{
+    inflateReset(&stream);
+    finished = false;
+}
+
+size_t QQDommy::Inflater::totalOut() const
+{
+    return stream.total_out;
+}
+
+QQDommy::Deflater::Deflater(int level, ZLIB_FORMAT format)
+{
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits(format), 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw ZlibException("can't initialize the deflater");
+}
+
+QQDommy::Deflater::~Deflater()
+{
+    deflateEnd(&stream);
+}
+
+void QQDommy::Deflater::run(const uint8_t *data, size_t length, ByteBuffer &out, int flush)
+{
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = (uInt)length;
+    do
+    {
+        size_t given = room(out);
+        stream.next_out = out.writePointer();
+        stream.avail_out = (uInt)given;
+        if (::deflate(&stream, flush) == Z_STREAM_ERROR)
+            throw ZlibException("the deflater is in a bad state");
+        out.commitWrite(given - stream.avail_out);
+        // a full output means zlib may have more to write
+    } while (stream.avail_out == 0);
+}
+
+void QQDommy::Deflater::deflate(const uint8_t *data, size_t length, ByteBuffer &out)
+{
+    // avail_in is 32 bits
+    while (length > UINT_MAX)
+    {
+        run(data, UINT_MAX, out, Z_NO_FLUSH);
+        data += UINT_MAX;
+        length -= UINT_MAX;
+    }
+    run(data, length, out, Z_NO_FLUSH);
+}
+
+void QQDommy::Deflater::deflate(ByteBuffer &in, ByteBuffer &out)
+{
+    size_t length = in.readableBytes();
+    deflate(in.readPointer(), length, out);
+    in.skip(length);
+}
+
+void QQDommy::Deflater::finish(ByteBuffer &out)
+{
+    run(nullptr, 0, out, Z_FINISH);
+    reset();
+}
+
+void QQDommy::Deflater::compress(const uint8_t *data, size_t length, ByteBuffer &out)
+{
+    // the bound of the whole output is reserved, the payload is compressed in one call
+    out.ensureWritable(deflateBound(&stream, length));
+    deflate(data, length, out);
+    finish(out);
+}
+
+void QQDommy::Deflater::reset()
+{
+    deflateReset(&stream);
+}
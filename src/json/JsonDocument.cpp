@@ -0,0 +1,381 @@
+#include "json/JsonDocument.h"
+#include "json/JsonText.h"
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+static const QQDommy::JsonValue INVALID_VALUE;
+
+QQDommy::JsonParseException::JsonParseException(const std::string &reason, size_t offset)
+    : msg("json " + reason + " at " + std::to_string(offset))
+{
+}
+
+const char *QQDommy::JsonParseException::what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT
+{
+    return msg.c_str();
+}
+
+/// @brief the order of the index, most keys differ in length and are told apart without reading them
+static bool keyBefore(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+        return a.size() < b.size();
+    return memcmp(a.data(), b.data(), a.size()) < 0;
+}
+
+size_t QQDommy::JsonValue::size() const
+{
+    return type == JSON_ARRAY || type == JSON_OBJECT ? length : 0;
+}
+
+const QQDommy::JsonValue *QQDommy::JsonValue::find(std::string_view key) const
+{
+    if (type != JSON_OBJECT)
+        return nullptr;
+    if (length < JSON_INDEX_MEMBERS)
+    {
+        for (uint32_t i = 0; i < length; i++)
+            if (members[i].key == key)
+                return &members[i].value;
+        return nullptr;
+    }
+    // the index follows the members, sorted by key and then by position
+    const uint32_t *index = (const uint32_t *)(members + length);
+    const uint32_t *found = std::lower_bound(index, index + length, key, [this](uint32_t at, std::string_view key)
+                                             { return keyBefore(members[at].key, key); });
+    if (found == index + length || members[*found].key != key)
+        return nullptr;
+    return &members[*found].value;
+}
+
+const QQDommy::JsonValue &QQDommy::JsonValue::operator[](std::string_view key) const
+{
+    const JsonValue *value = find(key);
+    return value == nullptr ? INVALID_VALUE : *value;
+}
+
+const QQDommy::JsonValue &QQDommy::JsonValue::operator[](size_t index) const
+{
+    if (type != JSON_ARRAY || index >= length)
+        return INVALID_VALUE;
+    return values[index];
+}
+
+std::string_view QQDommy::JsonValue::asString(std::string_view fallback) const
+{
+    return type == JSON_STRING ? std::string_view(text, length) : fallback;
+}
+
+int64_t QQDommy::JsonValue::asInteger(int64_t fallback) const
+{
+    if (type == JSON_INTEGER)
+        return integer;
+    if (type != JSON_FLOAT)
+        return fallback;
+    // the cast of a float out of range is undefined
+    if (number >= 9223372036854775807.0)
+        return INT64_MAX;
+    if (number <= -9223372036854775808.0)
+        return INT64_MIN;
+    return (int64_t)number;
+}
+
+double QQDommy::JsonValue::asFloat(double fallback) const
+{
+    if (type == JSON_FLOAT)
+        return number;
+    if (type == JSON_INTEGER)
+        return (double)integer;
+    return fallback;
+}
+
+bool QQDommy::JsonValue::asBoolean(bool fallback) const
+{
+    return type == JSON_BOOLEAN ? boolean : fallback;
+}
+
+const QQDommy::JsonValue *QQDommy::JsonValue::begin() const
+{
+    return type == JSON_ARRAY ? values : nullptr;
+}
+
+const QQDommy::JsonValue *QQDommy::JsonValue::end() const
+{
+    return type == JSON_ARRAY ? values + length : nullptr;
+}
+
+const QQDommy::JsonMember *QQDommy::JsonValue::memberBegin() const
+{
+    return type == JSON_OBJECT ? members : nullptr;
+}
+
+const QQDommy::JsonMember *QQDommy::JsonValue::memberEnd() const
+{
+    return type == JSON_OBJECT ? members + length : nullptr;
+}
+
+QQDommy::JsonDocument::JsonDocument(size_t blockSize) : arena(blockSize)
+{
+}
+
+void QQDommy::JsonDocument::fail(const char *reason) const
+{
+    throw JsonParseException(reason, cursor - begin);
+}
+
+void QQDommy::JsonDocument::skipSpace()
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t'))
+        cursor++;
+}
+
+void QQDommy::JsonDocument::expectWord(const char *word, size_t length)
+{
+    if ((size_t)(end - cursor) < length || memcmp(cursor, word, length) != 0)
+        fail("unexpected character");
+    cursor += length;
+}
+
+void QQDommy::JsonDocument::parseValue(JsonValue &value, size_t depth)
+{
+    skipSpace();
+    if (cursor >= end)
+        fail("unexpected end");
+    switch (*cursor)
+    {
+    case '{':
+        parseObject(value, depth + 1);
+        return;
+    case '[':
+        parseArray(value, depth + 1);
+        return;
+    case '"':
+    {
+        cursor++;
+        std::string_view text = parseString();
+        value.type = JSON_STRING;
+        value.text = text.data();
+        value.length = (uint32_t)text.size();
+        return;
+    }
+    case 't':
+        expectWord("true", 4);
+        value.type = JSON_BOOLEAN;
+        value.boolean = true;
+        return;
+    case 'f':
+        expectWord("false", 5);
+        value.type = JSON_BOOLEAN;
+        value.boolean = false;
+        return;
+    case 'n':
+        expectWord("null", 4);
+        value.type = JSON_NULL;
+        return;
+    default:
+        parseNumber(value);
+    }
+}
+
+void QQDommy::JsonDocument::parseArray(JsonValue &value, size_t depth)
+{
+    if (depth > JSON_MAX_DEPTH)
+        fail("nested too deep");
+    cursor++;
+    // the values of the nested containers are pushed and popped above this mark
+    size_t mark = valueStack.size();
+    skipSpace();
+    if (cursor < end && *cursor == ']')
+        cursor++;
+    else
+        while (true)
+        {
+            JsonValue element;
+            parseValue(element, depth);
+            valueStack.push_back(element);
+            skipSpace();
+            if (cursor >= end)
+                fail("unexpected end");
+            if (*cursor == ']')
+            {
+                cursor++;
+                break;
+            }
+            if (*cursor != ',')
+                fail("expected , or ]");
+            cursor++;
+        }
+    size_t count = valueStack.size() - mark;
+    JsonValue *values = arena.allocateArray<JsonValue>(count);
+    if (count > 0)
+        memcpy((void *)values, &valueStack[mark], sizeof(JsonValue) * count);
+    valueStack.resize(mark);
+    value.type = JSON_ARRAY;
+    value.length = (uint32_t)count;
+    value.values = values;
+}
+
+void QQDommy::JsonDocument::parseObject(JsonValue &value, size_t depth)
+{
+    if (depth > JSON_MAX_DEPTH)
+        fail("nested too deep");
+    cursor++;
+    size_t mark = memberStack.size();
+    skipSpace();
+    if (cursor < end && *cursor == '}')
+        cursor++;
+    else
+        while (true)
+        {
+            JsonMember member;
+            skipSpace();
+            if (cursor >= end || *cursor != '"')
+                fail("expected a key");
+            cursor++;
+            member.key = parseString();
+            skipSpace();
+            if (cursor >= end || *cursor != ':')
+                fail("expected :");
+            cursor++;
+            parseValue(member.value, depth);
+            memberStack.push_back(member);
+            skipSpace();
+            if (cursor >= end)
+                fail("unexpected end");
+            if (*cursor == '}')
+            {
+                cursor++;
+                break;
+            }
+            if (*cursor != ',')
+                fail("expected , or }");
+            cursor++;
+        }
+    size_t count = memberStack.size() - mark;
+    size_t indexed = count >= JSON_INDEX_MEMBERS ? count : 0;
+    // the index is allocated with the members, it is found right after them
+    JsonMember *members = (JsonMember *)arena.allocate(sizeof(JsonMember) * count + sizeof(uint32_t) * indexed, alignof(JsonMember));
+    if (count > 0)
+        memcpy((void *)members, &memberStack[mark], sizeof(JsonMember) * count);
+    memberStack.resize(mark);
+    if (indexed > 0)
+    {
+        uint32_t *index = (uint32_t *)(members + count);
+        for (uint32_t i = 0; i < count; i++)
+            index[i] = i;
+        std::sort(index, index + count, [members](uint32_t a, uint32_t b)
+                  { return keyBefore(members[a].key, members[b].key) || (members[a].key == members[b].key && a < b); });
+    }
+    value.type = JSON_OBJECT;
+    value.length = (uint32_t)count;
+    value.members = members;
+}
+
+std::string_view QQDommy::JsonDocument::parseString()
+{
+    char *start = cursor;
+    const char *scan = cursor;
+    bool escaped = false;
+    const char *close = JsonText::scanString(scan, end, escaped);
+    if (close == nullptr)
+    {
+        cursor = end;
+        fail("unterminated string");
+    }
+    cursor = (char *)close;
+    if (*close != '"')
+        fail("control character in string");
+    size_t length = close - start;
+    // most strings have no escape and stay where they are
+    if (escaped)
+    {
+        const char *reason, *failedAt;
+        char *decoded = JsonText::unescape(start, close, start, reason, failedAt);
+        if (decoded == nullptr)
+        {
+            cursor = (char *)failedAt;
+            fail(reason);
+        }
+        length = decoded - start;
+    }
+    cursor++;
+    return std::string_view(start, length);
+}
+
+void QQDommy::JsonDocument::parseNumber(JsonValue &value)
+{
+    const char *stop = JsonText::scanNumber(cursor, end);
+    bool integral;
+    const char *reason = JsonText::parseNumber(cursor, stop, integral, value.integer, value.number);
+    if (reason != nullptr)
+        fail(reason);
+    value.type = integral ? JSON_INTEGER : JSON_FLOAT;
+    cursor = (char *)stop;
+}
+
+const QQDommy::JsonValue &QQDommy::JsonDocument::parseText(char *text, size_t length)
+{
+    begin = cursor = text;
+    end = text + length;
+    try
+    {
+        parseValue(rootValue, 0);
+        skipSpace();
+        if (cursor != end)
+            fail("trailing characters");
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+    return rootValue;
+}
+
+const QQDommy::JsonValue &QQDommy::JsonDocument::parseInSitu(char *text, size_t length)
+{
+    clear();
+    return parseText(text, length);
+}
+
+const QQDommy::JsonValue &QQDommy::JsonDocument::parse(std::string_view text)
+{
+    clear();
+    char *copy = arena.allocateArray<char>(text.size());
+    memcpy(copy, text.data(), text.size());
+    return parseText(copy, text.size());
+}
+
+bool QQDommy::JsonDocument::parseFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    clear();
+    size_t size = (size_t)file.tellg();
+    char *text = arena.allocateArray<char>(size);
+    file.seekg(0);
+    if (!file.read(text, size))
+        return false;
+    parseText(text, size);
+    return true;
+}
+
+const QQDommy::JsonValue &QQDommy::JsonDocument::root() const
+{
+    return rootValue;
+}
+
+void QQDommy::JsonDocument::clear()
+{
+    arena.reset();
+    rootValue = JsonValue();
+    valueStack.clear();
+    memberStack.clear();
+}
+
+size_t QQDommy::JsonDocument::getArenaUsed() const
+{
+    return arena.getUsed();
+}
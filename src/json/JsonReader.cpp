@@ -0,0 +1,298 @@
+#include "json/JsonReader.h"
+#include "json/JsonText.h"
+#include <cstring>
+
+QQDommy::JsonReader::JsonReader(size_t maxToken) : maxToken(maxToken)
+{
+}
+
+void QQDommy::JsonReader::feed(const char *data, size_t length)
+{
+    // only the tail of a token spanning the chunks is moved
+    if (pos > 0)
+    {
+        pending.erase(0, pos);
+        consumed += pos;
+        pos = 0;
+    }
+    pending.append(data, length);
+}
+
+void QQDommy::JsonReader::feed(ByteBuffer &chunk)
+{
+    size_t length = chunk.readableBytes();
+    feed((const char *)chunk.readPointer(), length);
+    chunk.skip(length);
+}
+
+void QQDommy::JsonReader::finish()
+{
+    finished = true;
+}
+
+void QQDommy::JsonReader::fail(const char *reason) const
+{
+    throw JsonParseException(reason, consumed + pos);
+}
+
+void QQDommy::JsonReader::skipSpace()
+{
+    while (pos < pending.size() && (pending[pos] == ' ' || pending[pos] == '\n' || pending[pos] == '\r' || pending[pos] == '\t'))
+        pos++;
+}
+
+void QQDommy::JsonReader::valueDone()
+{
+    expect = containers.empty() ? EXPECT_NOTHING : EXPECT_COMMA_OR_END;
+}
+
+QQDommy::JSON_EVENT QQDommy::JsonReader::close(char kind)
+{
+    if (containers.back() != (kind == '}' ? '{' : '['))
+        fail("mismatched bracket");
+    containers.pop_back();
+    pos++;
+    valueDone();
+    return kind == '}' ? JSON_EVENT_OBJECT_END : JSON_EVENT_ARRAY_END;
+}
+
+bool QQDommy::JsonReader::readString()
+{
+    const char *data = pending.data();
+    const char *begin = data + pos + 1;
+    const char *end = data + pending.size();
+    // a long string is not scanned again from its start for every chunk
+    const char *scan = begin + stringScanned;
+    const char *close = JsonText::scanString(scan, end, stringEscaped);
+    if (close == nullptr)
+    {
+        stringScanned = scan - begin;
+        if (finished)
+            fail("unterminated string");
+        if (stringScanned > maxToken)
+            fail("token too long");
+        return false;
+    }
+    if (*close != '"')
+    {
+        pos = close - data;
+        fail("control character in string");
+    }
+    if (stringEscaped)
+    {
+        const char *reason, *failedAt;
+        decoded.resize(close - begin);
+        char *out = JsonText::unescape(begin, close, decoded.data(), reason, failedAt);
+        if (out == nullptr)
+        {
+            pos = failedAt - data;
+            fail(reason);
+        }
+        decoded.resize(out - decoded.data());
+        token = decoded;
+    }
+    else
+        token = std::string_view(begin, close - begin);
+    pos = close - data + 1;
+    stringScanned = 0;
+    stringEscaped = false;
+    return true;
+}
+
+bool QQDommy::JsonReader::readNumber(JSON_EVENT &event)
+{
+    const char *begin = pending.data() + pos;
+    const char *end = pending.data() + pending.size();
+    const char *stop = JsonText::scanNumber(begin, end);
+    // the number may go on in the next chunk
+    if (stop == end && !finished)
+    {
+        if ((size_t)(stop - begin) > maxToken)
+            fail("token too long");
+        return false;
+    }
+    bool integral;
+    const char *reason = JsonText::parseNumber(begin, stop, integral, integerValue, floatValue);
+    if (reason != nullptr)
+        fail(reason);
+    token = std::string_view(begin, stop - begin);
+    event = integral ? JSON_EVENT_INTEGER : JSON_EVENT_FLOAT;
+    pos = stop - pending.data();
+    return true;
+}
+
+bool QQDommy::JsonReader::readWord(const char *word, size_t length)
+{
+    size_t available = pending.size() - pos;
+    if (memcmp(pending.data() + pos, word, available < length ? available : length) != 0)
+        fail("unexpected character");
+    if (available < length)
+    {
+        if (finished)
+            fail("unexpected end");
+        return false;
+    }
+    token = std::string_view(pending.data() + pos, length);
+    pos += length;
+    return true;
+}
+
+QQDommy::JSON_EVENT QQDommy::JsonReader::step()
+{
+    while (true)
+    {
+        skipSpace();
+        if (expect == EXPECT_NOTHING)
+        {
+            if (pos < pending.size())
+                fail("trailing characters");
+            return JSON_EVENT_END;
+        }
+        if (pos >= pending.size())
+        {
+            if (finished)
+                fail("unexpected end");
+            return JSON_EVENT_MORE;
+        }
+        char c = pending[pos];
+        switch (expect)
+        {
+        case EXPECT_COLON:
+            if (c != ':')
+                fail("expected :");
+            pos++;
+            expect = EXPECT_VALUE;
+            continue;
+        case EXPECT_COMMA_OR_END:
+            if (c == ',')
+            {
+                pos++;
+                expect = containers.back() == '{' ? EXPECT_KEY : EXPECT_VALUE;
+                continue;
+            }
+            if (c == '}' || c == ']')
+                return close(c);
+            fail(containers.back() == '{' ? "expected , or }" : "expected , or ]");
+        case EXPECT_KEY_OR_END:
+            if (c == '}')
+                return close(c);
+            [[fallthrough]];
+        case EXPECT_KEY:
+            if (c != '"')
+                fail("expected a key");
+            if (!readString())
+                return JSON_EVENT_MORE;
+            expect = EXPECT_COLON;
+            return JSON_EVENT_KEY;
+        case EXPECT_VALUE_OR_END:
+            if (c == ']')
+                return close(c);
+            [[fallthrough]];
+        default:
+            break;
+        }
+        JSON_EVENT event;
+        switch (c)
+        {
+        case '{':
+        case '[':
+            if (containers.size() >= JSON_MAX_DEPTH)
+                fail("nested too deep");
+            containers.push_back(c);
+            pos++;
+            expect = c == '{' ? EXPECT_KEY_OR_END : EXPECT_VALUE_OR_END;
+            return c == '{' ? JSON_EVENT_OBJECT_START : JSON_EVENT_ARRAY_START;
+        case '"':
+            if (!readString())
+                return JSON_EVENT_MORE;
+            event = JSON_EVENT_STRING;
+            break;
+        case 't':
+        case 'f':
+            if (!(c == 't' ? readWord("true", 4) : readWord("false", 5)))
+                return JSON_EVENT_MORE;
+            booleanValue = c == 't';
+            event = JSON_EVENT_BOOLEAN;
+            break;
+        case 'n':
+            if (!readWord("null", 4))
+                return JSON_EVENT_MORE;
+            event = JSON_EVENT_NULL;
+            break;
+        default:
+            if (!readNumber(event))
+                return JSON_EVENT_MORE;
+        }
+        valueDone();
+        return event;
+    }
+}
+
+QQDommy::JSON_EVENT QQDommy::JsonReader::next()
+{
+    while (true)
+    {
+        JSON_EVENT event = step();
+        if (event == JSON_EVENT_MORE || event == JSON_EVENT_END)
+            return event;
+        if (skipUntil == SIZE_MAX)
+        {
+            last = event;
+            return event;
+        }
+        // the skipped value is complete once the depth is back
+        if (event != JSON_EVENT_KEY && containers.size() == skipUntil)
+            skipUntil = SIZE_MAX;
+    }
+}
+
+void QQDommy::JsonReader::skip()
+{
+    if (last == JSON_EVENT_OBJECT_START || last == JSON_EVENT_ARRAY_START)
+        skipUntil = containers.size() - 1;
+    else if (last == JSON_EVENT_KEY)
+        skipUntil = containers.size();
+    last = JSON_EVENT_MORE;
+}
+
+std::string_view QQDommy::JsonReader::text() const
+{
+    return token;
+}
+
+int64_t QQDommy::JsonReader::integer() const
+{
+    return integerValue;
+}
+
+double QQDommy::JsonReader::number() const
+{
+    return last == JSON_EVENT_INTEGER ? (double)integerValue : floatValue;
+}
+
+bool QQDommy::JsonReader::boolean() const
+{
+    return booleanValue;
+}
+
+size_t QQDommy::JsonReader::depth() const
+{
+    return containers.size();
+}
+
+size_t QQDommy::JsonReader::buffered() const
+{
+    return pending.size() - pos;
+}
+
+void QQDommy::JsonReader::reset()
+{
+    pending.clear();
+    pos = consumed = stringScanned = 0;
+    stringEscaped = finished = false;
+    containers.clear();
+    expect = EXPECT_VALUE;
+    token = std::string_view();
+    skipUntil = SIZE_MAX;
+    last = JSON_EVENT_MORE;
+}
@@ -0,0 +1,225 @@
+#include "json/JsonText.h"
+#include <charconv>
+#include <cstdlib>
+#include <string>
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static char *writeUtf8(char *out, uint32_t code)
+{
+    if (code < 0x80)
+        *out++ = (char)code;
+    else if (code < 0x800)
+    {
+        *out++ = (char)(0xc0 | (code >> 6));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        *out++ = (char)(0xe0 | (code >> 12));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        *out++ = (char)(0xf0 | (code >> 18));
+        *out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    return out;
+}
+
+/// @brief read the 4 hex digits of a \u escape
+static bool readUnit(const char *&cursor, const char *end, uint32_t &unit)
+{
+    if (end - cursor < 4)
+        return false;
+    unit = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int digit = hexDigit(cursor[i]);
+        if (digit < 0)
+            return false;
+        unit = (unit << 4) | digit;
+    }
+    cursor += 4;
+    return true;
+}
+
+const char *QQDommy::JsonText::scanString(const char *&cursor, const char *end, bool &escaped)
+{
+    while (cursor < end)
+    {
+        char c = *cursor;
+        if (c == '"' || (unsigned char)c < 0x20)
+            return cursor;
+        if (c == '\\')
+        {
+            // the escaped character is in the next chunk
+            if (end - cursor < 2)
+                return nullptr;
+            escaped = true;
+            cursor += 2;
+            continue;
+        }
+        cursor++;
+    }
+    return nullptr;
+}
+
+char *QQDommy::JsonText::unescape(const char *begin, const char *end, char *out, const char *&reason, const char *&failedAt)
+{
+    const char *cursor = begin;
+    while (cursor < end)
+    {
+        if (*cursor != '\\')
+        {
+            *out++ = *cursor++;
+            continue;
+        }
+        failedAt = cursor;
+        cursor++;
+        switch (*cursor++)
+        {
+        case '"':
+            *out++ = '"';
+            break;
+        case '\\':
+            *out++ = '\\';
+            break;
+        case '/':
+            *out++ = '/';
+            break;
+        case 'b':
+            *out++ = '\b';
+            break;
+        case 'f':
+            *out++ = '\f';
+            break;
+        case 'n':
+            *out++ = '\n';
+            break;
+        case 'r':
+            *out++ = '\r';
+            break;
+        case 't':
+            *out++ = '\t';
+            break;
+        case 'u':
+        {
+            uint32_t code, low;
+            if (!readUnit(cursor, end, code))
+            {
+                reason = "bad unicode escape";
+                return nullptr;
+            }
+            // a high surrogate must be followed by the low one
+            if (code >= 0xd800 && code <= 0xdbff)
+            {
+                if (end - cursor < 2 || cursor[0] != '\\' || cursor[1] != 'u')
+                {
+                    reason = "lone surrogate";
+                    return nullptr;
+                }
+                cursor += 2;
+                if (!readUnit(cursor, end, low) || low < 0xdc00 || low > 0xdfff)
+                {
+                    reason = "lone surrogate";
+                    return nullptr;
+                }
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            }
+            else if (code >= 0xdc00 && code <= 0xdfff)
+            {
+                reason = "lone surrogate";
+                return nullptr;
+            }
+            out = writeUtf8(out, code);
+            break;
+        }
+        default:
+            reason = "bad escape";
+            return nullptr;
+        }
+    }
+    return out;
+}
+
+const char *QQDommy::JsonText::scanNumber(const char *cursor, const char *end)
+{
+    while (cursor < end && ((*cursor >= '0' && *cursor <= '9') || *cursor == '-' || *cursor == '+' ||
+                            *cursor == '.' || *cursor == 'e' || *cursor == 'E'))
+        cursor++;
+    return cursor;
+}
+
+static bool isDigit(const char *cursor, const char *end)
+{
+    return cursor < end && *cursor >= '0' && *cursor <= '9';
+}
+
+const char *QQDommy::JsonText::parseNumber(const char *begin, const char *end, bool &integral, int64_t &integer, double &number)
+{
+    const char *cursor = begin;
+    bool negative = cursor < end && *cursor == '-';
+    if (negative)
+        cursor++;
+    if (!isDigit(cursor, end))
+        return "unexpected character";
+    // no leading zero
+    if (*cursor == '0' && isDigit(cursor + 1, end))
+        return "leading zero";
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    while (isDigit(cursor, end))
+    {
+        overflow |= __builtin_mul_overflow(magnitude, 10, &magnitude);
+        overflow |= __builtin_add_overflow(magnitude, (uint64_t)(*cursor - '0'), &magnitude);
+        cursor++;
+    }
+    integral = true;
+    if (cursor < end && *cursor == '.')
+    {
+        integral = false;
+        cursor++;
+        if (!isDigit(cursor, end))
+            return "expected a digit";
+        while (isDigit(cursor, end))
+            cursor++;
+    }
+    if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+    {
+        integral = false;
+        cursor++;
+        if (cursor < end && (*cursor == '+' || *cursor == '-'))
+            cursor++;
+        if (!isDigit(cursor, end))
+            return "expected a digit";
+        while (isDigit(cursor, end))
+            cursor++;
+    }
+    if (cursor != end)
+        return "unexpected character";
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (integral && !overflow && magnitude <= limit)
+    {
+        integer = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+        return nullptr;
+    }
+    integral = false;
+    std::from_chars_result result = std::from_chars(begin, end, number);
+    // too large or too small for a double, strtod rounds it to infinity or zero
+    if (result.ec == std::errc::result_out_of_range)
+        number = strtod(std::string(begin, end).c_str(), nullptr);
+    return nullptr;
+}
@@ -0,0 +1,207 @@
+#include "json/JsonWriter.h"
+#include <charconv>
+#include <cmath>
+
+/// @brief 0 for the bytes copied as they are, the escaped character otherwise, 'u' for \u00XX
+static const char *buildEscapes()
+{
+    static char table[256] = {};
+    for (int c = 0; c < 0x20; c++)
+        table[c] = 'u';
+    table[(unsigned char)'"'] = '"';
+    table[(unsigned char)'\\'] = '\\';
+    table[(unsigned char)'\b'] = 'b';
+    table[(unsigned char)'\f'] = 'f';
+    table[(unsigned char)'\n'] = 'n';
+    table[(unsigned char)'\r'] = 'r';
+    table[(unsigned char)'\t'] = 't';
+    return table;
+}
+
+static const char *ESCAPES = buildEscapes();
+
+QQDommy::JsonWriter::JsonWriter(ByteBuffer &out) : out(out)
+{
+}
+
+void QQDommy::JsonWriter::separate()
+{
+    if (keyed)
+    {
+        keyed = false;
+        return;
+    }
+    if (filled[level])
+        out.write_uint8(',');
+    filled[level] = true;
+}
+
+void QQDommy::JsonWriter::open(char bracket)
+{
+    if (level >= JSON_MAX_DEPTH)
+        throw JsonParseException("nested too deep", out.readableBytes());
+    separate();
+    out.write_uint8(bracket);
+    filled[++level] = false;
+}
+
+void QQDommy::JsonWriter::close(char bracket)
+{
+    if (level == 0)
+        throw JsonParseException("no container to close", out.readableBytes());
+    level--;
+    out.write_uint8(bracket);
+}
+
+void QQDommy::JsonWriter::writeString(std::string_view text)
+{
+    const static char HEX[] = "0123456789abcdef";
+    out.ensureWritable(text.size() + 2);
+    out.write_uint8('"');
+    const char *run = text.data();
+    const char *end = text.data() + text.size();
+    for (const char *cursor = run; cursor < end; cursor++)
+    {
+        char escape = ESCAPES[(unsigned char)*cursor];
+        if (escape == 0)
+            continue;
+        // the bytes up to the escape go in one copy
+        out.writeBytes(run, cursor - run);
+        run = cursor + 1;
+        if (escape != 'u')
+        {
+            char pair[2] = {'\\', escape};
+            out.writeBytes(pair, 2);
+            continue;
+        }
+        char unit[6] = {'\\', 'u', '0', '0', HEX[(*cursor >> 4) & 0xf], HEX[*cursor & 0xf]};
+        out.writeBytes(unit, 6);
+    }
+    out.writeBytes(run, end - run);
+    out.write_uint8('"');
+}
+
+void QQDommy::JsonWriter::writeSigned(int64_t number)
+{
+    out.ensureWritable(20);
+    char *at = (char *)out.writePointer();
+    std::to_chars_result result = std::to_chars(at, at + 20, number);
+    out.commitWrite(result.ptr - at);
+}
+
+void QQDommy::JsonWriter::writeUnsigned(uint64_t number)
+{
+    out.ensureWritable(20);
+    char *at = (char *)out.writePointer();
+    std::to_chars_result result = std::to_chars(at, at + 20, number);
+    out.commitWrite(result.ptr - at);
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::beginObject()
+{
+    open('{');
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::endObject()
+{
+    close('}');
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::beginArray()
+{
+    open('[');
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::endArray()
+{
+    close(']');
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::key(std::string_view name)
+{
+    separate();
+    writeString(name);
+    out.write_uint8(':');
+    keyed = true;
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::value(std::string_view text)
+{
+    separate();
+    writeString(text);
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::value(bool boolean)
+{
+    separate();
+    if (boolean)
+        out.writeBytes("true", 4);
+    else
+        out.writeBytes("false", 5);
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::value(double number)
+{
+    if (!std::isfinite(number))
+        return null();
+    separate();
+    // the shortest text read back as the same double
+    out.ensureWritable(32);
+    char *at = (char *)out.writePointer();
+    std::to_chars_result result = std::to_chars(at, at + 32, number);
+    out.commitWrite(result.ptr - at);
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::value(const JsonValue &json)
+{
+    switch (json.getType())
+    {
+    case JSON_BOOLEAN:
+        return value(json.asBoolean());
+    case JSON_INTEGER:
+        return value(json.asInteger());
+    case JSON_FLOAT:
+        return value(json.asFloat());
+    case JSON_STRING:
+        return value(json.asString());
+    case JSON_ARRAY:
+        beginArray();
+        for (const JsonValue &element : json)
+            value(element);
+        return endArray();
+    case JSON_OBJECT:
+        beginObject();
+        for (const JsonMember *member = json.memberBegin(); member != json.memberEnd(); member++)
+            key(member->key).value(member->value);
+        return endObject();
+    default:
+        return null();
+    }
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::null()
+{
+    separate();
+    out.writeBytes("null", 4);
+    return *this;
+}
+
+QQDommy::JsonWriter &QQDommy::JsonWriter::raw(std::string_view json)
+{
+    separate();
+    out.writeBytes(json.data(), json.size());
+    return *this;
+}
+
+size_t QQDommy::JsonWriter::depth() const
+{
+    return level;
+}
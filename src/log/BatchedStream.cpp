@@ -0,0 +1,300 @@
+#include "log/BatchedStream.h"
+#include "utils/Metrics.h"
+#include <chrono>
+#include <ctime>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+
+static const QQDommy::Counter failedOpens("log_file_open_failures_total", "log files that could not be opened, retried before the next batch");
+static const QQDommy::Counter lostBatches("log_lost_batches_total", "batches of log lines that could not be written");
+
+static int64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+QQDommy::BatchedStream::BatchedStream(size_t batchBytes, int flushIntervalMs)
+    : batchBytes(batchBytes), flushIntervalMs(flushIntervalMs), lastFlushMs(nowMs()), fd(-1)
+{
+    active.reserve(batchBytes + batchBytes / 4);
+}
+
+QQDommy::BatchedStream::~BatchedStream()
+{
+    stop();
+}
+
+void QQDommy::BatchedStream::start()
+{
+    writer = std::thread([this]()
+                         { run(); });
+}
+
+void QQDommy::BatchedStream::stop()
+{
+    if (!writer.joinable())
+        return;
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cond.notify_all();
+    writer.join();
+}
+
+LogCPP::BaseStream &QQDommy::BatchedStream::operator<<(const std::string &content)
+{
+    active += content;
+    active.push_back('\n');
+    lines.fetch_add(1, std::memory_order_relaxed);
+    if (active.size() >= batchBytes)
+        flush();
+    return *this;
+}
+
+void QQDommy::BatchedStream::flush()
+{
+    lastFlushMs = nowMs();
+    if (active.empty())
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    // the disk is behind, hold the logger back rather than growing without bound
+    cond.wait(lock, [this]()
+              { return pendingBytes < MAX_PENDING_BYTES || stopping; });
+    pendingBytes += active.size();
+    pending.push_back(std::move(active));
+    if (!spare.empty())
+    {
+        active = std::move(spare.back());
+        spare.pop_back();
+    }
+    else
+        active = std::string();
+    active.clear();
+    active.reserve(batchBytes + batchBytes / 4);
+    lock.unlock();
+    cond.notify_all();
+}
+
+void QQDommy::BatchedStream::poll()
+{
+    if (!active.empty() && nowMs() - lastFlushMs >= flushIntervalMs)
+        flush();
+}
+
+void QQDommy::BatchedStream::sync()
+{
+    flush();
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this]()
+              { return (pending.empty() && writing == 0) || !writer.joinable(); });
+}
+
+void QQDommy::BatchedStream::run()
+{
+    std::vector<std::string> batches;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cond.wait(lock, [this]()
+                  { return !pending.empty() || stopping; });
+        if (pending.empty())
+            return;
+        batches.swap(pending);
+        writing = batches.size();
+        lock.unlock();
+
+        writeAll(batches);
+
+        lock.lock();
+        for (std::string &batch : batches)
+        {
+            pendingBytes -= batch.size();
+            if (spare.size() < 4)
+                spare.push_back(std::move(batch));
+        }
+        batches.clear();
+        writing = 0;
+        cond.notify_all();
+    }
+}
+
+void QQDommy::BatchedStream::writeAll(std::vector<std::string> &batches)
+{
+    // as many batches as possible go into one writev, a rotation splits them
+    size_t begin = 0;
+    for (size_t i = 0; i < batches.size(); i++)
+    {
+        if (!account(batches[i].size()))
+            continue;
+        writeRange(batches, begin, i);
+        rotateFile();
+        account(batches[i].size());
+        begin = i;
+    }
+    writeRange(batches, begin, batches.size());
+}
+
+void QQDommy::BatchedStream::writeRange(std::vector<std::string> &batches, size_t begin, size_t end)
+{
+    if (fd < 0)
+    {
+        lostBatches.add(end - begin);
+        return;
+    }
+    std::vector<iovec> iov;
+    for (size_t i = begin; i < end; i++)
+        if (!batches[i].empty())
+            iov.push_back({batches[i].data(), batches[i].size()});
+    size_t first = 0;
+    while (first < iov.size())
+    {
+        int count = (int)std::min(iov.size() - first, (size_t)IOV_MAX);
+        ssize_t n = ::writev(fd, &iov[first], count);
+        writeCalls.fetch_add(1, std::memory_order_relaxed);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            // the logger can not log its own failure, it is only counted
+            lostBatches.add(end - begin);
+            return;
+        }
+        bytesWritten.fetch_add(n, std::memory_order_relaxed);
+        while (first < iov.size() && (size_t)n >= iov[first].iov_len)
+            n -= iov[first++].iov_len;
+        if (first < iov.size())
+        {
+            iov[first].iov_base = (char *)iov[first].iov_base + n;
+            iov[first].iov_len -= n;
+        }
+    }
+}
+
+uint64_t QQDommy::BatchedStream::getLines() const
+{
+    return lines.load(std::memory_order_relaxed);
+}
+
+uint64_t QQDommy::BatchedStream::getWriteCalls() const
+{
+    return writeCalls.load(std::memory_order_relaxed);
+}
+
+uint64_t QQDommy::BatchedStream::getBytesWritten() const
+{
+    return bytesWritten.load(std::memory_order_relaxed);
+}
+
+QQDommy::BatchedConsoleStream::BatchedConsoleStream(size_t batchBytes, int flushIntervalMs)
+    : BatchedStream(batchBytes, flushIntervalMs)
+{
+    fd = STDOUT_FILENO;
+    start();
+}
+
+QQDommy::BatchedConsoleStream::~BatchedConsoleStream()
+{
+    stop();
+}
+
+/// @brief the local date of now, yyyymmdd
+static int today()
+{
+    time_t now = time(nullptr);
+    tm local;
+    localtime_r(&now, &local);
+    return (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday;
+}
+
+QQDommy::BatchedFileStream::BatchedFileStream(const std::string &path, const FileRotation &rotation,
+                                              size_t batchBytes, int flushIntervalMs)
+    : BatchedStream(batchBytes, flushIntervalMs), path(path), rotation(rotation)
+{
+    openFile();
+    if (fd < 0)
+        throw LogCPP::LogFileOpenException(path);
+    start();
+}
+
+QQDommy::BatchedFileStream::~BatchedFileStream()
+{
+    stop();
+    if (fd >= 0)
+        ::close(fd);
+}
+
+void QQDommy::BatchedFileStream::openFile()
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    struct stat st;
+    fileBytes = fd >= 0 && fstat(fd, &st) == 0 ? st.st_size : 0;
+    fileDay = today();
+    if (fd < 0)
+        failedOpens.add();
+}
+
+bool QQDommy::BatchedFileStream::account(size_t bytes)
+{
+    // the file failed to open again after a rotation, every batch tries once more
+    if (fd < 0)
+        openFile();
+    bool full = rotation.maxBytes > 0 && fileBytes > 0 && fileBytes + bytes > rotation.maxBytes;
+    bool nextDay = rotation.daily && fileBytes > 0 && today() != fileDay;
+    if (full || nextDay)
+        return true;
+    fileBytes += bytes;
+    return false;
+}
+
+void QQDommy::BatchedFileStream::rotateFile()
+{
+    char stamp[32];
+    time_t now = time(nullptr);
+    tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+    std::string rotated = path + "." + stamp;
+    // several rotations within a second
+    for (int i = 1; access(rotated.c_str(), F_OK) == 0; i++)
+        rotated = path + "." + stamp + "." + std::to_string(i);
+    if (fd >= 0)
+        ::close(fd);
+    ::rename(path.c_str(), rotated.c_str());
+    openFile();
+    if (rotation.maxFiles > 0)
+        prune();
+}
+
+void QQDommy::BatchedFileStream::prune()
+{
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    std::string prefix = (slash == std::string::npos ? path : path.substr(slash + 1)) + ".";
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr)
+        return;
+    std::vector<std::string> rotated;
+    for (dirent *entry = readdir(d); entry != nullptr; entry = readdir(d))
+    {
+        std::string name = entry->d_name;
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0)
+            rotated.push_back(name);
+    }
+    closedir(d);
+    if (rotated.size() <= rotation.maxFiles)
+        return;
+    // the stamps sort by time
+    std::sort(rotated.begin(), rotated.end());
+    for (size_t i = 0; i + rotation.maxFiles < rotated.size(); i++)
+        ::unlink((dir + "/" + rotated[i]).c_str());
+}
@@ -0,0 +1,218 @@
+#include "log/BinaryLog.h"
+#include "log/RingLogger.h"
+#include <thread>
+#include <cstdio>
+
+static std::atomic<const QQDommy::LogFormat *> formats[QQDommy::MAX_LOG_FORMATS];
+/// @brief id 0 is never given out
+static std::atomic<uint32_t> nextFormatId{1};
+static std::atomic<size_t> ringSize{QQDommy::DEFAULT_BINARY_RING_SIZE};
+static std::atomic<QQDommy::RingLogger *> target{nullptr};
+
+/**
+ * @brief closes the ring of the thread when it exits, the daemon frees it
+ *
+ */
+struct ThreadRingOwner
+{
+    QQDommy::BinaryLogRing *ring = nullptr;
+    ~ThreadRingOwner()
+    {
+        if (ring != nullptr)
+            ring->closed.store(true, std::memory_order_release);
+    }
+};
+
+QQDommy::LogFormat::LogFormat(LogCPP::LEVELS level, const char *format, const char *file, int line)
+    : level(level), format(format), file(file), line(line)
+{
+    id = BinaryLog::registerFormat(this);
+}
+
+QQDommy::BinaryLogRing::BinaryLogRing(size_t size)
+{
+    capacity = BINARY_STRING_LIMIT * 4;
+    while (capacity < size)
+        capacity <<= 1;
+    data.reset(new uint8_t[capacity]);
+}
+
+void QQDommy::BinaryLogRing::release(uint64_t pos)
+{
+    tail.store(pos, std::memory_order_release);
+}
+
+bool QQDommy::BinaryLogRing::empty() const
+{
+    return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+}
+
+size_t QQDommy::BinaryLogRing::getCapacity() const
+{
+    return capacity;
+}
+
+uint32_t QQDommy::BinaryLog::registerFormat(const LogFormat *format)
+{
+    uint32_t id = nextFormatId.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MAX_LOG_FORMATS)
+        return 0;
+    formats[id].store(format, std::memory_order_release);
+    return id;
+}
+
+const QQDommy::LogFormat *QQDommy::BinaryLog::getFormat(uint32_t id)
+{
+    if (id == 0 || id >= MAX_LOG_FORMATS)
+        return nullptr;
+    return formats[id].load(std::memory_order_acquire);
+}
+
+QQDommy::BinaryLogRing *QQDommy::BinaryLog::attachThread()
+{
+    static thread_local ThreadRingOwner owner;
+    RingLogger *logger = target.load(std::memory_order_acquire);
+    if (logger == nullptr)
+        logger = &static_cast<RingLogger &>(RingLogger::GetInstance());
+    owner.ring = new BinaryLogRing(ringSize.load(std::memory_order_relaxed));
+    logger->AttachBinary(owner.ring);
+    threadRing = owner.ring;
+    return threadRing;
+}
+
+uint8_t *QQDommy::BinaryLog::waitForSpace(BinaryLogRing *ring, size_t length)
+{
+    if (length > ring->getCapacity() / 2)
+        return nullptr;
+    while (true)
+    {
+        std::this_thread::yield();
+        uint8_t *p = ring->reserve(length);
+        if (p != nullptr)
+            return p;
+        if (ring->abandoned.load(std::memory_order_acquire))
+            return nullptr;
+    }
+}
+
+/**
+ * @brief append one conversion, the spec is a complete printf conversion
+ *
+ */
+template <typename T>
+static void appendConversion(std::string &out, const char *spec, T value)
+{
+    char buf[128];
+    int length = snprintf(buf, sizeof(buf), spec, value);
+    if (length < 0)
+        return;
+    if ((size_t)length < sizeof(buf))
+    {
+        out.append(buf, length);
+        return;
+    }
+    size_t at = out.size();
+    out.resize(at + length + 1);
+    snprintf(&out[at], length + 1, spec, value);
+    out.resize(at + length);
+}
+
+void QQDommy::BinaryLog::format(std::string &out, const char *format, const uint8_t *args, size_t length)
+{
+    const uint8_t *end = args + length;
+    std::string text;
+    char spec[64];
+    for (const char *p = format; *p != '\0'; p++)
+    {
+        if (*p != '%')
+        {
+            out.push_back(*p);
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            out.push_back('%');
+            p++;
+            continue;
+        }
+        // copy the flags, the width, the precision and the length, * takes an argument
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.*hlLqjzt", *p) != nullptr && n < sizeof(spec) - 16)
+        {
+            if (*p == '*' && args + 5 <= end && *args == ARG_INT32)
+            {
+                int32_t star;
+                memcpy(&star, args + 1, sizeof(star));
+                args += 5;
+                n += snprintf(spec + n, sizeof(spec) - n, "%d", star);
+            }
+            else if (*p != '*')
+                spec[n++] = *p;
+            p++;
+        }
+        if (*p == '\0')
+            break;
+        spec[n++] = *p;
+        spec[n] = '\0';
+        if (*p == 'n' || args >= end)
+            continue;
+
+        uint8_t tag = *args++;
+        if (tag == ARG_INT32 || tag == ARG_UINT32)
+        {
+            uint32_t value;
+            memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            if (tag == ARG_INT32)
+                appendConversion(out, spec, (int32_t)value);
+            else
+                appendConversion(out, spec, value);
+        }
+        else if (tag == ARG_INT64 || tag == ARG_UINT64)
+        {
+            uint64_t value;
+            memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            if (tag == ARG_INT64)
+                appendConversion(out, spec, (long long)value);
+            else
+                appendConversion(out, spec, (unsigned long long)value);
+        }
+        else if (tag == ARG_DOUBLE)
+        {
+            double value;
+            memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            appendConversion(out, spec, value);
+        }
+        else if (tag == ARG_STRING)
+        {
+            uint32_t size;
+            memcpy(&size, args, sizeof(size));
+            args += sizeof(size);
+            text.assign((const char *)args, size);
+            args += size;
+            appendConversion(out, spec, text.c_str());
+        }
+        else if (tag == ARG_POINTER)
+        {
+            const void *value;
+            memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            appendConversion(out, spec, value);
+        }
+        else
+            return;
+    }
+}
+
+void QQDommy::BinaryLog::setRingSize(size_t size)
+{
+    ringSize.store(size, std::memory_order_relaxed);
+}
+
+void QQDommy::BinaryLog::setTarget(RingLogger *logger)
+{
+    target.store(logger, std::memory_order_release);
+}
@@ -0,0 +1,94 @@
+#include "log/LogBuilder.h"
+#include <cstdio>
+#include <cstdarg>
+#include <charconv>
+
+/// @brief most messages fit, longer ones are formatted twice
+const static size_t FORMAT_STACK_SIZE = 256;
+
+QQDommy::LogBuilder::LogBuilder()
+{
+    text.reserve(FORMAT_STACK_SIZE);
+}
+
+void QQDommy::LogBuilder::appendSigned(long long value)
+{
+    char buf[24];
+    char *end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+    text.append(buf, end - buf);
+}
+
+void QQDommy::LogBuilder::appendUnsigned(unsigned long long value)
+{
+    char buf[24];
+    char *end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+    text.append(buf, end - buf);
+}
+
+void QQDommy::LogBuilder::appendDouble(double value)
+{
+    char buf[32];
+    int length = snprintf(buf, sizeof(buf), "%g", value);
+    text.append(buf, length);
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(const std::string &value)
+{
+    text.append(value);
+    return *this;
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(std::string_view value)
+{
+    text.append(value.data(), value.size());
+    return *this;
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(const char *value)
+{
+    text.append(value == nullptr ? "(null)" : value);
+    return *this;
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(char value)
+{
+    text.push_back(value);
+    return *this;
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(bool value)
+{
+    text.append(value ? "true" : "false");
+    return *this;
+}
+
+QQDommy::LogBuilder &QQDommy::LogBuilder::operator<<(const void *value)
+{
+    char buf[24];
+    int length = snprintf(buf, sizeof(buf), "%p", value);
+    text.append(buf, length);
+    return *this;
+}
+
+const std::string &QQDommy::LogBuilder::str() const
+{
+    return text;
+}
+
+std::string QQDommy::LogBuilder::format(const char *format, ...)
+{
+    char buf[FORMAT_STACK_SIZE];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (length < 0)
+        return std::string();
+    if ((size_t)length < sizeof(buf))
+        return std::string(buf, length);
+    std::string result(length, '\0');
+    va_start(args, format);
+    vsnprintf(result.data(), length + 1, format, args);
+    va_end(args);
+    return result;
+}
@@ -0,0 +1,26 @@
+#include "log/LogElements.h"
+#include <ctime>
+
+QQDommy::RecordTimeElement::RecordTimeElement(const std::string &format) : format(format)
+{
+}
+
+void QQDommy::RecordTimeElement::setTime(int64_t ns)
+{
+    timeNs = ns;
+}
+
+void QQDommy::RecordTimeElement::CompileElement(std::string &builder)
+{
+    char buf[128];
+    time_t seconds = (time_t)(timeNs / 1000000000);
+    tm local;
+    localtime_r(&seconds, &local);
+    size_t length = strftime(buf, sizeof(buf), format.c_str(), &local);
+    builder.append(buf, length);
+}
+
+const std::string &QQDommy::RecordTimeElement::getFormat() const
+{
+    return format;
+}
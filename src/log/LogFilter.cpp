@@ -0,0 +1,32 @@
+#include "log/LogFilter.h"
+
+std::atomic<int> QQDommy::LogFilter::minimum{QQ_LOG_MIN_LEVEL};
+
+void QQDommy::LogFilter::setMinimum(LogCPP::LEVELS level)
+{
+    int value = (int)level < QQ_LOG_MIN_LEVEL ? QQ_LOG_MIN_LEVEL : (int)level;
+    minimum.store(value, std::memory_order_relaxed);
+}
+
+LogCPP::LEVELS QQDommy::LogFilter::getMinimum()
+{
+    return (LogCPP::LEVELS)minimum.load(std::memory_order_relaxed);
+}
+
+const static char *LEVEL_NAMES[] = {"debug", "info", "warning", "error", "fatal"};
+
+bool QQDommy::LogFilter::parseLevel(const std::string &name, LogCPP::LEVELS &level)
+{
+    for (int i = LogCPP::DEBUG; i <= LogCPP::FATAL; i++)
+        if (name == LEVEL_NAMES[i])
+        {
+            level = (LogCPP::LEVELS)i;
+            return true;
+        }
+    return false;
+}
+
+const char *QQDommy::LogFilter::levelName(LogCPP::LEVELS level)
+{
+    return (int)level >= LogCPP::DEBUG && (int)level <= LogCPP::FATAL ? LEVEL_NAMES[level] : "unknown";
+}
@@ -0,0 +1,85 @@
+#include "log/LogLayout.h"
+#include "log/LogElements.h"
+#include <ctime>
+#include <climits>
+
+void QQDommy::LogLayout::clear()
+{
+    segments.clear();
+}
+
+void QQDommy::LogLayout::addLiteral(const std::string &text)
+{
+    if (text.empty())
+        return;
+    if (!segments.empty() && segments.back().kind == SEGMENT_LITERAL)
+    {
+        segments.back().text += text;
+        return;
+    }
+    segments.push_back({SEGMENT_LITERAL, text, 0, std::string()});
+}
+
+void QQDommy::LogLayout::addLevel(const std::string *levelTexts)
+{
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+        levels[i] = levelTexts[i];
+    segments.push_back({SEGMENT_LEVEL, std::string(), 0, std::string()});
+}
+
+void QQDommy::LogLayout::addTime(const std::string &format)
+{
+    segments.push_back({SEGMENT_TIME, format, LLONG_MIN, std::string()});
+}
+
+void QQDommy::LogLayout::compile(LogCPP::BaseElement *const *levelElements, const std::vector<LogCPP::BaseElement *> &elements)
+{
+    clear();
+    std::string levelTexts[LEVEL_COUNT];
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+        levelElements[i]->CompileElement(levelTexts[i]);
+    addLevel(levelTexts);
+    for (LogCPP::BaseElement *element : elements)
+    {
+        RecordTimeElement *time = dynamic_cast<RecordTimeElement *>(element);
+        if (time != nullptr)
+        {
+            addTime(time->getFormat());
+            continue;
+        }
+        std::string text;
+        element->CompileElement(text);
+        addLiteral(text);
+    }
+}
+
+void QQDommy::LogLayout::render(std::string &out, LogCPP::LEVELS level, int64_t timeNs, const char *msg, size_t length)
+{
+    for (Segment &segment : segments)
+    {
+        if (segment.kind == SEGMENT_LITERAL)
+            out += segment.text;
+        else if (segment.kind == SEGMENT_LEVEL)
+            out += levels[level];
+        else
+        {
+            int64_t second = timeNs >= 0 ? timeNs / 1000000000 : (timeNs + 1) / 1000000000 - 1;
+            if (second != segment.second)
+            {
+                char buf[128];
+                time_t seconds = (time_t)second;
+                tm local;
+                localtime_r(&seconds, &local);
+                segment.cached.assign(buf, strftime(buf, sizeof(buf), segment.text.c_str(), &local));
+                segment.second = second;
+            }
+            out += segment.cached;
+        }
+    }
+    out.append(msg, length);
+}
+
+size_t QQDommy::LogLayout::size() const
+{
+    return segments.size();
+}
@@ -0,0 +1,204 @@
+#include "log/LogRing.h"
+#include <cstring>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#include <algorithm>
+
+QQDommy::LogRing::LogRing(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    slots.reset(new LogSlot[size]);
+    mask = size - 1;
+    for (size_t i = 0; i < size; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].overflow = nullptr;
+    }
+}
+
+QQDommy::LogRing::~LogRing()
+{
+    for (size_t i = 0; i <= mask; i++)
+        delete[] slots[i].overflow;
+}
+
+QQDommy::LogSlot *QQDommy::LogRing::reserve(size_t &pos)
+{
+    pos = enqueuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        LogSlot *slot = &slots[pos & mask];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return slot;
+        }
+        else if (diff < 0)
+            return nullptr;
+        else
+            pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+}
+
+void QQDommy::LogRing::publish(LogSlot *slot, size_t pos)
+{
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    wake();
+}
+
+void QQDommy::LogRing::wake()
+{
+    // pairs with the fence in wait, either the consumer sees the work or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerWaiting.load(std::memory_order_relaxed))
+        notify();
+}
+
+QQDommy::LogSlot *QQDommy::LogRing::claim(size_t &pos)
+{
+    pos = dequeuePos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        LogSlot *slot = &slots[pos & mask];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            // a producer dropping the oldest message may race with the consumer
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return slot;
+        }
+        else if (diff < 0)
+            return nullptr;
+        else
+            pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+}
+
+void QQDommy::LogRing::noteDepth()
+{
+    size_t depth = size();
+    if (depth > highWater.load(std::memory_order_relaxed))
+        highWater.store(depth, std::memory_order_relaxed);
+}
+
+bool QQDommy::LogRing::discardOldest(LogCPP::LEVELS &level)
+{
+    size_t pos;
+    LogSlot *slot = claim(pos);
+    if (slot == nullptr)
+        return false;
+    level = slot->level;
+    delete[] slot->overflow;
+    slot->overflow = nullptr;
+    slot->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool QQDommy::LogRing::tryPush(LogCPP::LEVELS level, const char *msg, size_t length)
+{
+    // allocated before the slot is taken, a reserved slot must be published or the consumer stalls on it
+    std::unique_ptr<char[]> overflow;
+    if (length > LOG_SLOT_TEXT)
+    {
+        overflow.reset(new char[length]);
+        memcpy(overflow.get(), msg, length);
+    }
+    size_t pos;
+    LogSlot *slot = reserve(pos);
+    if (slot == nullptr)
+        return false;
+    slot->level = level;
+    slot->ticks = TscClock::now();
+    slot->length = (uint32_t)length;
+    if (overflow)
+        slot->overflow = overflow.release();
+    else
+        memcpy(slot->text, msg, length);
+    publish(slot, pos);
+    return true;
+}
+
+void QQDommy::LogRing::push(LogCPP::LEVELS level, const char *msg, size_t length)
+{
+    for (unsigned spins = 0; !tryPush(level, msg, length); spins++)
+    {
+        // the consumer is behind, make sure it is awake and give it the core
+        notify();
+        if (spins < 16)
+            continue;
+        std::this_thread::yield();
+    }
+}
+
+void QQDommy::LogRing::wait(int timeoutMs, const std::function<bool()> &ready)
+{
+    uint32_t expected = signal.load(std::memory_order_acquire);
+    consumerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (empty() && !(ready && ready()))
+    {
+        timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (long)(timeoutMs % 1000) * 1000000;
+        syscall(SYS_futex, (uint32_t *)&signal, FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+    }
+    consumerWaiting.store(false, std::memory_order_relaxed);
+}
+
+void QQDommy::LogRing::notify()
+{
+    // only the first producer seeing the consumer asleep pays for the syscall
+    if (!consumerWaiting.exchange(false, std::memory_order_acq_rel))
+        return;
+    wakeups.fetch_add(1, std::memory_order_relaxed);
+    signal.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, (uint32_t *)&signal, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+bool QQDommy::LogRing::empty() const
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    const LogSlot &slot = slots[pos & mask];
+    return slot.sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+size_t QQDommy::LogRing::size() const
+{
+    size_t head = dequeuePos.load(std::memory_order_relaxed);
+    size_t tail = enqueuePos.load(std::memory_order_relaxed);
+    // the two positions are not read at once
+    return tail > head ? std::min(tail - head, mask + 1) : 0;
+}
+
+size_t QQDommy::LogRing::getCapacity() const
+{
+    return mask + 1;
+}
+
+uint64_t QQDommy::LogRing::getWakeups() const
+{
+    return wakeups.load(std::memory_order_relaxed);
+}
+
+uint64_t QQDommy::LogRing::getEnqueued() const
+{
+    return enqueuePos.load(std::memory_order_relaxed);
+}
+
+uint64_t QQDommy::LogRing::getDrained() const
+{
+    return drained.load(std::memory_order_relaxed);
+}
+
+size_t QQDommy::LogRing::getHighWater() const
+{
+    return highWater.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,114 @@
+#include "log/LoggerConfig.h"
+#include "log/LogFilter.h"
+#include "log/LogElements.h"
+#include "log/BatchedStream.h"
+
+std::string QQDommy::LoggerConfig::text(JsonCPP::JsonInstance &value)
+{
+    std::string text = value.ToString();
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"')
+        return text.substr(1, text.size() - 2);
+    return text;
+}
+
+size_t QQDommy::LoggerConfig::integer(JsonCPP::JsonInstance &value, size_t fallback)
+{
+    if (value.GetType() != JsonCPP::Integer)
+        return fallback;
+    int number = static_cast<JsonCPP::JsonInteger &>(value).GetValue();
+    return number < 0 ? fallback : (size_t)number;
+}
+
+void QQDommy::LoggerConfig::load(const std::string &path, LogCPP::BaseLogger &logger, std::vector<ConfigElement> *elements)
+{
+    std::string filePath = path;
+    JsonCPP::JsonObject *config = JsonCPP::JsonFactory::CreateJsonObject(filePath);
+    if (config == nullptr)
+        throw LogCPP::LoggerConfigException(path);
+
+    JsonCPP::JsonInstance &minLevel = (*config)["minLevel"];
+    LogCPP::LEVELS level;
+    if (minLevel.GetType() == JsonCPP::String && LogFilter::parseLevel(text(minLevel), level))
+        LogFilter::setMinimum(level);
+
+    JsonCPP::JsonInstance &elementList = (*config)["elements"];
+    if (elements != nullptr && elementList.GetType() == JsonCPP::Array)
+    {
+        JsonCPP::JsonArray &array = static_cast<JsonCPP::JsonArray &>(elementList);
+        for (JsonCPP::JsonArrayIterator it = array.Begin(); it != array.End(); ++it)
+        {
+            JsonCPP::JsonObject &element = *static_cast<JsonCPP::JsonObject *>(*it);
+            std::string name = text(element["name"]);
+            ConfigElement loaded;
+            if (name == "constantString")
+                loaded.constant.reset(new LogCPP::ConstantStringElement(text(element["value"])));
+            else if (name == "time")
+                loaded.time.reset(new RecordTimeElement(text(element["value"])));
+            else
+                continue;
+            elements->push_back(std::move(loaded));
+        }
+    }
+
+    JsonCPP::JsonInstance &streamList = (*config)["streams"];
+    if (streamList.GetType() == JsonCPP::Array)
+    {
+        JsonCPP::JsonArray &array = static_cast<JsonCPP::JsonArray &>(streamList);
+        for (JsonCPP::JsonArrayIterator it = array.Begin(); it != array.End(); ++it)
+        {
+            JsonCPP::JsonObject &stream = *static_cast<JsonCPP::JsonObject *>(*it);
+            std::string name = text(stream["name"]);
+            size_t batchBytes = integer(stream["batchBytes"], DEFAULT_BATCH_BYTES);
+            int flushMs = (int)integer(stream["flushMs"], DEFAULT_FLUSH_MS);
+            if (name == "console")
+                logger.AddStream(new BatchedConsoleStream(batchBytes, flushMs));
+            else if (name == "file")
+            {
+                FileRotation rotation;
+                rotation.maxBytes = integer(stream["rotateBytes"], 0);
+                rotation.maxFiles = integer(stream["maxFiles"], 0);
+                JsonCPP::JsonInstance &daily = stream["rotateDaily"];
+                rotation.daily = daily.GetType() == JsonCPP::Boolean && static_cast<JsonCPP::JsonBoolean &>(daily).GetValue();
+                logger.AddStream(new BatchedFileStream(text(stream["outputDir"]), rotation, batchBytes, flushMs));
+            }
+        }
+    }
+    delete config;
+}
+
+QQDommy::LogQueueConfig QQDommy::LoggerConfig::loadQueue(const std::string &path)
+{
+    const static std::pair<const char *, OVERFLOW_POLICY> POLICIES[] = {
+        {"block", POLICY_BLOCK}, {"dropNewest", POLICY_DROP_NEWEST}, {"dropOldest", POLICY_DROP_OLDEST}, {"sample", POLICY_SAMPLE}};
+    std::string filePath = path;
+    JsonCPP::JsonObject *config = JsonCPP::JsonFactory::CreateJsonObject(filePath);
+    if (config == nullptr)
+        throw LogCPP::LoggerConfigException(path);
+
+    LogQueueConfig queue;
+    JsonCPP::JsonInstance &section = (*config)["queue"];
+    if (section.GetType() != JsonCPP::Object)
+    {
+        delete config;
+        return queue;
+    }
+    JsonCPP::JsonObject &settings = static_cast<JsonCPP::JsonObject &>(section);
+    queue.capacity = integer(settings["capacity"], DEFAULT_LOG_CAPACITY);
+    queue.summaryMs = (int)integer(settings["summaryMs"], DEFAULT_DROP_SUMMARY_MS);
+    JsonCPP::JsonInstance &policyList = settings["policies"];
+    for (size_t i = 0; policyList.GetType() == JsonCPP::Object && i < LEVEL_COUNT; i++)
+    {
+        JsonCPP::JsonInstance &entry = static_cast<JsonCPP::JsonObject &>(policyList)[LogFilter::levelName((LogCPP::LEVELS)i)];
+        if (entry.GetType() != JsonCPP::Object)
+            continue;
+        JsonCPP::JsonObject &policy = static_cast<JsonCPP::JsonObject &>(entry);
+        std::string name = text(policy["policy"]);
+        for (const auto &known : POLICIES)
+            if (name == known.first)
+                queue.policies[i].policy = known.second;
+        queue.policies[i].keep = (uint32_t)integer(policy["keep"], 1);
+        queue.policies[i].every = (uint32_t)integer(policy["every"], 1);
+    }
+    delete config;
+    return queue;
+}
@@ -0,0 +1,360 @@
+#include "log/RingLogger.h"
+#include "log/LoggerConfig.h"
+#include "log/LogFilter.h"
+#include <algorithm>
+
+QQDommy::RingLogger *QQDommy::RingLogger::instance = nullptr;
+
+static QQDommy::LogQueueConfig withCapacity(size_t capacity)
+{
+    QQDommy::LogQueueConfig config;
+    config.capacity = capacity;
+    return config;
+}
+
+QQDommy::RingLogger::RingLogger(size_t capacity) : RingLogger(withCapacity(capacity))
+{
+}
+
+QQDommy::RingLogger::RingLogger(const LogQueueConfig &config) : ring(config.capacity), summaryMs(config.summaryMs)
+{
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+    {
+        policies[i] = config.policies[i];
+        if (policies[i].every == 0 || policies[i].keep > policies[i].every)
+            policies[i].keep = policies[i].every = 1;
+        sampled[i].store(0, std::memory_order_relaxed);
+        dropped[i].store(0, std::memory_order_relaxed);
+    }
+    CompileLayout();
+}
+
+void QQDommy::RingLogger::Start()
+{
+    std::call_once(startOnce, [this]()
+                   { daemon = std::thread([this]()
+                                          { Run(); }); });
+}
+
+QQDommy::RingLogger::~RingLogger()
+{
+    SafeDelete();
+    // a ring still open belongs to a living thread which may log into it
+    for (BinaryLogRing *binaryRing : binaryRings)
+        if (binaryRing->closed.load(std::memory_order_acquire))
+            delete binaryRing;
+}
+
+void QQDommy::RingLogger::LoadConfig(const std::string &path)
+{
+    std::vector<ConfigElement> loaded;
+    LoggerConfig::load(path, *this, &loaded);
+    for (ConfigElement &element : loaded)
+    {
+        if (element.time)
+            AppendElement(std::move(element.time));
+        else
+            AppendElement(std::move(element.constant));
+    }
+}
+
+void QQDommy::RingLogger::AppendElement(std::unique_ptr<RecordTimeElement> element)
+{
+    elements.push_back(element.get());
+    timeElements.push_back(std::move(element));
+    CompileLayout();
+}
+
+void QQDommy::RingLogger::AppendElement(std::unique_ptr<LogCPP::ConstantStringElement> element)
+{
+    elements.push_back(element.get());
+    constantElements.push_back(std::move(element));
+    CompileLayout();
+}
+
+void QQDommy::RingLogger::CompileLayout()
+{
+    LogCPP::BaseElement *levelElements[LEVEL_COUNT];
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+        levelElements[i] = levelMap[(LogCPP::LEVELS)i];
+    layout.compile(levelElements, elements);
+}
+
+void QQDommy::RingLogger::FlushStreams(bool sync)
+{
+    if (scannedStreams != streams.size())
+    {
+        batchedStreams.clear();
+        for (LogCPP::BaseStream *stream : streams)
+        {
+            BatchedStream *batched = dynamic_cast<BatchedStream *>(stream);
+            if (batched != nullptr)
+                batchedStreams.push_back(batched);
+        }
+        scannedStreams = streams.size();
+    }
+    for (BatchedStream *stream : batchedStreams)
+    {
+        if (sync)
+            stream->sync();
+        else
+            stream->poll();
+    }
+}
+
+void QQDommy::RingLogger::Write(LogCPP::LEVELS level, uint64_t ticks, const char *msg, size_t length)
+{
+    line.clear();
+    layout.render(line, level, calibration.toRealtimeNs(ticks), msg, length);
+    for (LogCPP::BaseStream *stream : streams)
+        *stream << line;
+}
+
+void QQDommy::RingLogger::Enqueue(LogCPP::LEVELS level, const char *msg, size_t length)
+{
+    const OverflowPolicy &policy = policies[level];
+    LogCPP::LEVELS oldest;
+    switch (policy.policy)
+    {
+    case POLICY_BLOCK:
+        ring.push(level, msg, length);
+        return;
+    case POLICY_SAMPLE:
+        if (ring.size() >= ring.getCapacity() / 2 &&
+            sampled[level].fetch_add(1, std::memory_order_relaxed) % policy.every >= policy.keep)
+        {
+            dropped[level].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // a message kept by the sample is still dropped by a full ring
+        [[fallthrough]];
+    case POLICY_DROP_NEWEST:
+        if (!ring.tryPush(level, msg, length))
+            dropped[level].fetch_add(1, std::memory_order_relaxed);
+        return;
+    case POLICY_DROP_OLDEST:
+        while (!ring.tryPush(level, msg, length))
+            if (ring.discardOldest(oldest))
+                dropped[oldest].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+}
+
+void QQDommy::RingLogger::ReportDrops(uint64_t ticks)
+{
+    uint64_t total = 0;
+    std::string detail;
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+    {
+        uint64_t count = dropped[i].load(std::memory_order_relaxed);
+        uint64_t delta = count - reported[i];
+        reported[i] = count;
+        if (delta == 0)
+            continue;
+        total += delta;
+        detail += detail.empty() ? "" : ", ";
+        detail += LogFilter::levelName((LogCPP::LEVELS)i);
+        detail += ' ';
+        detail += std::to_string(delta);
+    }
+    if (total == 0)
+        return;
+    std::string text = "log queue dropped " + std::to_string(total) + " messages (" + detail +
+                       "), high water " + std::to_string(ring.getHighWater()) + "/" + std::to_string(ring.getCapacity());
+    Write(LogCPP::WARNING, ticks, text.data(), text.size());
+}
+
+size_t QQDommy::RingLogger::DrainBinary()
+{
+    {
+        // only the list is copied under the lock, the attaching threads never wait for the streams
+        std::lock_guard<std::mutex> lock(binaryMutex);
+        if (binaryRings.empty())
+            return 0;
+        binaryDraining.assign(binaryRings.begin(), binaryRings.end());
+    }
+    // the rings are only removed here, those of the copy stay alive until the end
+    binaryBatch.clear();
+    binaryEnds.resize(binaryDraining.size());
+    std::vector<bool> closing(binaryDraining.size());
+    for (size_t i = 0; i < binaryDraining.size(); i++)
+    {
+        // read before the records, a closed ring has published everything
+        closing[i] = binaryDraining[i]->closed.load(std::memory_order_acquire);
+        binaryEnds[i] = binaryDraining[i]->peek([this](const BinaryRecordHeader &header, const uint8_t *args, size_t length)
+                                             { binaryBatch.push_back({header.ticks, BinaryLog::getFormat(header.formatId), args, length}); });
+    }
+    // the threads are merged, but only within the batch
+    std::stable_sort(binaryBatch.begin(), binaryBatch.end(), [](const BinaryEntry &a, const BinaryEntry &b)
+                     { return a.ticks < b.ticks; });
+    for (const BinaryEntry &entry : binaryBatch)
+    {
+        if (entry.format == nullptr)
+            continue;
+        binaryText.clear();
+        BinaryLog::format(binaryText, entry.format->format, entry.args, entry.length);
+        Write(entry.format->level, entry.ticks, binaryText.data(), binaryText.size());
+    }
+    size_t finished = 0;
+    for (size_t i = 0; i < binaryDraining.size(); i++)
+    {
+        binaryDraining[i]->release(binaryEnds[i]);
+        if (closing[i] && binaryDraining[i]->empty())
+            binaryDraining[finished++] = binaryDraining[i];
+    }
+    binaryDraining.resize(finished);
+    if (finished > 0)
+    {
+        std::lock_guard<std::mutex> lock(binaryMutex);
+        binaryRings.erase(std::remove_if(binaryRings.begin(), binaryRings.end(), [this](BinaryLogRing *binaryRing)
+                                         { return std::find(binaryDraining.begin(), binaryDraining.end(), binaryRing) != binaryDraining.end(); }),
+                          binaryRings.end());
+    }
+    for (BinaryLogRing *binaryRing : binaryDraining)
+        delete binaryRing;
+    return binaryBatch.size();
+}
+
+void QQDommy::RingLogger::Run()
+{
+    auto write = [this](LogCPP::LEVELS level, uint64_t ticks, const char *msg, size_t length)
+    { Write(level, ticks, msg, length); };
+    calibration = TscClock::calibrate();
+    calibratedAt = summaryAt = TscClock::now();
+    unsigned idle = 0;
+    while (true)
+    {
+        // follow the drift of the counter against the wall clock
+        uint64_t now = TscClock::now();
+        if ((double)(now - calibratedAt) * calibration.nsPerTick > 1e9)
+        {
+            calibration = TscClock::calibrate();
+            calibratedAt = now;
+        }
+        if (summaryMs > 0 && (double)(now - summaryAt) * calibration.nsPerTick > summaryMs * 1e6)
+        {
+            ReportDrops(now);
+            summaryAt = now;
+        }
+        // bounded so a storm can not keep the daemon from the summary
+        if (ring.drain(write, ring.getCapacity()) + DrainBinary() > 0)
+        {
+            idle = 0;
+            continue;
+        }
+        // a busy producer usually pushes again soon, sleeping at once would cost it a wake up each time
+        if (++idle < LOG_DAEMON_SPINS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+        // the stop flag is read before the last drain, nothing submitted before SafeDelete is lost
+        if (shouldStop.load(std::memory_order_acquire))
+        {
+            ring.drain(write);
+            DrainBinary();
+            ReportDrops(TscClock::now());
+            return;
+        }
+        FlushStreams(false);
+        // the binary producers wake the daemon through the text ring as well
+        ring.wait(LOG_DAEMON_IDLE_MS, [this]()
+                  { return BinaryPending(); });
+    }
+}
+
+void QQDommy::RingLogger::Log(LogCPP::LEVELS level, const std::string &msg)
+{
+    if (!stopped.load(std::memory_order_acquire))
+    {
+        Start();
+        Enqueue(level, msg.data(), msg.size());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(directMutex);
+    Write(level, TscClock::now(), msg.data(), msg.size());
+    FlushStreams(true);
+}
+
+void QQDommy::RingLogger::AttachBinary(BinaryLogRing *ring)
+{
+    Start();
+    std::lock_guard<std::mutex> lock(binaryMutex);
+    if (stopped.load(std::memory_order_acquire))
+        ring->abandoned.store(true, std::memory_order_release);
+    else
+        ring->consumer.store(&this->ring, std::memory_order_release);
+    binaryRings.push_back(ring);
+}
+
+bool QQDommy::RingLogger::BinaryPending()
+{
+    std::lock_guard<std::mutex> lock(binaryMutex);
+    for (BinaryLogRing *binaryRing : binaryRings)
+        if (!binaryRing->empty())
+            return true;
+    return false;
+}
+
+void QQDommy::RingLogger::SafeDelete()
+{
+    std::lock_guard<std::mutex> lock(directMutex);
+    if (stopped.load(std::memory_order_relaxed))
+        return;
+    // a logger never started has no daemon to stop, a later Start does nothing
+    std::call_once(startOnce, []() {});
+    if (daemon.joinable())
+    {
+        shouldStop.store(true, std::memory_order_release);
+        ring.notify();
+        daemon.join();
+    }
+    stopped.store(true, std::memory_order_release);
+    // messages pushed while the daemon was leaving
+    ring.drain([this](LogCPP::LEVELS level, uint64_t ticks, const char *msg, size_t length)
+               { Write(level, ticks, msg, length); });
+    DrainBinary();
+    FlushStreams(true);
+    // the binary records logged from now on are dropped
+    std::lock_guard<std::mutex> binaryLock(binaryMutex);
+    for (BinaryLogRing *binaryRing : binaryRings)
+    {
+        binaryRing->consumer.store(nullptr, std::memory_order_release);
+        binaryRing->abandoned.store(true, std::memory_order_release);
+    }
+}
+
+const QQDommy::LogRing &QQDommy::RingLogger::getRing() const
+{
+    return ring;
+}
+
+QQDommy::LogQueueStats QQDommy::RingLogger::GetStats() const
+{
+    LogQueueStats stats;
+    stats.enqueued = ring.getEnqueued();
+    stats.flushed = ring.getDrained();
+    for (size_t i = 0; i < LEVEL_COUNT; i++)
+    {
+        stats.droppedLevels[i] = dropped[i].load(std::memory_order_relaxed);
+        stats.dropped += stats.droppedLevels[i];
+    }
+    stats.highWater = ring.getHighWater();
+    stats.capacity = ring.getCapacity();
+    return stats;
+}
+
+LogCPP::BaseLogger &QQDommy::RingLogger::GetInstance()
+{
+    // the daemon starts once the config is loaded, it never sees a half loaded config
+    static std::once_flag once;
+    std::call_once(once, []()
+                   {
+        std::string path = configPath.empty() ? "logger.json" : configPath;
+        RingLogger *logger = new RingLogger(LoggerConfig::loadQueue(path));
+        logger->LoadConfig(path);
+        logger->Start();
+        instance = logger; });
+    return *instance;
+}
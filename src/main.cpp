@@ -2,16 +2,89 @@
 #include "Global.h"
 #include "utils/ByteBuffer.h"
 #include "encrypt/Md5.h"
+#include "encrypt/Zlib.h"
 #include "core/Tlv.h"
+#include "net/EventLoop.h"
+#include "net/Connection.h"
+#include "net/Acceptor.h"
+#include "core/Frame.h"
+#include "core/Multiplexer.h"
+#include "net/ShardedRuntime.h"
+#include "core/Task.h"
+#include "core/Request.h"
+#include "core/PacketTrace.h"
+#include "core/SessionStore.h"
+#include "net/Executor.h"
+#include "core/EventBus.h"
+#include "mock/MockServer.h"
+#include "mock/LoadGenerator.h"
+#include "log/RingLogger.h"
+#include "json/JsonDocument.h"
+#include "json/JsonReader.h"
+#include "json/JsonWriter.h"
+#include "utils/MetricsExport.h"
+#include "utils/Tracing.h"
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
 
 void test_buffer();
 void test_md5();
 void test_vistor();
+void test_connection();
+void test_multiplexer();
+void test_runtime();
+void test_timer();
+void test_coroutine();
+void test_trace();
+void test_mock();
+void test_logger();
+void test_log_filter();
+void test_binary_log();
+void test_batched_stream();
+void test_log_policy();
+void test_json_document();
+void test_json_reader();
+void test_json_writer();
+void test_metrics();
+void test_tracing();
+void test_zlib();
+void test_string();
+void test_session();
+void test_hex();
+void test_cork();
+void test_executor();
+void test_event_bus();
 
 int main(int args, char **argv)
 {
     DEBUG_ASYN("test started");
+    test_buffer();
     test_md5();
+    test_connection();
+    test_multiplexer();
+    test_runtime();
+    test_timer();
+    test_coroutine();
+    test_trace();
+    test_mock();
+    test_logger();
+    test_log_filter();
+    test_binary_log();
+    test_batched_stream();
+    test_log_policy();
+    test_json_document();
+    test_json_reader();
+    test_json_writer();
+    test_metrics();
+    test_tracing();
+    test_zlib();
+    test_string();
+    test_session();
+    test_hex();
+    test_cork();
+    test_executor();
+    test_event_bus();
 
     CLEAN_UP
     return 0;
@@ -24,6 +97,11 @@ void test_buffer()
     b.writeHexString("1A 2B 3C 4D");
     c.writeBuffer(b);
     DEBUG_ASYN(c.toHexString());
+    // the source lies in the buffer growing under it
+    ByteBuffer self(4);
+    self.writeHexString("1A 2B 3C 4D");
+    self.writeBytes(self.readPointer(), self.readableBytes());
+    DEBUG_ASYN(self.toHexString());
 }
 
 void test_md5() {
@@ -40,3 +118,833 @@ void test_vistor()
     b.doVisit(p).doVisit(p);
     DEBUG_ASYN(b.toHexString());
 }
+
+void test_connection()
+{
+    using namespace QQDommy;
+    // the loopback stand-in server echos everything back
+    class EchoHandler : public ConnectionHandler
+    {
+    public:
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            conn.send(input);
+        }
+    };
+    // the client sends a packet and stops the loop once it is echoed
+    class ClientHandler : public ConnectionHandler
+    {
+    public:
+        ByteBuffer received;
+        void onConnected(Connection &conn) override
+        {
+            ByteBuffer b;
+            b.writeHexString("1A 2B 3C 4D").write_uint32(0xdeadbeef);
+            conn.send(b);
+        }
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            received.writeBuffer(input);
+            if (received.readableBytes() == 8)
+                conn.getLoop().stop();
+        }
+    };
+
+    EventLoop loop;
+    EchoHandler echo;
+    Connection server(loop, echo);
+    Acceptor acceptor(loop, [&server](int fd)
+                      { server.adopt(fd); });
+    uint16_t port = acceptor.listen("127.0.0.1", 0);
+
+    ClientHandler client;
+    Connection conn(loop, client);
+    conn.connect("127.0.0.1", port);
+    loop.run();
+    DEBUG_ASYN(client.received.toHexString());
+}
+
+void test_multiplexer()
+{
+    using namespace QQDommy;
+    SequenceMultiplexer mux;
+    uint32_t first = mux.nextSequence(), second = mux.nextSequence(), lost = mux.nextSequence();
+    std::future<ByteBuffer> firstResult = mux.expect(first, 1000);
+    mux.expect(second, [](REQUEST_STATUS status, Frame *frame)
+               { DEBUG_ASYN("second responded : " + frame->payload.toHexString()); },
+               1000);
+    mux.expect(lost, [](REQUEST_STATUS status, Frame *frame)
+               { DEBUG_ASYN(status == TIMED_OUT ? "lost timed out" : "lost not timed out"); },
+               1);
+    bool duplicate = mux.expect(second, [](REQUEST_STATUS, Frame *) {}, 1000);
+    DEBUG_ASYN(std::string("duplicate sequence ") + (duplicate ? "registered" : "refused"));
+
+    // the responses come back out of order in one stream
+    ByteBuffer stream;
+    uint8_t a[] = {0x1A, 0x2B}, b[] = {0x3C};
+    FrameCodec::encode(stream, second, 1, b, sizeof(b));
+    FrameCodec::encode(stream, first, 1, a, sizeof(a));
+    Frame frame;
+    while (FrameCodec::decode(stream, frame))
+        mux.dispatch(frame);
+    DEBUG_ASYN("first responded : " + firstResult.get().toHexString());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    mux.expire();
+    DEBUG_ASYN("pending after expire : " + std::to_string(mux.pendingCount()));
+}
+
+void test_runtime()
+{
+    using namespace QQDommy;
+    ShardedRuntime runtime;
+    runtime.start();
+    const uint64_t accounts = 10000;
+    std::atomic<uint64_t> misplaced{0}, done{0};
+    for (uint64_t uin = 10000; uin < 10000 + accounts; uin++)
+    {
+        runtime.submit(uin, [&runtime, &misplaced, &done, uin](Shard &shard)
+                       {
+            // every account must run on the thread of its own shard
+            if (Shard::current() != &shard || runtime.shardIndexOf(uin) != shard.getIndex())
+                misplaced++;
+            ByteBuffer b = shard.getPool().acquire();
+            b.write_uint64(uin);
+            shard.getPool().release(std::move(b));
+            done++; });
+    }
+    while (done.load() < accounts)
+        std::this_thread::yield();
+    runtime.stop();
+    DEBUG_ASYN("shards : " + std::to_string(runtime.size()) + " misplaced : " + std::to_string(misplaced.load()));
+}
+
+void test_timer()
+{
+    using namespace QQDommy;
+    EventLoop loop;
+    int heartbeats = 0;
+    TimerId never = loop.runAfter(20, []()
+                                  { DEBUG_ASYN("cancelled timer fired"); });
+    loop.cancelTimer(never);
+    TimerId heartbeat = loop.runEvery(10, [&heartbeats]()
+                                      { heartbeats++; });
+    loop.runAfter(55, [&]()
+                  {
+        loop.cancelTimer(heartbeat);
+        loop.stop(); });
+    loop.run();
+    DEBUG_ASYN("heartbeats : " + std::to_string(heartbeats));
+}
+
+void test_coroutine()
+{
+    using namespace QQDommy;
+    // the stand-in server answers every command but 3
+    class ServerHandler : public ConnectionHandler
+    {
+    public:
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            Frame frame;
+            while (FrameCodec::decode(input, frame))
+            {
+                if (frame.command == 3)
+                    continue;
+                ByteBuffer reply;
+                FrameCodec::encode(reply, frame.sequence, frame.command, frame.payload.readPointer(), frame.payload.readableBytes());
+                conn.send(reply);
+            }
+        }
+    };
+
+    EventLoop loop;
+    ServerHandler serverHandler;
+    Connection server(loop, serverHandler);
+    Acceptor acceptor(loop, [&server](int fd)
+                      { server.adopt(fd); });
+    uint16_t port = acceptor.listen("127.0.0.1", 0);
+
+    SequenceMultiplexer mux;
+    FrameDispatcher dispatcher(mux);
+    Connection conn(loop, dispatcher);
+    conn.connect("127.0.0.1", port);
+
+    // a connection whose peer is gone, the first send fails at once and closes it
+    int pair[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, pair);
+    SequenceMultiplexer brokenMux;
+    FrameDispatcher brokenDispatcher(brokenMux);
+    Connection broken(loop, brokenDispatcher);
+    broken.adopt(pair[0]);
+    ::close(pair[1]);
+
+    auto flow = [](EventLoop &loop, Connection &conn, SequenceMultiplexer &mux, Connection &broken, SequenceMultiplexer &brokenMux) -> Task<void>
+    {
+        ByteBuffer password;
+        password.writeHexString("1A 2B");
+        Response first = co_await request(conn, mux, 1, password);
+        DEBUG_ASYN("step 1 : " + first.payload.toHexString());
+        co_await delay(loop, 10);
+        Response second = co_await request(conn, mux, 2, first.payload);
+        DEBUG_ASYN("step 2 : " + second.payload.toHexString());
+        Response lost = co_await request(conn, mux, 3, password, 50);
+        DEBUG_ASYN(lost.status == TIMED_OUT ? "step 3 timed out" : "step 3 not timed out");
+        CancelToken token;
+        token.cancel();
+        Response cancelled = co_await request(conn, mux, 1, password, 1000, &token);
+        DEBUG_ASYN(cancelled.status == CANCELLED ? "step 4 cancelled" : "step 4 not cancelled");
+        // too large for the cork, it is written while the request registers
+        ByteBuffer large;
+        std::vector<uint8_t> zeros(DEFAULT_CORK_BYTES);
+        large.writeBytes(zeros.data(), zeros.size());
+        Response failed = co_await request(broken, brokenMux, 1, large, 1000);
+        DEBUG_ASYN(failed.status == CANCELLED ? "step 5 cancelled by the failed send" : "step 5 not cancelled");
+        loop.stop();
+    };
+    spawn(loop, flow(loop, conn, mux, broken, brokenMux));
+    loop.run();
+}
+
+void test_trace()
+{
+    using namespace QQDommy;
+    {
+        TraceRecorder recorder("test.trace");
+        ByteBuffer stream;
+        uint8_t payload[] = {0x1A, 0x2B, 0x3C};
+        for (uint32_t seq = 1; seq <= 1000; seq++)
+            FrameCodec::encode(stream, seq, 1, payload, sizeof(payload));
+        // the stream arrives in chunks that split the frames
+        while (stream.readableBytes() > 0)
+        {
+            size_t chunk = stream.readableBytes() < 100 ? stream.readableBytes() : 100;
+            recorder.tap(INBOUND, stream.readPointer(), chunk);
+            stream.skip(chunk);
+        }
+    }
+    TraceReplayer replayer("test.trace");
+    uint64_t sum = 0;
+    ReplayStats stats = replayer.replay([&sum](DIRECTION direction, Frame &frame)
+                                        { sum += frame.sequence; });
+    DEBUG_ASYN("replayed " + std::to_string(stats.frames) + " frames, sequence sum " + std::to_string(sum) +
+               ", " + std::to_string((uint64_t)stats.framesPerSecond()) + " frames/s");
+}
+
+void test_mock()
+{
+    using namespace QQDommy;
+    MockServerConfig serverConfig;
+    serverConfig.pushBurst = 2;
+    serverConfig.pushIntervalMs = 5;
+    EventLoop serverLoop;
+    MockServer server(serverLoop, serverConfig);
+
+    LoadConfig load;
+    load.clients = 10;
+    load.messagesPerClient = 20;
+    load.port = server.listen(load.ip, 0);
+    std::thread serverThread([&serverLoop]()
+                             { serverLoop.run(); });
+
+    EventLoop clientLoop;
+    LoadGenerator generator(clientLoop, load);
+    LoadReport report = generator.run();
+    serverLoop.stop();
+    serverThread.join();
+    DEBUG_ASYN(report.toString());
+    DEBUG_ASYN("server logins " + std::to_string(server.getStats().logins.load()) +
+               ", messages " + std::to_string(server.getStats().messages.load()));
+}
+
+void test_logger()
+{
+    using namespace QQDommy;
+    // counts the lines and checks every thread is written in order
+    class CheckStream : public BaseStream
+    {
+    public:
+        size_t lines = 0, disordered = 0;
+        std::vector<long> last = std::vector<long>(4, -1);
+        BaseStream &operator<<(const std::string &content) override
+        {
+            size_t at = content.find('#');
+            int thread = content[at + 1] - '0';
+            long index = atol(content.c_str() + at + 3);
+            if (index != last[thread] + 1)
+                disordered++;
+            last[thread] = index;
+            lines++;
+            return *this;
+        }
+    };
+    CheckStream *check = new CheckStream();
+    {
+        // a small ring so the producers have to wait for the daemon
+        RingLogger logger(64);
+        logger.AddStream(check);
+        logger.Start();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++)
+            threads.emplace_back([&logger, t]()
+                                 {
+                // every 100th message does not fit into a slot
+                std::string padding(300, '.');
+                for (int i = 0; i < 10000; i++)
+                    logger.Log(INFO, "#" + std::to_string(t) + " " + std::to_string(i) + (i % 100 == 0 ? padding : "")); });
+        for (std::thread &thread : threads)
+            thread.join();
+        logger.SafeDelete();
+        DEBUG_ASYN("ring logger lines " + std::to_string(check->lines) + ", disordered " + std::to_string(check->disordered));
+    }
+}
+
+void test_log_filter()
+{
+    using namespace QQDommy;
+    int evaluated = 0;
+    auto expensive = [&evaluated]()
+    {
+        evaluated++;
+        return std::string("evaluated");
+    };
+    LEVELS previous = LogFilter::getMinimum();
+    LogFilter::setMinimum(WARNING);
+    DEBUG_ASYN(expensive());
+    INFO_STREAM("stream " << expensive());
+    DEBUG_FORMAT("format %s", expensive().c_str());
+    LogFilter::setMinimum(previous);
+    DEBUG_STREAM("filtered messages evaluated " << evaluated << " times, seq " << 42u << " ratio " << 0.5);
+    DEBUG_FORMAT("format %s %d", "works", 7);
+}
+
+void test_binary_log()
+{
+    using namespace QQDommy;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; t++)
+        threads.emplace_back([t]()
+                             {
+            for (int i = 0; i < 3; i++)
+                DEBUG_BIN("binary thread %d message %d : %s %.2f 0x%llx", t, i, "text", i * 0.5, 0xdeadbeefULL); });
+    for (std::thread &thread : threads)
+        thread.join();
+    DEBUG_BIN("binary [%5s] [%-5d] [%*u] 100%%", "ab", 42, 4, 7u);
+}
+
+void test_batched_stream()
+{
+    using namespace QQDommy;
+    FileRotation rotation;
+    rotation.maxBytes = 256 * 1024;
+    rotation.maxFiles = 2;
+    uint64_t lines, writes;
+    {
+        BatchedFileStream stream("test_batched.log", rotation);
+        std::string line(100, 'x');
+        for (int i = 0; i < 100000; i++)
+            stream << line;
+        stream.sync();
+        lines = stream.getLines();
+        writes = stream.getWriteCalls();
+    }
+    DEBUG_ASYN("batched stream : " + std::to_string(lines) + " lines in " + std::to_string(writes) + " writes");
+}
+
+void test_log_policy()
+{
+    using namespace QQDommy;
+    // stands for a slow disk, the ring fills up at once
+    class SlowStream : public BaseStream
+    {
+    public:
+        size_t lines = 0;
+        BaseStream &operator<<(const std::string &content) override
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            lines++;
+            return *this;
+        }
+    };
+    SlowStream *slow = new SlowStream();
+    LogQueueConfig config;
+    config.capacity = 64;
+    config.policies[DEBUG] = {POLICY_SAMPLE, 1, 4};
+    config.policies[INFO].policy = POLICY_DROP_NEWEST;
+    config.policies[WARNING].policy = POLICY_DROP_OLDEST;
+    RingLogger logger(config);
+    logger.AddStream(slow);
+    logger.Start();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3000; i++)
+        logger.Log((LEVELS)(i % 3), "storm " + std::to_string(i));
+    auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    logger.SafeDelete();
+    LogQueueStats stats = logger.GetStats();
+    DEBUG_ASYN("log policy : " + std::to_string(spent) + " ms to log, enqueued " + std::to_string(stats.enqueued) +
+               ", flushed " + std::to_string(stats.flushed) + ", dropped debug " + std::to_string(stats.droppedLevels[DEBUG]) +
+               " info " + std::to_string(stats.droppedLevels[INFO]) + " warning " + std::to_string(stats.droppedLevels[WARNING]) +
+               ", high water " + std::to_string(stats.highWater) + "/" + std::to_string(stats.capacity) + ", lines " + std::to_string(slow->lines));
+}
+
+void test_json_document()
+{
+    using namespace QQDommy;
+    std::string text = R"({"uin": 10001, "nick": "max\twell \u4e2d\ud83d\ude00", "ratio": -1.5e2,
+        "online": true, "groups": [1, 2, {"id": 3}], "remark": null, "empty": {}})";
+    JsonDocument document;
+    const JsonValue &root = document.parse(text);
+    std::string nick(root["nick"].asString());
+    DEBUG_ASYN("json document : uin " + std::to_string(root["uin"].asInteger()) + ", nick " + nick +
+               " (" + std::to_string(nick.size()) + " bytes), ratio " + std::to_string(root["ratio"].asFloat()) +
+               ", online " + std::to_string(root["online"].asBoolean()) + ", group " + std::to_string(root["groups"][2]["id"].asInteger()) +
+               ", missing " + std::to_string(root["missing"]["deeper"].asInteger(-1)) + ", arena " + std::to_string(document.getArenaUsed()));
+    try
+    {
+        document.parse("{\"broken\": [1, 2}");
+    }
+    catch (const JsonParseException &e)
+    {
+        DEBUG_ASYN(std::string("json document : ") + e.what());
+    }
+}
+
+void test_json_reader()
+{
+    using namespace QQDommy;
+    std::string text = R"({"result": 0, "friends": [{"uin": 10001, "nick": "a\"b", "tags": [1, [2]]},
+        {"uin": 10002, "nick": "c", "tags": {"x": 1}}], "next": "cursor"})";
+    JsonReader reader;
+    size_t fed = 0, chunks = 0;
+    std::string picked;
+    while (true)
+    {
+        JSON_EVENT event = reader.next();
+        if (event == JSON_EVENT_MORE)
+        {
+            // the chunks split every token somewhere
+            ByteBuffer chunk;
+            size_t length = std::min((size_t)5, text.size() - fed);
+            chunk.writeBytes(text.data() + fed, length);
+            reader.feed(chunk);
+            fed += length;
+            chunks++;
+            continue;
+        }
+        if (event == JSON_EVENT_END)
+            break;
+        if (event == JSON_EVENT_KEY && reader.text() == "tags")
+            reader.skip();
+        else if (event == JSON_EVENT_INTEGER || event == JSON_EVENT_STRING)
+            picked += std::string(reader.text()) + " ";
+    }
+    DEBUG_ASYN("json reader : " + picked + "in " + std::to_string(chunks) + " chunks");
+}
+
+void test_json_writer()
+{
+    using namespace QQDommy;
+    JsonDocument extra;
+    extra.parse(R"({"note": "from \"parser\"", "list": [1, 2.5, null]})");
+    ByteBuffer out;
+    JsonWriter writer(out);
+    writer.beginObject()
+        .field("uin", 10001u)
+        .field("nick", "max\twell")
+        .field("online", true)
+        .field("latency", 1.25)
+        .field("balance", -42)
+        .key("groups")
+        .beginArray().value(1).value(2).endArray()
+        .field("extra", extra.root())
+        .field("a1", 1).field("a2", 2).field("a3", 3)
+        .endObject();
+    std::string text((const char *)out.readPointer(), out.readableBytes());
+    // the object has more than JSON_INDEX_MEMBERS members, the lookups use the index
+    JsonDocument document;
+    const JsonValue &root = document.parse(text);
+    DEBUG_ASYN("json writer : " + text);
+    DEBUG_ASYN("json writer : read back uin " + std::to_string(root["uin"].asInteger()) + ", a3 " + std::to_string(root["a3"].asInteger()) +
+               ", note " + std::string(root["extra"]["note"].asString()) + ", missing " + std::to_string(root["zz"].isValid()));
+}
+
+void test_metrics()
+{
+    using namespace QQDommy;
+    static const Counter events("test_events_total", "events counted by the test");
+    static const Histogram sizes("test_sizes", "sizes recorded by the test");
+    static const Gauge open("test_open", "a gauge set by the test");
+    // a thread that exits hands its counts to the totals
+    std::thread worker([]
+                       {
+        for (int i = 0; i < 1000; i++)
+            events.add(); });
+    worker.join();
+    for (uint64_t i = 1; i <= 100; i++)
+        sizes.record(i);
+    events.add(5);
+    open.set(3);
+    ByteBuffer b;
+    FrameCodec::encode(b, 1, 2, (const uint8_t *)"ping", 4);
+    Frame frame;
+    FrameCodec::decode(b, frame);
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    for (const CounterSnapshot &counter : snapshot.counters)
+        if (counter.name == "test_events_total")
+            DEBUG_ASYN("metrics : events " + std::to_string(counter.value));
+    for (const HistogramSnapshot &histogram : snapshot.histograms)
+        if (histogram.name == "test_sizes" || histogram.name == "frame_decode_ns")
+            DEBUG_ASYN("metrics : " + histogram.name + " count " + std::to_string(histogram.count) + ", p50 " +
+                       std::to_string(histogram.percentile(0.5)) + ", p99 " + std::to_string(histogram.percentile(0.99)));
+    ByteBuffer text;
+    MetricsExport::toPrometheus(snapshot, text);
+    MetricsExport::writeFile("metrics.prom", text);
+    text.clear();
+    MetricsExport::toJson(snapshot, text);
+    DEBUG_ASYN("metrics : " + std::string((const char *)text.readPointer(), text.readableBytes()));
+}
+
+void test_tracing()
+{
+    using namespace QQDommy;
+    // every flow is traced, each thread runs 10 flows of a span and a digest
+    Tracer::setSampling(1);
+    std::thread worker([]
+                       {
+        Tracer::nameThread("tracing worker");
+        for (int i = 0; i < 10; i++)
+        {
+            TraceScope flow("flow");
+            TraceSpan span("work");
+            Md5Processor("admin").digest32();
+        } });
+    worker.join();
+    {
+        TraceScope flow("flow");
+        TraceSpan span("work");
+    }
+    // unsampled, nothing is recorded
+    Tracer::setSampling(0);
+    {
+        TraceScope flow("flow");
+        TraceSpan span("work");
+    }
+    std::vector<TraceEvent> events = Tracer::collect();
+    ByteBuffer out;
+    Tracer::toChrome(events, out);
+    DEBUG_ASYN("tracing : " + std::to_string(events.size()) + " events, " + std::to_string(out.readableBytes()) +
+               " bytes of trace, worker ring freed " + std::to_string(Tracer::collect().size() == 2));
+}
+
+void test_zlib()
+{
+    using namespace QQDommy;
+    ByteBuffer plain, compressed, inflated;
+    for (int i = 0; i < 20000; i++)
+        plain.writeBytes("a long message from a friend ", 29).write_uint32(i);
+    // compressed in pieces of 1000 bytes, as a stream arrives
+    Deflater deflater;
+    for (size_t offset = 0; offset < plain.readableBytes(); offset += 1000)
+        deflater.deflate(plain.readPointer() + offset, std::min((size_t)1000, plain.readableBytes() - offset), compressed);
+    deflater.finish(compressed);
+    size_t compressedSize = compressed.readableBytes();
+    // inflated from chunks of 4KB into one buffer, with the same inflater twice
+    Inflater inflater;
+    bool same = true;
+    for (int round = 0; round < 2; round++)
+    {
+        inflated.clear();
+        size_t offset = 0;
+        while (!inflater.done() || offset == 0)
+        {
+            size_t chunk = std::min((size_t)4096, compressed.readableBytes() - offset);
+            offset += inflater.inflate(compressed.readPointer() + offset, chunk, inflated);
+        }
+        same = same && inflated.readableBytes() == plain.readableBytes() &&
+               memcmp(inflated.readPointer(), plain.readPointer(), plain.readableBytes()) == 0;
+    }
+    std::string limited = "no";
+    try
+    {
+        ByteBuffer small;
+        Inflater(1000).inflate(compressed.readPointer(), compressed.readableBytes(), small);
+    }
+    catch (const ZlibException &e)
+    {
+        limited = e.what();
+    }
+    DEBUG_ASYN("zlib : " + std::to_string(plain.readableBytes()) + " bytes to " + std::to_string(compressedSize) +
+               ", inflated back " + std::to_string(same) + ", " + limited);
+}
+
+void test_string()
+{
+    using namespace QQDommy;
+    ByteBuffer b;
+    b.writeString<uint16_t>("麦克斯韦").writeString<uint32_t>("a message to the group 你好 😀").writeString<uint8_t>("");
+    // a cut surrogate is no utf-8
+    b.writeString<uint16_t>("\xED\xA0\x80");
+    std::string_view nick = b.readString<uint16_t>(true);
+    std::string_view text = b.readString<uint32_t>(true);
+    std::string_view empty = b.readString<uint8_t>(true);
+    std::string invalid = "no";
+    try
+    {
+        b.readString<uint16_t>(true);
+    }
+    catch (const IllegalStringException &e)
+    {
+        invalid = e.what();
+    }
+    // nothing is consumed by a failed read
+    std::string kept = std::to_string(b.readableBytes());
+    std::string tooLong = "no";
+    try
+    {
+        b.writeString<uint8_t>(std::string(300, 'a'));
+    }
+    catch (const BufferOutOfBoundException &e)
+    {
+        tooLong = e.what();
+    }
+    DEBUG_ASYN("string : " + std::string(nick) + " | " + std::string(text) + " | " + std::to_string(empty.size()) +
+               " | " + invalid + " with " + kept + " bytes kept | " + tooLong + " | simd " + std::to_string(Utf8::vectorized()));
+}
+
+void test_session()
+{
+    using namespace QQDommy;
+    const char *path = "session_test.store";
+    ::remove(path);
+    uint32_t used = 0, reusedFrom = 0;
+    bool reusedKept = false;
+    const uint8_t key[TEA_KEY_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    {
+        SessionStore store(path, 4);
+        SessionState state;
+        state.uin = 10001;
+        state.tgtLength = 3;
+        memcpy(state.tgt, "tgt", 3);
+        memcpy(state.sessionKey, key, TEA_KEY_SIZE);
+        store.save(state);
+        state.uin = 10002;
+        store.save(state);
+        // a login replaces the session in place
+        state.tgtLength = 2;
+        store.save(state);
+        store.remove(10001);
+        SequenceMultiplexer mux;
+        mux.bindSequence(store.sequence(10002));
+        mux.nextSequence();
+        used = mux.nextSequence();
+        // the slot of a removed account is reused while its multiplexer is still bound
+        state.uin = 10003;
+        store.save(state);
+        SequenceMultiplexer former;
+        former.bindSequence(store.sequence(10003));
+        reusedFrom = former.nextSequence();
+        store.remove(10003);
+        state.uin = 10004;
+        store.save(state);
+        reusedKept = store.sequence(10004).load() >= reusedFrom && former.nextSequence() > reusedFrom;
+        store.remove(10004);
+    }
+    // the restart resumes the session and its sequence
+    SessionStore store(path, 4);
+    SessionState resumed;
+    bool found = store.load(10002, resumed);
+    SequenceMultiplexer mux;
+    mux.bindSequence(store.sequence(10002));
+    uint32_t next = mux.nextSequence();
+    std::string locked = "no";
+    try
+    {
+        SessionStore other(path);
+    }
+    catch (const SessionStoreException &e)
+    {
+        locked = e.what();
+    }
+    DEBUG_ASYN("session : " + std::to_string(store.size()) + " sessions, 10002 found " + std::to_string(found) +
+               " tgt " + std::to_string(resumed.tgtLength) + " key kept " +
+               std::to_string(memcmp(resumed.sessionKey, key, TEA_KEY_SIZE) == 0) +
+               ", sequence " + std::to_string(used) + " then " + std::to_string(next) +
+               ", reused slot kept " + std::to_string(reusedKept) + ", " + locked);
+}
+
+void test_hex()
+{
+    using namespace QQDommy;
+    constexpr auto signature = "A6 B7 45 bf 24 A2 C2 77 52 77 16 F6 F3 6E B6 8D"_hex;
+    static_assert(signature.size() == 16 && signature[3] == 0xBF);
+    ByteBuffer constant, parsed;
+    constant.writeBytes(signature).writeBytes("00 01 00 02"_hex);
+    parsed.writeHexString("A6 B7 45 BF 24 A2 C2 77 52 77 16 F6 F3 6E B6 8D 00 01 00 02");
+    bool same = constant.readableBytes() == parsed.readableBytes() &&
+                memcmp(constant.readPointer(), parsed.readPointer(), parsed.readableBytes()) == 0;
+    std::string illegal = "no";
+    try
+    {
+        parsed.writeHexString("1A 2");
+    }
+    catch (const IllegalHexExprException &e)
+    {
+        illegal = "yes";
+    }
+    DEBUG_ASYN("hex : " + constant.toHexString() + ", same as parsed " + std::to_string(same) + ", illegal thrown " + illegal);
+}
+
+void test_cork()
+{
+    using namespace QQDommy;
+    // the server answers with a burst of small packets sent one by one
+    class BurstHandler : public ConnectionHandler
+    {
+    public:
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            input.clear();
+            for (uint32_t i = 0; i < 10; i++)
+            {
+                ByteBuffer b;
+                b.write_uint32(i);
+                conn.send(b);
+            }
+        }
+    };
+    class ClientHandler : public ConnectionHandler
+    {
+    public:
+        ByteBuffer received;
+        void onConnected(Connection &conn) override
+        {
+            ByteBuffer b;
+            b.write_uint8(1);
+            conn.send(b);
+        }
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            received.writeBuffer(input);
+            if (received.readableBytes() == 40)
+                conn.getLoop().stop();
+        }
+    };
+
+    EventLoop loop;
+    BurstHandler burst;
+    Connection server(loop, burst);
+    Acceptor acceptor(loop, [&server](int fd)
+                      { server.adopt(fd); });
+    uint16_t port = acceptor.listen("127.0.0.1", 0);
+    ClientHandler client;
+    Connection conn(loop, client);
+    conn.connect("127.0.0.1", port);
+    loop.run();
+    bool ordered = true;
+    for (uint32_t i = 0; i < 10; i++)
+        ordered = ordered && client.received.read_uint32Be() == i;
+    const SendStats &stats = server.getSendStats();
+    DEBUG_ASYN("cork : " + std::to_string(stats.packets) + " packets in " + std::to_string(stats.syscalls) +
+               " syscalls, in order " + std::to_string(ordered));
+}
+
+void test_executor()
+{
+    using namespace QQDommy;
+    const size_t sessions = 64, packets = 200;
+    std::vector<std::vector<size_t>> orders(sessions);
+    std::atomic<size_t> children{0};
+    EventLoop loop;
+    ByteBuffer echoed;
+    {
+        Executor executor(4);
+        // the packets of one session are handled in order, on whatever worker
+        for (size_t i = 0; i < packets; i++)
+            for (size_t session = 0; session < sessions; session++)
+                executor.submit(10000 + session, [&orders, session, i]()
+                                { orders[session].push_back(i); });
+        // a job submitting jobs keeps them on its worker for the others to steal
+        for (size_t i = 0; i < 100; i++)
+            executor.submit([&executor, &children]()
+                            {
+                for (size_t k = 0; k < 10; k++)
+                    executor.submit([&children]() { children.fetch_add(1); }); });
+        // the buffer moves to a worker and back to the loop without a copy
+        ByteBuffer payload;
+        payload.write_uint32(0xdeadbeef);
+        const uint8_t *bytes = payload.readPointer();
+        bool same = false;
+        executor.offload(10000, loop, [payload = std::move(payload)]() mutable
+                         { return std::move(payload); },
+                         [&loop, &echoed, &same, bytes](ByteBuffer buffer)
+                         {
+                same = buffer.readPointer() == bytes;
+                echoed = std::move(buffer);
+                loop.stop(); });
+        loop.run();
+        DEBUG_ASYN("executor offload kept the bytes in place " + std::to_string(same));
+    }
+    bool ordered = true;
+    for (auto &order : orders)
+        for (size_t i = 0; i < packets; i++)
+            ordered = ordered && order.size() == packets && order[i] == i;
+    DEBUG_ASYN("executor : in order " + std::to_string(ordered) + ", children " + std::to_string(children.load()) +
+               ", echoed " + echoed.toHexString());
+}
+
+void test_event_bus()
+{
+    using namespace QQDommy;
+    // checks the order and the content of the messages, read in place
+    class MessageHandler : public BusHandler
+    {
+    public:
+        uint64_t next = 0;
+        size_t read = 0;
+        bool ordered = true;
+        void onEvent(const BusEvent &event) override
+        {
+            uint64_t uin = event.payload.read_uint64Be();
+            std::string_view text = event.payload.readString<uint16_t>();
+            ordered = ordered && event.payload.readOnly() && (next == 0 || uin == next) && text == "message " + std::to_string(uin);
+            next = uin + 1;
+            read++;
+        }
+    };
+    const std::string name = "/qqdommy-test-events";
+    EventPublisher::unlink(name);
+    std::string result;
+    {
+        EventPublisher publisher(name, 4096);
+        EventSubscriber fast(name), slow(name);
+        MessageHandler fastHandler, slowHandler;
+        ByteBuffer message;
+        for (uint64_t uin = 1; uin <= 1000; uin++)
+        {
+            message.clear();
+            message.write_uint64(uin).writeString<uint16_t>("message " + std::to_string(uin));
+            publisher.publish(1, message);
+            // the slow one reads the first events and the last ones
+            if (uin % 10 == 0)
+                fast.poll(fastHandler);
+            if (uin == 20 || uin == 990 || uin == 1000)
+                slow.poll(slowHandler);
+        }
+        BusStats stats = publisher.getStats();
+        result = "fast read " + std::to_string(fastHandler.read) + " in order " + std::to_string(fastHandler.ordered) +
+                 " lost " + std::to_string(fast.getLost()) + ", slow evicted " + std::to_string(slow.getEvictions()) +
+                 " lost " + std::to_string(slow.getLost()) + " read " + std::to_string(slowHandler.read) +
+                 ", published " + std::to_string(stats.published) + " dropped " + std::to_string(stats.dropped);
+        try
+        {
+            EventPublisher second(name, 4096);
+            result += ", second publisher allowed";
+        }
+        catch (const EventBusException &e)
+        {
+            result += std::string(", ") + e.what();
+        }
+    }
+    EventPublisher::unlink(name);
+    DEBUG_ASYN("bus : " + result);
+}
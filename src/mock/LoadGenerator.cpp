@@ -0,0 +1,282 @@
+#include "mock/LoadGenerator.h"
+#include "mock/MockProtocol.h"
+#include "core/Request.h"
+#include "core/Tlv.h"
+#include "utils/Tracing.h"
+#include <algorithm>
+#include <optional>
+#include <chrono>
+#include <cstdio>
+
+namespace QQDommy
+{
+
+    /// @brief each client only has one request in flight
+    const static size_t CLIENT_PENDING_CAPACITY = 16;
+
+    /**
+     * @brief one simulated qq client, its flow runs as a coroutine on the loop
+     *
+     */
+    class SimulatedClient : public FrameDispatcher
+    {
+    private:
+        LoadGenerator &generator;
+        SequenceMultiplexer clientMux;
+        std::coroutine_handle<> connectWaiter;
+        bool connectDone = false;
+        ByteBuffer ack;
+
+    public:
+        Connection conn;
+        uint64_t uin;
+        std::unique_ptr<TeaCipher> sessionCipher;
+        uint64_t sent = 0, received = 0;
+
+        /**
+         * @brief suspends the flow until the connection is established or failed
+         *
+         */
+        class ConnectAwaiter
+        {
+        private:
+            SimulatedClient &client;
+
+        public:
+            ConnectAwaiter(SimulatedClient &client) : client(client) {}
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                const LoadConfig &config = client.generator.getConfig();
+                client.connectDone = false;
+                try
+                {
+                    client.conn.connect(config.ip, config.port, config.timeoutMs);
+                }
+                catch (const NetworkException &e)
+                {
+                    return false;
+                }
+                // loopback may connect at once
+                if (client.connectDone)
+                    return false;
+                client.connectWaiter = handle;
+                return true;
+            }
+            bool await_resume() const noexcept { return client.conn.getState() == CONNECTED; }
+        };
+
+        SimulatedClient(LoadGenerator &generator, uint64_t uin)
+            : FrameDispatcher(clientMux), generator(generator), clientMux(CLIENT_PENDING_CAPACITY),
+              conn(generator.getLoop(), *this), uin(uin)
+        {
+        }
+
+        void wake()
+        {
+            connectDone = true;
+            if (connectWaiter)
+                std::exchange(connectWaiter, nullptr).resume();
+        }
+
+        void onConnected(Connection & /*conn*/) override
+        {
+            wake();
+        }
+
+        void onMessage(Connection &conn, ByteBuffer &input) override
+        {
+            // count the frames before they are consumed
+            received += countFrames(input);
+            FrameDispatcher::onMessage(conn, input);
+        }
+
+        void onClosed(Connection &conn, int error) override
+        {
+            FrameDispatcher::onClosed(conn, error);
+            wake();
+        }
+
+        void onPush(Connection &conn, Frame &frame) override
+        {
+            if (frame.command != CMD_PUSH_MESSAGE)
+                return;
+            ack.clear();
+            FrameCodec::encode(ack, 0, CMD_PUSH_ACK, nullptr, 0);
+            conn.send(ack);
+            sent++;
+        }
+
+        static uint64_t countFrames(const ByteBuffer &input)
+        {
+            uint64_t frames = 0;
+            const uint8_t *p = input.readPointer();
+            size_t left = input.readableBytes();
+            while (left >= FRAME_HEADER_SIZE)
+            {
+                uint32_t length = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+                if (length < FRAME_HEADER_SIZE || length > left)
+                    break;
+                frames++;
+                p += length;
+                left -= length;
+            }
+            return frames;
+        }
+
+        ConnectAwaiter connect() { return ConnectAwaiter(*this); }
+        SequenceMultiplexer &getMux() { return clientMux; }
+    };
+
+    /**
+     * @brief the whole life of one client
+     *
+     */
+    static Task<void> clientFlow(LoadGenerator &generator, SimulatedClient &client)
+    {
+        const LoadConfig &config = generator.getConfig();
+        SequenceMultiplexer &mux = client.getMux();
+        bool succeeded = false;
+        if (co_await client.connect())
+        {
+            // the flow of the login ends with the session key, every message is a flow of its own
+            std::optional<TraceScope> trace(std::in_place, "login");
+            TeaCipher shareCipher(MOCK_SHARE_KEY.data());
+            ByteBuffer payload;
+            MockProtocol::buildLogin(payload, shareCipher, client.uin, config.password);
+            uint64_t start = LoadGenerator::nowNs();
+            client.sent++;
+            Response login = co_await request(client.conn, mux, CMD_LOGIN, payload, config.timeoutMs);
+            uint8_t key[TEA_KEY_SIZE];
+            bool loggedIn = login.ok() && MockProtocol::parseLoginReply(login.payload, shareCipher, key);
+            trace.reset();
+            if (loggedIn)
+            {
+                generator.recordLatency(start);
+                generator.recordLogin();
+                client.sessionCipher.reset(new TeaCipher(key));
+                succeeded = true;
+
+                payload.clear();
+                client.sent++;
+                start = LoadGenerator::nowNs();
+                Response heartbeat = co_await request(client.conn, mux, CMD_HEARTBEAT, payload, config.timeoutMs);
+                succeeded = heartbeat.ok();
+                if (succeeded)
+                    generator.recordLatency(start);
+
+                static const char TEXT[] = "hello from the load generator";
+                for (size_t i = 0; succeeded && i < config.messagesPerClient; i++)
+                {
+                    TraceScope message("send message");
+                    payload.clear();
+                    MockProtocol::buildSealed(payload, *client.sessionCipher, TLV_MESSAGE,
+                                              (const uint8_t *)TEXT, sizeof(TEXT) - 1);
+                    client.sent++;
+                    start = LoadGenerator::nowNs();
+                    Response ack = co_await request(client.conn, mux, CMD_SEND_MESSAGE, payload, config.timeoutMs);
+                    succeeded = ack.ok();
+                    if (succeeded)
+                        generator.recordLatency(start);
+                }
+            }
+        }
+        client.conn.close();
+        generator.finish(succeeded, client.sent, client.received);
+    }
+
+};
+
+std::string QQDommy::LoadReport::toString() const
+{
+    char line[512];
+    snprintf(line, sizeof(line),
+             "sessions %zu, failed %zu, %.3f s, %.0f logins/s, sent %llu, received %llu, %.0f packets/s, "
+             "latency us p50 %llu p90 %llu p99 %llu p999 %llu max %llu",
+             sessions, failed, seconds, connectionsPerSecond(),
+             (unsigned long long)packetsSent, (unsigned long long)packetsReceived, packetsPerSecond(),
+             (unsigned long long)p50, (unsigned long long)p90, (unsigned long long)p99,
+             (unsigned long long)p999, (unsigned long long)max);
+    return line;
+}
+
+QQDommy::LoadGenerator::LoadGenerator(EventLoop &loop, const LoadConfig &config) : loop(loop), config(config)
+{
+}
+
+QQDommy::LoadGenerator::~LoadGenerator()
+{
+}
+
+uint64_t QQDommy::LoadGenerator::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+QQDommy::LoadReport QQDommy::LoadGenerator::run()
+{
+    report = LoadReport();
+    latencies.clear();
+    latencies.reserve(config.clients * (config.messagesPerClient + 2));
+    clients.clear();
+    for (size_t i = 0; i < config.clients; i++)
+        clients.emplace_back(new SimulatedClient(*this, config.firstUin + i));
+
+    startNs = lastLoginNs = nowNs();
+    running = config.clients;
+    if (running == 0)
+        return report;
+    for (auto &client : clients)
+        spawn(loop, clientFlow(*this, *client));
+    loop.run();
+
+    uint64_t endNs = nowNs();
+    report.seconds = (endNs - startNs) / 1e9;
+    report.loginSeconds = (lastLoginNs - startNs) / 1e9;
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        auto at = [this](double q)
+        { return (uint64_t)latencies[(size_t)(q * (latencies.size() - 1))]; };
+        report.p50 = at(0.5);
+        report.p90 = at(0.9);
+        report.p99 = at(0.99);
+        report.p999 = at(0.999);
+        report.max = latencies.back();
+    }
+    return report;
+}
+
+void QQDommy::LoadGenerator::recordLatency(uint64_t start)
+{
+    latencies.push_back((uint32_t)((nowNs() - start) / 1000));
+}
+
+void QQDommy::LoadGenerator::recordLogin()
+{
+    lastLoginNs = nowNs();
+}
+
+void QQDommy::LoadGenerator::finish(bool succeeded, uint64_t sent, uint64_t received)
+{
+    if (succeeded)
+        report.sessions++;
+    else
+        report.failed++;
+    report.packetsSent += sent;
+    report.packetsReceived += received;
+    if (--running == 0)
+        loop.stop();
+}
+
+const QQDommy::LoadConfig &QQDommy::LoadGenerator::getConfig() const
+{
+    return config;
+}
+
+QQDommy::EventLoop &QQDommy::LoadGenerator::getLoop()
+{
+    return loop;
+}
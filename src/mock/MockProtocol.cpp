@@ -0,0 +1,53 @@
+#include "mock/MockProtocol.h"
+#include "encrypt/Md5.h"
+#include "core/Tlv.h"
+#include "utils/Tracing.h"
+
+void QQDommy::MockProtocol::buildLogin(ByteBuffer &out, TeaCipher &cipher, uint64_t uin, const std::string &password)
+{
+    ByteBuffer plain;
+    ByteBuffer md5 = Md5Processor(password).digest32();
+    {
+        TraceSpan span("tlv encode");
+        plain.doVisit(Uint64TlvPack(TLV_UIN, uin)).doVisit(BytesTlvPack(TLV_PASSWORD_MD5, md5));
+    }
+    cipher.encrypt(out, plain.readPointer(), plain.readableBytes());
+}
+
+bool QQDommy::MockProtocol::parseLoginReply(ByteBuffer &payload, const TeaCipher &cipher, uint8_t *sessionKey)
+{
+    ByteBuffer plain;
+    try
+    {
+        cipher.decrypt(plain, payload.readPointer(), payload.readableBytes());
+    }
+    catch (const TeaDecryptException &e)
+    {
+        return false;
+    }
+    uint16_t tag;
+    ByteBuffer value = ByteBuffer::wrap(nullptr, 0);
+    bool ok = false, hasKey = false;
+    TraceSpan span("tlv parse");
+    while (TlvReader::next(plain, tag, value))
+    {
+        if (tag == TLV_RESULT && value.readableBytes() == 1)
+            ok = value.read_uint8() == LOGIN_OK;
+        else if (tag == TLV_SESSION_KEY && value.readableBytes() == TEA_KEY_SIZE)
+        {
+            memcpy(sessionKey, value.readPointer(), TEA_KEY_SIZE);
+            hasKey = true;
+        }
+    }
+    return ok && hasKey;
+}
+
+void QQDommy::MockProtocol::buildSealed(ByteBuffer &out, TeaCipher &cipher, uint16_t tag, const uint8_t *value, size_t length)
+{
+    ByteBuffer plain(TLV_HEADER_SIZE + length);
+    {
+        TraceSpan span("tlv encode");
+        plain.doVisit(BytesTlvPack(tag, value, length));
+    }
+    cipher.encrypt(out, plain.readPointer(), plain.readableBytes());
+}
@@ -0,0 +1,231 @@
+#include "mock/MockServer.h"
+#include "mock/MockProtocol.h"
+#include "net/Connection.h"
+#include "core/Frame.h"
+#include "core/Tlv.h"
+#include "encrypt/Md5.h"
+#include <cstring>
+
+namespace QQDommy
+{
+
+    /**
+     * @brief the server side of one client connection
+     *
+     */
+    class MockSession : public ConnectionHandler
+    {
+    private:
+        MockServer &server;
+        Connection conn;
+        TeaCipher shareCipher;
+        std::unique_ptr<TeaCipher> sessionCipher;
+        TimerId pushTimer = 0;
+        uint64_t uin = 0;
+        uint64_t nextPushId = 0;
+        /// @brief reused for every reply
+        ByteBuffer reply;
+        ByteBuffer payload;
+        void handleLogin(Frame &frame);
+        void handleMessage(Frame &frame);
+        void pushBurst();
+        void sendReply(uint32_t sequence, uint32_t command);
+
+    public:
+        MockSession(MockServer &server, EventLoop &loop);
+        void start(int fd);
+        void onMessage(Connection &conn, ByteBuffer &input) override;
+        void onClosed(Connection &conn, int error) override;
+    };
+
+};
+
+QQDommy::MockSession::MockSession(MockServer &server, EventLoop &loop)
+    : server(server), conn(loop, *this), shareCipher(MOCK_SHARE_KEY.data())
+{
+}
+
+void QQDommy::MockSession::start(int fd)
+{
+    sessionCipher.reset();
+    uin = 0;
+    conn.adopt(fd);
+}
+
+void QQDommy::MockSession::sendReply(uint32_t sequence, uint32_t command)
+{
+    reply.clear();
+    FrameCodec::encode(reply, sequence, command, payload.readPointer(), payload.readableBytes());
+    conn.send(reply);
+    payload.clear();
+}
+
+void QQDommy::MockSession::handleLogin(Frame &frame)
+{
+    ByteBuffer plain;
+    uint16_t tag;
+    ByteBuffer value = ByteBuffer::wrap(nullptr, 0);
+    ByteBuffer expected = Md5Processor(server.getConfig().password).digest32();
+    bool passwordOk = false;
+    try
+    {
+        shareCipher.decrypt(plain, frame.payload.readPointer(), frame.payload.readableBytes());
+    }
+    catch (const TeaDecryptException &e)
+    {
+        conn.close();
+        return;
+    }
+    while (TlvReader::next(plain, tag, value))
+    {
+        if (tag == TLV_UIN && value.readableBytes() == 8)
+            uin = value.read_uint64Be();
+        else if (tag == TLV_PASSWORD_MD5 && value.readableBytes() == expected.readableBytes())
+            passwordOk = memcmp(value.readPointer(), expected.readPointer(), expected.readableBytes()) == 0;
+    }
+
+    ByteBuffer result;
+    uint8_t code = passwordOk ? LOGIN_OK : LOGIN_WRONG_PASSWORD;
+    result.doVisit(BytesTlvPack(TLV_RESULT, &code, 1));
+    if (passwordOk)
+    {
+        // any key will do for a mock, derive it from the uin
+        ByteBuffer key = Md5Processor(std::to_string(uin)).digest32();
+        result.doVisit(BytesTlvPack(TLV_SESSION_KEY, key));
+        sessionCipher.reset(new TeaCipher(key.readPointer()));
+        server.mutableStats().logins++;
+    }
+    else
+        server.mutableStats().failedLogins++;
+    shareCipher.encrypt(payload, result.readPointer(), result.readableBytes());
+    sendReply(frame.sequence, CMD_LOGIN);
+
+    const MockServerConfig &config = server.getConfig();
+    if (passwordOk && config.pushBurst > 0 && pushTimer == 0)
+        pushTimer = conn.getLoop().runEvery(config.pushIntervalMs, [this]()
+                                            { pushBurst(); });
+}
+
+void QQDommy::MockSession::handleMessage(Frame &frame)
+{
+    ByteBuffer plain;
+    try
+    {
+        sessionCipher->decrypt(plain, frame.payload.readPointer(), frame.payload.readableBytes());
+    }
+    catch (const TeaDecryptException &e)
+    {
+        conn.close();
+        return;
+    }
+    server.mutableStats().messages++;
+    // the ack carries no payload, only the sequence matters
+    sendReply(frame.sequence, CMD_SEND_MESSAGE);
+}
+
+void QQDommy::MockSession::pushBurst()
+{
+    static const char TEXT[] = "synthetic message from the mock server";
+    ByteBuffer plain;
+    for (size_t i = 0; i < server.getConfig().pushBurst; i++)
+    {
+        plain.clear();
+        plain.doVisit(Uint64TlvPack(TLV_PUSH_ID, nextPushId++))
+            .doVisit(BytesTlvPack(TLV_MESSAGE, (const uint8_t *)TEXT, sizeof(TEXT) - 1));
+        sessionCipher->encrypt(payload, plain.readPointer(), plain.readableBytes());
+        // pushes are unsolicited, sequence 0 never matches a request
+        sendReply(0, CMD_PUSH_MESSAGE);
+        server.mutableStats().pushes++;
+    }
+}
+
+void QQDommy::MockSession::onMessage(Connection &conn, ByteBuffer &input)
+{
+    Frame frame;
+    try
+    {
+        while (FrameCodec::decode(input, frame))
+        {
+            bool loggedIn = sessionCipher != nullptr;
+            if (frame.command == CMD_LOGIN)
+                handleLogin(frame);
+            else if (frame.command == CMD_HEARTBEAT)
+            {
+                server.mutableStats().heartbeats++;
+                sendReply(frame.sequence, CMD_HEARTBEAT);
+            }
+            else if (frame.command == CMD_SEND_MESSAGE && loggedIn)
+                handleMessage(frame);
+            else if (frame.command == CMD_PUSH_ACK)
+                server.mutableStats().pushAcks++;
+            if (conn.getState() != CONNECTED)
+                return;
+        }
+    }
+    catch (const MalformedFrameException &e)
+    {
+        conn.close();
+    }
+}
+
+void QQDommy::MockSession::onClosed(Connection &conn, int /*error*/)
+{
+    if (pushTimer != 0)
+    {
+        conn.getLoop().cancelTimer(pushTimer);
+        pushTimer = 0;
+    }
+    server.release(this);
+}
+
+QQDommy::MockServer::MockServer(EventLoop &loop, const MockServerConfig &config)
+    : loop(loop), config(config), acceptor(loop, [this](int fd)
+                                           { accept(fd); })
+{
+}
+
+QQDommy::MockServer::~MockServer()
+{
+}
+
+uint16_t QQDommy::MockServer::listen(const std::string &ip, uint16_t port)
+{
+    return acceptor.listen(ip, port);
+}
+
+void QQDommy::MockServer::accept(int fd)
+{
+    stats.connections++;
+    MockSession *session;
+    if (!idleSessions.empty())
+    {
+        session = idleSessions.back();
+        idleSessions.pop_back();
+    }
+    else
+    {
+        sessions.emplace_back(new MockSession(*this, loop));
+        session = sessions.back().get();
+    }
+    session->start(fd);
+}
+
+void QQDommy::MockServer::release(MockSession *session)
+{
+    idleSessions.push_back(session);
+}
+
+const QQDommy::MockServerStats &QQDommy::MockServer::getStats() const
+{
+    return stats;
+}
+
+const QQDommy::MockServerConfig &QQDommy::MockServer::getConfig() const
+{
+    return config;
+}
+
+QQDommy::MockServerStats &QQDommy::MockServer::mutableStats()
+{
+    return stats;
+}
@@ -0,0 +1,65 @@
+#include "net/Acceptor.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+QQDommy::Acceptor::Acceptor(EventLoop &loop, const AcceptCallback &callback)
+    : loop(loop), callback(callback)
+{
+}
+
+QQDommy::Acceptor::~Acceptor()
+{
+    if (listenFd >= 0)
+    {
+        loop.remove(listenFd);
+        ::close(listenFd);
+    }
+}
+
+uint16_t QQDommy::Acceptor::listen(const std::string &ip, uint16_t port, int backlog)
+{
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1)
+        throw NetworkException("inet_pton " + ip, EINVAL);
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        throw NetworkException("socket", errno);
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || ::listen(listenFd, backlog) < 0)
+    {
+        int error = errno;
+        ::close(listenFd);
+        listenFd = -1;
+        throw NetworkException("bind/listen", error);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd, (sockaddr *)&addr, &len);
+    loop.add(listenFd, EPOLLIN | EPOLLET, this);
+    return ntohs(addr.sin_port);
+}
+
+void QQDommy::Acceptor::handleEvent(uint32_t /*events*/)
+{
+    while (true)
+    {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0)
+        {
+            callback(fd);
+            continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+        // EAGAIN when drained, EMFILE and the like are retried on the next connection
+        return;
+    }
+}
@@ -0,0 +1,338 @@
+#include "net/Connection.h"
+#include "utils/Tracing.h"
+#include "utils/Metrics.h"
+#include "utils/TscClock.h"
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/// @brief edge triggered, both directions are watched for the whole life of the socket
+#define CONNECTION_EVENTS (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET)
+
+static const QQDommy::Counter sentPackets("connection_packets_sent_total", "packets handed to the connections");
+static const QQDommy::Counter sendSyscalls("connection_send_syscalls_total", "send syscalls writing the packets");
+
+QQDommy::Connection::Connection(EventLoop &loop, ConnectionHandler &handler)
+    : loop(loop), handler(handler), inputBuffer(READ_CHUNK_SIZE), corkDelayTicks(loop.ticksIn(DEFAULT_CORK_DELAY_US))
+{
+}
+
+QQDommy::Connection::~Connection()
+{
+    if (connectTimer != 0)
+        loop.cancelTimer(connectTimer);
+    if (corked)
+        loop.cancelTurnEnd(this);
+    if (fd >= 0)
+    {
+        loop.remove(fd);
+        ::close(fd);
+    }
+}
+
+void QQDommy::Connection::attach(int socketFd, CONNECTION_STATE newState)
+{
+    int one = 1;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd = socketFd;
+    state = newState;
+    loop.add(fd, CONNECTION_EVENTS, this);
+}
+
+void QQDommy::Connection::connect(const std::string &ip, uint16_t port, int timeoutMs)
+{
+    if (state != IDLE && state != CLOSED)
+        throw NetworkException("connect", EISCONN);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1)
+        throw NetworkException("inet_pton " + ip, EINVAL);
+
+    int socketFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socketFd < 0)
+        throw NetworkException("socket", errno);
+    inputBuffer.clear();
+    int ret = ::connect(socketFd, (sockaddr *)&addr, sizeof(addr));
+    if (ret < 0 && errno != EINPROGRESS)
+    {
+        int error = errno;
+        ::close(socketFd);
+        throw NetworkException("connect", error);
+    }
+    if (ret == 0)
+    {
+        // loopback may connect at once
+        attach(socketFd, CONNECTED);
+        handler.onConnected(*this);
+        if (state == CONNECTED)
+            handleWrite();
+        return;
+    }
+    attach(socketFd, CONNECTING);
+    connectTimer = loop.runAfter(timeoutMs, [this]()
+                                 {
+        connectTimer = 0;
+        if (state == CONNECTING)
+            shutdown(ETIMEDOUT); });
+}
+
+void QQDommy::Connection::adopt(int socketFd)
+{
+    if (state != IDLE && state != CLOSED)
+        throw NetworkException("adopt", EISCONN);
+    int flags = fcntl(socketFd, F_GETFL, 0);
+    if (!(flags & O_NONBLOCK))
+        fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+    inputBuffer.clear();
+    attach(socketFd, CONNECTED);
+}
+
+void QQDommy::Connection::send(const void *src, size_t length)
+{
+    if (state == IDLE || state == CLOSED || length == 0)
+        return;
+    TraceSpan span("socket send");
+    const uint8_t *bytes = static_cast<const uint8_t *>(src);
+    if (connectionTap != nullptr)
+        connectionTap->tap(OUTBOUND, bytes, length);
+    stats.packets++;
+    stats.bytes += length;
+    sentPackets.add();
+    // before the connect completes or while the kernel is full the packets only queue up
+    if (state != CONNECTED || blocked)
+    {
+        outputBuffer.writeBytes(bytes, length);
+        return;
+    }
+    // outside a turn nothing would write the cork
+    if (corkBytes > 0 && loop.isInTurn())
+    {
+        if (!corked)
+        {
+            corked = true;
+            corkedAt = TscClock::now();
+            loop.runAtTurnEnd(this);
+        }
+        if (outputBuffer.readableBytes() + length < corkBytes && TscClock::now() - corkedAt < corkDelayTicks)
+        {
+            outputBuffer.writeBytes(bytes, length);
+            return;
+        }
+        // the cork is full or old, it goes out with this packet
+        corked = false;
+        loop.cancelTurnEnd(this);
+    }
+    handleWrite(bytes, length);
+}
+
+void QQDommy::Connection::send(ByteBuffer &buffer)
+{
+    size_t length = buffer.readableBytes();
+    send(buffer.readPointer(), length);
+    buffer.skip(length);
+}
+
+void QQDommy::Connection::close()
+{
+    if (state == IDLE || state == CLOSED)
+        return;
+    shutdown(0);
+}
+
+void QQDommy::Connection::shutdown(int error)
+{
+    if (connectTimer != 0)
+    {
+        loop.cancelTimer(connectTimer);
+        connectTimer = 0;
+    }
+    loop.remove(fd);
+    ::close(fd);
+    fd = -1;
+    state = CLOSED;
+    if (corked)
+        loop.cancelTurnEnd(this);
+    corked = false;
+    blocked = false;
+    outputBuffer.clear();
+    handler.onClosed(*this, error);
+}
+
+void QQDommy::Connection::finishConnect()
+{
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+        error = errno;
+    if (error != 0)
+    {
+        shutdown(error);
+        return;
+    }
+    loop.cancelTimer(connectTimer);
+    connectTimer = 0;
+    state = CONNECTED;
+    handler.onConnected(*this);
+}
+
+void QQDommy::Connection::handleRead()
+{
+    bool peerClosed = false;
+    int error = 0;
+    size_t received = 0;
+    while (true)
+    {
+        inputBuffer.ensureWritable(READ_CHUNK_SIZE);
+        ssize_t n = ::read(fd, inputBuffer.writePointer(), inputBuffer.writableBytes());
+        if (n > 0)
+        {
+            inputBuffer.commitWrite(n);
+            received += n;
+            continue;
+        }
+        if (n == 0)
+            peerClosed = true;
+        else if (errno == EINTR)
+            continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK)
+            error = errno;
+        break;
+    }
+    if (received > 0)
+    {
+        if (connectionTap != nullptr)
+            connectionTap->tap(INBOUND, inputBuffer.readPointer() + inputBuffer.readableBytes() - received, received);
+        handler.onMessage(*this, inputBuffer);
+        // the handler may have closed the connection
+        if (state != CONNECTED)
+            return;
+    }
+    if (peerClosed || error != 0)
+        shutdown(error);
+}
+
+void QQDommy::Connection::handleWrite(const uint8_t *extra, size_t length)
+{
+    while (outputBuffer.readableBytes() + length > 0)
+    {
+        size_t queued = outputBuffer.readableBytes();
+        iovec parts[2];
+        msghdr message = {};
+        message.msg_iov = parts;
+        if (queued > 0)
+            parts[message.msg_iovlen++] = {const_cast<uint8_t *>(outputBuffer.readPointer()), queued};
+        if (length > 0)
+            parts[message.msg_iovlen++] = {const_cast<uint8_t *>(extra), length};
+        // writev with MSG_NOSIGNAL
+        ssize_t n = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+        stats.syscalls++;
+        sendSyscalls.add();
+        if (n > 0)
+        {
+            size_t fromQueue = std::min((size_t)n, queued);
+            outputBuffer.skip(fromQueue);
+            extra += n - fromQueue;
+            length -= n - fromQueue;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // the rest is written when epoll reports the socket writable again
+            outputBuffer.writeBytes(extra, length);
+            blocked = true;
+            return;
+        }
+        shutdown(n < 0 ? errno : EPIPE);
+        return;
+    }
+    // all flushed, start from the head of the buffer again
+    blocked = false;
+    outputBuffer.clear();
+}
+
+void QQDommy::Connection::handleEvent(uint32_t events)
+{
+    if (state == CONNECTING)
+    {
+        if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+            return;
+        finishConnect();
+        if (state != CONNECTED)
+            return;
+    }
+    if (state != CONNECTED)
+        return;
+    if (events & EPOLLERR)
+    {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        shutdown(error == 0 ? EIO : error);
+        return;
+    }
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))
+    {
+        handleRead();
+        if (state != CONNECTED)
+            return;
+    }
+    // a cork is written at the end of the turn
+    if ((events & EPOLLOUT) && !corked)
+        handleWrite();
+}
+
+void QQDommy::Connection::onTurnEnd()
+{
+    // uncorked by a full cork or a close since it was scheduled
+    if (!corked)
+        return;
+    corked = false;
+    if (state == CONNECTED && !blocked)
+        handleWrite();
+}
+
+void QQDommy::Connection::setCork(size_t bytes, int delayUs)
+{
+    corkBytes = bytes;
+    corkDelayTicks = loop.ticksIn(delayUs);
+}
+
+const QQDommy::SendStats &QQDommy::Connection::getSendStats() const
+{
+    return stats;
+}
+
+void QQDommy::Connection::setTap(ConnectionTap *tap)
+{
+    connectionTap = tap;
+}
+
+QQDommy::CONNECTION_STATE QQDommy::Connection::getState() const
+{
+    return state;
+}
+
+int QQDommy::Connection::getFd() const
+{
+    return fd;
+}
+
+size_t QQDommy::Connection::pendingBytes() const
+{
+    return outputBuffer.readableBytes();
+}
+
+QQDommy::EventLoop &QQDommy::Connection::getLoop()
+{
+    return loop;
+}
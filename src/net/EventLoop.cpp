@@ -0,0 +1,222 @@
+#include "net/EventLoop.h"
+#include "utils/TscClock.h"
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+QQDommy::NetworkException::NetworkException(const std::string &call, int error)
+{
+    msg = call + " failed : " + strerror(error);
+}
+
+const char *QQDommy::NetworkException::what() const noexcept
+{
+    return msg.c_str();
+}
+
+QQDommy::EventLoop::EventLoop(size_t maxEvents, size_t taskCapacity, int tickMs)
+    : events(maxEvents == 0 ? DEFAULT_MAX_EVENTS : maxEvents), timers(tickMs), tasks(taskCapacity),
+      nsPerTick(TscClock::calibration().nsPerTick)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+        throw NetworkException("epoll_create1", errno);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0)
+    {
+        int error = errno;
+        ::close(epollFd);
+        throw NetworkException("eventfd", error);
+    }
+    add(wakeFd, EPOLLIN | EPOLLET, this);
+}
+
+QQDommy::EventLoop::~EventLoop()
+{
+    ::close(wakeFd);
+    ::close(epollFd);
+}
+
+void QQDommy::EventLoop::add(int fd, uint32_t mask, EventHandler *handler)
+{
+    epoll_event ev;
+    ev.events = mask;
+    ev.data.ptr = handler;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        throw NetworkException("epoll_ctl add", errno);
+}
+
+void QQDommy::EventLoop::modify(int fd, uint32_t mask, EventHandler *handler)
+{
+    epoll_event ev;
+    ev.events = mask;
+    ev.data.ptr = handler;
+    if (epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+        throw NetworkException("epoll_ctl mod", errno);
+}
+
+void QQDommy::EventLoop::remove(int fd)
+{
+    // the fd may already be gone, nothing to report then
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+QQDommy::TimerId QQDommy::EventLoop::runAfter(int delayMs, const TimerCallback &callback)
+{
+    return timers.schedule(delayMs, callback);
+}
+
+QQDommy::TimerId QQDommy::EventLoop::runEvery(int intervalMs, const TimerCallback &callback)
+{
+    return timers.schedule(intervalMs, callback, intervalMs);
+}
+
+bool QQDommy::EventLoop::cancelTimer(TimerId id)
+{
+    return timers.cancel(id);
+}
+
+void QQDommy::EventLoop::runAtTurnEnd(TurnEndHandler *handler)
+{
+    turnEnd.push_back(handler);
+}
+
+void QQDommy::EventLoop::cancelTurnEnd(TurnEndHandler *handler)
+{
+    auto found = std::find(turnEnd.begin(), turnEnd.end(), handler);
+    if (found != turnEnd.end())
+    {
+        *found = turnEnd.back();
+        turnEnd.pop_back();
+    }
+    // a handler waiting in the batch being drained may be destroyed by one run before it
+    found = std::find(draining.begin(), draining.end(), handler);
+    if (found != draining.end())
+        *found = nullptr;
+}
+
+bool QQDommy::EventLoop::isInTurn() const
+{
+    return inTurn;
+}
+
+void QQDommy::EventLoop::runTurnEnd()
+{
+    while (!turnEnd.empty())
+    {
+        draining.swap(turnEnd);
+        // by index, cancelTurnEnd clears the entries of the handlers destroyed meanwhile
+        for (size_t i = 0; i < draining.size(); i++)
+        {
+            TurnEndHandler *handler = draining[i];
+            if (handler != nullptr)
+            {
+                draining[i] = nullptr;
+                handler->onTurnEnd();
+            }
+        }
+        draining.clear();
+    }
+}
+
+QQDommy::TimerWheel &QQDommy::EventLoop::getTimers()
+{
+    return timers;
+}
+
+uint64_t QQDommy::EventLoop::ticksIn(int delayUs) const
+{
+    return (uint64_t)(delayUs * 1000.0 / nsPerTick);
+}
+
+int QQDommy::EventLoop::runOnce(int timeoutMs)
+{
+    int nearest = timers.nextTimeout();
+    if (nearest >= 0 && (timeoutMs < 0 || nearest < timeoutMs))
+        timeoutMs = nearest;
+    int n = epoll_wait(epollFd, events.data(), (int)events.size(), timeoutMs);
+    if (n < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+        throw NetworkException("epoll_wait", errno);
+    }
+    inTurn = true;
+    for (int i = 0; i < n; i++)
+    {
+        EventHandler *handler = static_cast<EventHandler *>(events[i].data.ptr);
+        handler->handleEvent(events[i].events);
+    }
+    timers.advance();
+    runTasks();
+    inTurn = false;
+    runTurnEnd();
+    return n;
+}
+
+void QQDommy::EventLoop::run()
+{
+    loopThread.store(std::this_thread::get_id());
+    running.store(true);
+    // a stop arriving before the thread got here is not overwritten
+    while (!stopRequested.load(std::memory_order_acquire))
+        runOnce(-1);
+    running.store(false);
+}
+
+void QQDommy::EventLoop::stop()
+{
+    stopRequested.store(true, std::memory_order_release);
+    wakeup();
+}
+
+void QQDommy::EventLoop::wakeup()
+{
+    uint64_t one = 1;
+    // the counter only overflows after 2^64 wakeups, the result can be ignored
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool QQDommy::EventLoop::isRunning() const
+{
+    return running.load();
+}
+
+bool QQDommy::EventLoop::isStopped() const
+{
+    return stopRequested.load(std::memory_order_acquire);
+}
+
+bool QQDommy::EventLoop::post(LoopTask task)
+{
+    if (!tasks.push(std::move(task)))
+        return false;
+    // only the first post after the loop drained the mailbox pays the syscall
+    if (!notified.exchange(true))
+        wakeup();
+    return true;
+}
+
+bool QQDommy::EventLoop::isInLoopThread() const
+{
+    return loopThread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+void QQDommy::EventLoop::runTasks()
+{
+    // reset before draining, a post racing with the drain wakes the loop again
+    notified.exchange(false);
+    LoopTask task;
+    while (tasks.pop(task))
+        task();
+}
+
+void QQDommy::EventLoop::handleEvent(uint32_t /*events*/)
+{
+    uint64_t counter;
+    while (::read(wakeFd, &counter, sizeof(counter)) > 0)
+        ;
+}
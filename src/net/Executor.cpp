@@ -0,0 +1,306 @@
+#include "net/Executor.h"
+#include "utils/Metrics.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+
+static const QQDommy::Counter droppedResults("executor_dropped_results_total", "results not posted since the loop stopped with its mailbox full");
+
+thread_local QQDommy::Executor::Worker *QQDommy::Executor::currentWorker = nullptr;
+thread_local QQDommy::Executor *QQDommy::Executor::currentExecutor = nullptr;
+
+/// @brief splitmix64 finalizer, neighbouring uins end up on different strands
+static uint64_t mix(uint64_t key)
+{
+    uint64_t h = key + 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+/// @brief xorshift64, to pick a victim
+static uint64_t nextRandom(uint64_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+QQDommy::JobQueue::JobQueue() : head(&stub), tail(&stub)
+{
+}
+
+void QQDommy::JobQueue::push(JobNode *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    JobNode *previous = head.exchange(node, std::memory_order_acq_rel);
+    // until this store the consumer sees the queue end at previous
+    previous->next.store(node, std::memory_order_release);
+}
+
+QQDommy::Job *QQDommy::JobQueue::pop()
+{
+    JobNode *first = tail;
+    JobNode *next = first->next.load(std::memory_order_acquire);
+    if (first == &stub)
+    {
+        if (next == nullptr)
+            return nullptr;
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr)
+    {
+        tail = next;
+        return static_cast<Job *>(first);
+    }
+    // the last node can only be taken with the stub behind it
+    if (first != head.load(std::memory_order_acquire))
+        return nullptr;
+    push(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+        return nullptr;
+    tail = next;
+    return static_cast<Job *>(first);
+}
+
+void QQDommy::Strand::run()
+{
+    int index = Executor::currentIndex();
+    if (index >= 0)
+        lastWorker.store(index, std::memory_order_relaxed);
+    for (size_t i = 0; i < STRAND_BATCH; i++)
+    {
+        Job *job;
+        // a job is counted before it is linked, the link follows at once
+        while ((job = jobs.pop()) == nullptr)
+            std::this_thread::yield();
+        job->run();
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            return;
+    }
+    // behind the other jobs of the worker, the strand keeps its place on it
+    executor->schedule(this, lastWorker.load(std::memory_order_relaxed));
+}
+
+QQDommy::Executor::Executor(size_t workerCount, bool pinThreads) : strands(new Strand[EXECUTOR_STRANDS])
+{
+    // only the cpus this process may run on are used
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; i++)
+        {
+            if (CPU_ISSET(i, &set))
+                cpus.push_back(i);
+        }
+    }
+    if (workerCount == 0)
+        workerCount = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : cpus.size();
+    for (size_t i = 0; i < EXECUTOR_STRANDS; i++)
+    {
+        strands[i].executor = this;
+        strands[i].lastWorker.store(i % workerCount, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.emplace_back(new Worker());
+        workers.back()->index = i;
+        workers.back()->seed = mix(i);
+    }
+    // every worker exists before any of them steals
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        int cpu = pinThreads && !cpus.empty() ? cpus[i % cpus.size()] : -1;
+        Worker &worker = *workers[i];
+        worker.thread = std::thread([this, &worker, cpu]()
+                                    {
+            if (cpu >= 0)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                // failing to pin only costs locality, the worker still works
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            }
+            work(worker); });
+    }
+}
+
+QQDommy::Executor::~Executor()
+{
+    running.store(false, std::memory_order_seq_cst);
+    for (auto &worker : workers)
+    {
+        worker->wakeups.fetch_add(1, std::memory_order_release);
+        worker->wakeups.notify_one();
+    }
+    for (auto &worker : workers)
+        worker->thread.join();
+}
+
+void QQDommy::Executor::work(Worker &worker)
+{
+    currentWorker = &worker;
+    currentExecutor = this;
+    while (true)
+    {
+        Job *job = find(worker);
+        if (job == nullptr)
+        {
+            // parked workers are looked at after every submit, so the state is set before the last look
+            uint32_t seen = worker.wakeups.load(std::memory_order_acquire);
+            worker.sleeping.store(true, std::memory_order_seq_cst);
+            idle.fetch_add(1, std::memory_order_seq_cst);
+            job = find(worker);
+            if (job == nullptr && running.load(std::memory_order_seq_cst))
+            {
+                worker.parked.store(worker.parked.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                worker.wakeups.wait(seen, std::memory_order_acquire);
+            }
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            idle.fetch_sub(1, std::memory_order_relaxed);
+            if (job == nullptr)
+            {
+                // the jobs submitted before the stop are run first
+                if (!running.load(std::memory_order_acquire) && (job = find(worker)) == nullptr)
+                    break;
+                if (job == nullptr)
+                    continue;
+            }
+        }
+        job->run();
+        worker.executed.store(worker.executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    currentWorker = nullptr;
+    currentExecutor = nullptr;
+}
+
+QQDommy::Job *QQDommy::Executor::find(Worker &worker)
+{
+    Job *job = worker.deque.pop();
+    if (job != nullptr)
+        return job;
+    // the inbox is moved to the deque, where the idle workers can steal from it
+    bool moved = false;
+    while ((job = worker.inbox.pop()) != nullptr)
+    {
+        worker.deque.push(job);
+        moved = true;
+    }
+    if (moved && (job = worker.deque.pop()) != nullptr)
+    {
+        // the rest is worth stealing
+        if (!worker.deque.empty())
+            wakeAny();
+        return job;
+    }
+    size_t count = workers.size();
+    size_t start = nextRandom(worker.seed) % count;
+    // a steal lost to another thief is tried once more
+    for (size_t round = 0; round < 2; round++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Worker &victim = *workers[(start + i) % count];
+            if (&victim == &worker)
+                continue;
+            if ((job = victim.deque.steal()) != nullptr)
+            {
+                worker.stolen.store(worker.stolen.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void QQDommy::Executor::schedule(Job *job, size_t preferred)
+{
+    Worker *self = currentExecutor == this ? currentWorker : nullptr;
+    if (preferred == SIZE_MAX && self != nullptr)
+    {
+        self->deque.push(job);
+        wakeAny();
+        return;
+    }
+    size_t target = preferred != SIZE_MAX ? preferred : nextInbox.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    Worker &worker = *workers[target];
+    worker.inbox.push(job);
+    // only the owner takes from its inbox
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed))
+    {
+        worker.wakeups.fetch_add(1, std::memory_order_release);
+        worker.wakeups.notify_one();
+    }
+}
+
+void QQDommy::Executor::wakeAny()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle.load(std::memory_order_relaxed) == 0)
+        return;
+    for (auto &worker : workers)
+    {
+        if (worker.get() != currentWorker && worker->sleeping.load(std::memory_order_relaxed))
+        {
+            worker->wakeups.fetch_add(1, std::memory_order_release);
+            worker->wakeups.notify_one();
+            return;
+        }
+    }
+}
+
+void QQDommy::Executor::enqueue(uint64_t key, Job *job)
+{
+    Strand &strand = strands[mix(key) & (EXECUTOR_STRANDS - 1)];
+    size_t before = strand.pending.fetch_add(1, std::memory_order_acq_rel);
+    strand.jobs.push(job);
+    // the first job schedules the strand, the others find it scheduled or running
+    if (before == 0)
+        schedule(&strand, strand.lastWorker.load(std::memory_order_relaxed));
+}
+
+bool QQDommy::Executor::postToLoop(EventLoop &loop, LoopTask task)
+{
+    while (!loop.post(task))
+    {
+        // nothing drains the mailbox once the loop stopped, waiting would hang the worker and the join
+        // a loop not started yet will drain it, the wait goes on
+        if (loop.isStopped())
+        {
+            droppedResults.add();
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+size_t QQDommy::Executor::size() const
+{
+    return workers.size();
+}
+
+QQDommy::ExecutorStats QQDommy::Executor::getStats() const
+{
+    ExecutorStats stats;
+    for (auto &worker : workers)
+    {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.parked += worker->parked.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+int QQDommy::Executor::currentIndex()
+{
+    return currentWorker != nullptr ? (int)currentWorker->index : -1;
+}
@@ -0,0 +1,138 @@
+#include "net/ShardedRuntime.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+
+thread_local QQDommy::Shard *QQDommy::Shard::currentShard = nullptr;
+
+QQDommy::Shard::Shard(size_t index, int cpu) : index(index), cpu(cpu)
+{
+}
+
+void QQDommy::Shard::start()
+{
+    thread = std::thread([this]()
+                         {
+        if (cpu >= 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            // failing to pin only costs locality, the shard still works
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+        currentShard = this;
+        loop.run();
+        currentShard = nullptr; });
+}
+
+void QQDommy::Shard::stop()
+{
+    if (!thread.joinable())
+        return;
+    loop.stop();
+    thread.join();
+}
+
+QQDommy::EventLoop &QQDommy::Shard::getLoop()
+{
+    return loop;
+}
+
+QQDommy::BufferPool &QQDommy::Shard::getPool()
+{
+    return pool;
+}
+
+size_t QQDommy::Shard::getIndex() const
+{
+    return index;
+}
+
+int QQDommy::Shard::getCpu() const
+{
+    return cpu;
+}
+
+QQDommy::Shard *QQDommy::Shard::current()
+{
+    return currentShard;
+}
+
+QQDommy::ShardedRuntime::ShardedRuntime(size_t shardCount, bool pinThreads)
+{
+    // only the cpus this process may run on are used
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int i = 0; i < CPU_SETSIZE; i++)
+        {
+            if (CPU_ISSET(i, &set))
+                cpus.push_back(i);
+        }
+    }
+    if (shardCount == 0)
+        shardCount = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : cpus.size();
+    for (size_t i = 0; i < shardCount; i++)
+    {
+        int cpu = pinThreads && !cpus.empty() ? cpus[i % cpus.size()] : -1;
+        shards.emplace_back(new Shard(i, cpu));
+    }
+}
+
+QQDommy::ShardedRuntime::~ShardedRuntime()
+{
+    stop();
+}
+
+void QQDommy::ShardedRuntime::start()
+{
+    if (started)
+        return;
+    started = true;
+    for (auto &shard : shards)
+        shard->start();
+}
+
+void QQDommy::ShardedRuntime::stop()
+{
+    if (!started)
+        return;
+    started = false;
+    for (auto &shard : shards)
+        shard->stop();
+}
+
+size_t QQDommy::ShardedRuntime::shardIndexOf(uint64_t uin) const
+{
+    // splitmix64 finalizer, neighbouring uins end up on different shards
+    uint64_t h = uin + 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    h = h ^ (h >> 31);
+    return h % shards.size();
+}
+
+QQDommy::Shard &QQDommy::ShardedRuntime::shardOf(uint64_t uin)
+{
+    return *shards[shardIndexOf(uin)];
+}
+
+QQDommy::Shard &QQDommy::ShardedRuntime::getShard(size_t index)
+{
+    return *shards.at(index);
+}
+
+size_t QQDommy::ShardedRuntime::size() const
+{
+    return shards.size();
+}
+
+bool QQDommy::ShardedRuntime::submit(uint64_t uin, const ShardTask &task)
+{
+    Shard &shard = shardOf(uin);
+    return shard.getLoop().post([&shard, task]()
+                                { task(shard); });
+}
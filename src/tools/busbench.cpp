@@ -0,0 +1,218 @@
+/**
+ * @file busbench.cpp
+ * @author maxwellzs
+ * @brief the cost of handing the decoded events to subscriber processes
+ * the events go once through the shared memory bus, then once more through a unix
+ * socket per subscriber as the events were handed out before the bus, every
+ * subscriber is a forked process checking the order of the events
+ * usage : busbench [events] [subscribers] [payload bytes]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include "core/EventBus.h"
+
+static const char *BUS_NAME = "/qqdommy-busbench";
+static const uint16_t EVENT_MESSAGE = 1;
+static const uint16_t EVENT_END = 2;
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// @brief the cpu time of the calling process alone, the subscribers are not counted
+static uint64_t cpuNs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ull +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ull;
+}
+
+/// @brief a decoded group message, the uin counts the events
+static void makeEvent(QQDommy::ByteBuffer &event, uint64_t uin, size_t payloadBytes)
+{
+    event.clear();
+    event.write_uint64(uin).write_uint64(123456789);
+    for (size_t i = 16; i < payloadBytes; i++)
+        event.write_uint8((uint8_t)i);
+}
+
+/// @brief the parent waits until every subscriber is ready
+static void waitReady(int ready, size_t subscribers)
+{
+    char byte;
+    for (size_t i = 0; i < subscribers; i++)
+        if (read(ready, &byte, 1) != 1)
+            exit(1);
+}
+
+/// @brief every subscriber exits with 0 if it saw all the events in order
+static size_t reap(size_t subscribers)
+{
+    size_t failed = 0;
+    for (size_t i = 0; i < subscribers; i++)
+    {
+        int status;
+        wait(&status);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed++;
+    }
+    return failed;
+}
+
+class CountingHandler : public QQDommy::BusHandler
+{
+public:
+    uint64_t next = 1;
+    bool ordered = true;
+    bool ended = false;
+    void onEvent(const QQDommy::BusEvent &event) override
+    {
+        if (event.type == EVENT_END)
+        {
+            ended = true;
+            return;
+        }
+        ordered = ordered && event.payload.read_uint64Be() == next;
+        next++;
+    }
+};
+
+static void benchBus(size_t events, size_t subscribers, size_t payloadBytes)
+{
+    using namespace QQDommy;
+    EventPublisher::unlink(BUS_NAME);
+    EventPublisher publisher(BUS_NAME);
+    int ready[2];
+    if (pipe(ready) < 0)
+        exit(1);
+    for (size_t i = 0; i < subscribers; i++)
+    {
+        if (fork() == 0)
+        {
+            EventSubscriber subscriber(BUS_NAME);
+            CountingHandler handler;
+            if (write(ready[1], "r", 1) != 1)
+                _exit(1);
+            while (!handler.ended)
+            {
+                // an idle subscriber lets the others have the core
+                if (subscriber.poll(handler, 4096) == 0)
+                    sched_yield();
+            }
+            _exit(handler.ordered && subscriber.getLost() == 0 && handler.next == events + 1 ? 0 : 1);
+        }
+    }
+    waitReady(ready[0], subscribers);
+    ByteBuffer event;
+    uint64_t start = nowNs(), cpuStart = cpuNs();
+    for (uint64_t uin = 1; uin <= events; uin++)
+    {
+        makeEvent(event, uin, payloadBytes);
+        publisher.publish(EVENT_MESSAGE, event);
+        // a publisher that must lose nothing leaves the subscribers the time to catch up
+        if ((uin & 1023) == 0)
+            while (publisher.getStats().maxLag > DEFAULT_BUS_CAPACITY / 2)
+                sched_yield();
+    }
+    publisher.publish(EVENT_END, nullptr, 0);
+    uint64_t cpu = cpuNs() - cpuStart;
+    size_t failed = reap(subscribers);
+    uint64_t elapsed = nowNs() - start;
+    BusStats stats = publisher.getStats();
+    printf("bus    %10.0f events/s, %7.1f ns publisher cpu/event, %zu evictions, %zu subscribers failed\n",
+           events * 1e9 / elapsed, (double)cpu / events, (size_t)stats.evictions, failed);
+    EventPublisher::unlink(BUS_NAME);
+    close(ready[0]);
+    close(ready[1]);
+}
+
+static void benchSocket(size_t events, size_t subscribers, size_t payloadBytes)
+{
+    using namespace QQDommy;
+    std::vector<int> sockets;
+    for (size_t i = 0; i < subscribers; i++)
+    {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) < 0)
+            exit(1);
+        if (fork() == 0)
+        {
+            close(pair[0]);
+            // the sockets of the former subscribers would not see their end otherwise
+            for (int fd : sockets)
+                close(fd);
+            // the events are framed by their length and copied out of the socket
+            ByteBuffer input;
+            uint64_t next = 1;
+            bool ordered = true;
+            while (true)
+            {
+                input.ensureWritable(1 << 16);
+                ssize_t n = read(pair[1], input.writePointer(), input.writableBytes());
+                if (n <= 0)
+                    break;
+                input.commitWrite(n);
+                while (input.readableBytes() >= 4)
+                {
+                    const uint8_t *at = input.readPointer();
+                    uint32_t length = (uint32_t)at[0] << 24 | at[1] << 16 | at[2] << 8 | at[3];
+                    if (input.readableBytes() < 4 + length)
+                        break;
+                    input.skip(4);
+                    ordered = ordered && input.read_uint64Be() == next;
+                    input.skip(length - 8);
+                    next++;
+                }
+            }
+            _exit(ordered && next == events + 1 ? 0 : 1);
+        }
+        close(pair[1]);
+        sockets.push_back(pair[0]);
+    }
+    ByteBuffer event, frame;
+    uint64_t start = nowNs(), cpuStart = cpuNs();
+    for (uint64_t uin = 1; uin <= events; uin++)
+    {
+        makeEvent(event, uin, payloadBytes);
+        frame.clear();
+        frame.write_uint32(event.readableBytes()).writeBytes(event.readPointer(), event.readableBytes());
+        for (int fd : sockets)
+            if (write(fd, frame.readPointer(), frame.readableBytes()) < 0)
+                exit(1);
+    }
+    for (int fd : sockets)
+        close(fd);
+    uint64_t cpu = cpuNs() - cpuStart;
+    size_t failed = reap(subscribers);
+    uint64_t elapsed = nowNs() - start;
+    printf("socket %10.0f events/s, %7.1f ns publisher cpu/event, %zu subscribers failed\n",
+           events * 1e9 / elapsed, (double)cpu / events, failed);
+}
+
+int main(int args, char **argv)
+{
+    size_t events = args > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t subscribers = args > 2 ? strtoull(argv[2], nullptr, 10) : 2;
+    size_t payloadBytes = args > 3 ? strtoull(argv[3], nullptr, 10) : 64;
+    printf("%zu events of %zu bytes to %zu subscribers\n", events, payloadBytes, subscribers);
+    benchBus(events, subscribers, payloadBytes);
+    benchSocket(events, subscribers, payloadBytes);
+    return 0;
+}
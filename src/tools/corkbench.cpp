@@ -0,0 +1,131 @@
+/**
+ * @file corkbench.cpp
+ * @author maxwellzs
+ * @brief the cost of a burst of small packets with and without the cork of the connection
+ * a client asks over loopback, the server answers every request with a burst of small
+ * frames sent one by one, as the acks and receipts of a bot are
+ * usage : corkbench [rounds] [burst] [frame bytes]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <memory>
+#include <sys/resource.h>
+#include "net/EventLoop.h"
+#include "net/Connection.h"
+#include "net/Acceptor.h"
+#include "core/Frame.h"
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static uint64_t cpuNs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ull +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ull;
+}
+
+/// @brief answers every frame with a burst
+class BurstServer : public QQDommy::ConnectionHandler
+{
+public:
+    size_t burst;
+    size_t frameBytes;
+    QQDommy::ByteBuffer frame;
+    void onMessage(QQDommy::Connection &conn, QQDommy::ByteBuffer &input) override
+    {
+        QQDommy::Frame request;
+        while (QQDommy::FrameCodec::decode(input, request))
+            for (size_t i = 0; i < burst; i++)
+            {
+                frame.clear();
+                std::vector<uint8_t> payload(frameBytes, (uint8_t)i);
+                QQDommy::FrameCodec::encode(frame, request.sequence, 1, payload.data(), payload.size());
+                conn.send(frame);
+            }
+    }
+};
+
+/// @brief asks again once the whole burst arrived
+class BurstClient : public QQDommy::ConnectionHandler
+{
+public:
+    QQDommy::EventLoop &loop;
+    size_t burst;
+    size_t rounds;
+    size_t received = 0;
+    size_t round = 0;
+    QQDommy::ByteBuffer ask;
+    BurstClient(QQDommy::EventLoop &loop) : loop(loop) {}
+    void next(QQDommy::Connection &conn)
+    {
+        ask.clear();
+        QQDommy::FrameCodec::encode(ask, (uint32_t)++round, 0, nullptr, 0);
+        conn.send(ask);
+    }
+    void onConnected(QQDommy::Connection &conn) override { next(conn); }
+    void onMessage(QQDommy::Connection &conn, QQDommy::ByteBuffer &input) override
+    {
+        QQDommy::Frame frame;
+        while (QQDommy::FrameCodec::decode(input, frame))
+            received++;
+        if (received < round * burst)
+            return;
+        if (round == rounds)
+            loop.stop();
+        else
+            next(conn);
+    }
+};
+
+static void bench(size_t rounds, size_t burst, size_t frameBytes, size_t corkBytes)
+{
+    using namespace QQDommy;
+    EventLoop loop;
+    BurstServer serverHandler;
+    serverHandler.burst = burst;
+    serverHandler.frameBytes = frameBytes;
+    std::unique_ptr<Connection> server;
+    Acceptor acceptor(loop, [&](int fd)
+                      {
+        server.reset(new Connection(loop, serverHandler));
+        server->setCork(corkBytes);
+        server->adopt(fd); });
+    uint16_t port = acceptor.listen("127.0.0.1", 0);
+    BurstClient clientHandler(loop);
+    clientHandler.burst = burst;
+    clientHandler.rounds = rounds;
+    Connection client(loop, clientHandler);
+    client.connect("127.0.0.1", port);
+
+    uint64_t start = nowNs(), cpuStart = cpuNs();
+    loop.run();
+    double packets = (double)rounds * burst;
+    const SendStats &stats = server->getSendStats();
+    printf("cork %-8zu %8.3f syscalls/packet, %7.1f ns cpu/packet, %7.1f ns/packet\n", corkBytes,
+           stats.syscallsPerPacket(), (cpuNs() - cpuStart) / packets, (nowNs() - start) / packets);
+    client.close();
+}
+
+int main(int args, char **argv)
+{
+    size_t rounds = args > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+    size_t burst = args > 2 ? strtoull(argv[2], nullptr, 10) : 16;
+    size_t frameBytes = args > 3 ? strtoull(argv[3], nullptr, 10) : 32;
+    printf("%zu rounds of %zu frames of %zu bytes\n", rounds, burst, frameBytes);
+    bench(rounds, burst, frameBytes, 0);
+    bench(rounds, burst, frameBytes, QQDommy::DEFAULT_CORK_BYTES);
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file execbench.cpp
+ * @author maxwellzs
+ * @brief the throughput of the executor decrypting the packets of many sessions
+ * every packet is a tea cipher text moved to a worker, the packets of a session are
+ * decrypted in order, a pool sharing one queue under a mutex is measured alongside
+ * usage : execbench [packets] [sessions] [packet bytes] [max workers]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "net/Executor.h"
+#include "encrypt/Tea.h"
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static const uint8_t KEY[QQDommy::TEA_KEY_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+
+/// @brief the packets of every session, encrypted once before the runs
+static std::vector<QQDommy::ByteBuffer> makePackets(size_t packets, size_t packetBytes)
+{
+    QQDommy::TeaCipher cipher(KEY);
+    std::vector<QQDommy::ByteBuffer> result(packets);
+    std::vector<uint8_t> plain(packetBytes);
+    for (size_t i = 0; i < packets; i++)
+    {
+        for (size_t k = 0; k < packetBytes; k++)
+            plain[k] = (uint8_t)(i + k);
+        cipher.encrypt(result[i], plain.data(), plain.size());
+    }
+    return result;
+}
+
+/// @brief decrypt a packet and check it is the next one of its session
+static void handle(const QQDommy::ByteBuffer &packet, size_t index, std::atomic<size_t> &next, std::atomic<size_t> &disorder)
+{
+    QQDommy::TeaCipher cipher(KEY);
+    QQDommy::ByteBuffer plain;
+    cipher.decrypt(plain, packet.readPointer(), packet.readableBytes());
+    if (next.exchange(index + 1, std::memory_order_relaxed) > index)
+        disorder.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void report(const char *name, size_t workers, size_t packets, uint64_t elapsed, size_t disorder, uint64_t stolen)
+{
+    printf("%-8s %2zu workers %10.0f packets/s, %6zu out of order, %8llu stolen\n", name, workers,
+           packets * 1e9 / elapsed, disorder, (unsigned long long)stolen);
+}
+
+static void benchExecutor(const std::vector<QQDommy::ByteBuffer> &source, size_t sessions, size_t workers)
+{
+    using namespace QQDommy;
+    std::vector<ByteBuffer> packets(source.size());
+    for (size_t i = 0; i < source.size(); i++)
+        packets[i].writeBytes(source[i].readPointer(), source[i].readableBytes());
+    std::unique_ptr<std::atomic<size_t>[]> next(new std::atomic<size_t>[sessions]);
+    for (size_t i = 0; i < sessions; i++)
+        next[i].store(0);
+    std::atomic<size_t> disorder{0}, done{0};
+    uint64_t start = nowNs(), stolen;
+    {
+        Executor executor(workers);
+        for (size_t i = 0; i < packets.size(); i++)
+        {
+            size_t session = i % sessions;
+            executor.submit(session, [packet = std::move(packets[i]), index = i / sessions, &next, session, &disorder, &done]()
+                            {
+                handle(packet, index, next[session], disorder);
+                done.fetch_add(1, std::memory_order_relaxed); });
+        }
+        while (done.load() < packets.size())
+            std::this_thread::yield();
+        stolen = executor.getStats().stolen;
+    }
+    report("executor", workers, packets.size(), nowNs() - start, disorder.load(), stolen);
+}
+
+/// @brief the pool the executor replaces, every worker takes from one locked queue
+static void benchMutex(const std::vector<QQDommy::ByteBuffer> &source, size_t sessions, size_t workers)
+{
+    using namespace QQDommy;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool closed = false;
+    std::unique_ptr<std::atomic<size_t>[]> next(new std::atomic<size_t>[sessions]);
+    for (size_t i = 0; i < sessions; i++)
+        next[i].store(0);
+    std::atomic<size_t> disorder{0};
+    uint64_t start = nowNs();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++)
+        threads.emplace_back([&]()
+                             {
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&]() { return closed || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                job();
+            } });
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        size_t session = i % sessions;
+        // a std::function must be copyable, the packet is shared instead of moved
+        auto packet = std::make_shared<ByteBuffer>();
+        packet->writeBytes(source[i].readPointer(), source[i].readableBytes());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.emplace_back([packet, index = i / sessions, &next, session, &disorder]()
+                               { handle(*packet, index, next[session], disorder); });
+        }
+        ready.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    ready.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+    report("mutex", workers, source.size(), nowNs() - start, disorder.load(), 0);
+}
+
+int main(int args, char **argv)
+{
+    size_t packets = args > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    size_t sessions = args > 2 ? strtoull(argv[2], nullptr, 10) : 1000;
+    size_t packetBytes = args > 3 ? strtoull(argv[3], nullptr, 10) : 256;
+    size_t maxWorkers = args > 4 ? strtoull(argv[4], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency());
+    printf("%zu packets of %zu bytes over %zu sessions\n", packets, packetBytes, sessions);
+    std::vector<QQDommy::ByteBuffer> source = makePackets(packets, packetBytes);
+    for (size_t workers = 1; workers <= maxWorkers; workers *= 2)
+    {
+        benchMutex(source, sessions, workers);
+        benchExecutor(source, sessions, workers);
+    }
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file jsonbench.cpp
+ * @author maxwellzs
+ * @brief compare JsonFactory of JsonCPP with the arena document on a generated friend list
+ * every parse starts from a fresh copy of the text, the time, the allocations and the bytes
+ * allocated per document are printed
+ * the pull reader picks the online friends from the text fed in chunks of 4KB
+ * the status of an account is then built and serialized, and its fields looked up
+ * usage : jsonbench [friends] [iterations]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <new>
+#include <functional>
+#include <algorithm>
+#include "JSON.h"
+#include "json/JsonDocument.h"
+#include "json/JsonReader.h"
+#include "json/JsonWriter.h"
+
+static size_t allocations = 0;
+static size_t allocatedBytes = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    allocatedBytes += size;
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// @brief a friend list as returned by the web api
+static std::string friendList(size_t friends)
+{
+    std::string text = "{\"result\": 0, \"friends\": [";
+    for (size_t i = 0; i < friends; i++)
+    {
+        text += i == 0 ? "" : ",";
+        text += "{\"uin\": " + std::to_string(10000 + i) + ", \"nick\": \"friend " + std::to_string(i) +
+                "\", \"remark\": \"met at \\\"school\\\"\", \"groupId\": " + std::to_string(i % 8) +
+                ", \"online\": " + (i % 3 == 0 ? "true" : "false") + ", \"level\": 1.5, \"tags\": [\"a\", \"b\"]}";
+    }
+    text += "]}";
+    return text;
+}
+
+/**
+ * @brief parse the text again and again and print the cost of one parse
+ *
+ * @param name the name of the parser
+ * @param text the text, copied before every parse
+ * @param iterations the number of parses
+ * @param parse parse the copy and release the document
+ */
+static void bench(const char *name, const std::string &text, size_t iterations, const std::function<void(char *, size_t)> &parse)
+{
+    std::vector<char> copy(text.size());
+    size_t startAllocations = allocations, startBytes = allocatedBytes;
+    uint64_t start = nowNs();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        memcpy(copy.data(), text.data(), text.size());
+        parse(copy.data(), copy.size());
+    }
+    double seconds = (nowNs() - start) / 1e9;
+    printf("%-10s %9.1f us/doc %8.1f MB/s %9.1f allocs/doc %10.1f KB/doc\n", name,
+           seconds * 1e6 / iterations, text.size() * iterations / seconds / 1e6,
+           (double)(allocations - startAllocations) / iterations,
+           (double)(allocatedBytes - startBytes) / iterations / 1024);
+}
+
+int main(int args, char **argv)
+{
+    size_t friends = args > 1 ? strtoull(argv[1], nullptr, 10) : 2000;
+    size_t iterations = args > 2 ? strtoull(argv[2], nullptr, 10) : 200;
+    std::string text = friendList(friends);
+    printf("%zu friends, %zu bytes\n", friends, text.size());
+
+    size_t checksum = 0;
+    bench("JsonCPP", text, iterations, [&checksum](char *buf, size_t size)
+          {
+        JsonCPP::JsonObject *object = JsonCPP::JsonFactory::CreateJsonObject(buf, (int)size);
+        checksum += object->Size();
+        delete object; });
+    {
+        // the document is kept, its arena is reused by the next parse
+        QQDommy::JsonDocument document;
+        size_t arena = 0;
+        bench("in situ", text, iterations, [&](char *buf, size_t size)
+              {
+            checksum += document.parseInSitu(buf, size)["friends"].size();
+            arena = document.getArenaUsed(); });
+        printf("in situ arena %.1f KB/doc\n", arena / 1024.0);
+    }
+    bench("fresh doc", text, iterations, [&checksum](char *buf, size_t size)
+          {
+        QQDommy::JsonDocument document;
+        checksum += document.parseInSitu(buf, size)["friends"].size(); });
+    {
+        // only the uin of the online friends is picked, the rest is skipped
+        QQDommy::JsonReader reader;
+        size_t buffered = 0;
+        bench("reader", text, iterations, [&](char *buf, size_t size)
+              {
+            reader.reset();
+            size_t fed = 0;
+            int64_t uin = 0;
+            std::string key;
+            while (true)
+            {
+                QQDommy::JSON_EVENT event = reader.next();
+                if (event == QQDommy::JSON_EVENT_MORE)
+                {
+                    size_t chunk = std::min((size_t)4096, size - fed);
+                    reader.feed(buf + fed, chunk);
+                    fed += chunk;
+                    buffered = std::max(buffered, reader.buffered());
+                    continue;
+                }
+                if (event == QQDommy::JSON_EVENT_END)
+                    break;
+                // the value of a key may be in the next chunk, the key is remembered
+                if (event == QQDommy::JSON_EVENT_KEY && reader.depth() == 3)
+                {
+                    key = reader.text();
+                    if (key != "uin" && key != "online")
+                        reader.skip();
+                }
+                else if (event == QQDommy::JSON_EVENT_INTEGER && key == "uin")
+                    uin = reader.integer();
+                else if (event == QQDommy::JSON_EVENT_BOOLEAN && key == "online")
+                    checksum += reader.boolean() ? uin : 0;
+            } });
+        printf("reader buffered at most %zu bytes\n", buffered);
+    }
+    {
+        // the status of an account, as served to the dashboard
+        const char *keys[] = {"uin", "nick", "online", "status", "heartbeat", "sent", "received", "pending", "latency", "groups", "error", "version"};
+        size_t rounds = iterations * 100;
+        size_t startAllocations = allocations;
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < rounds; i++)
+        {
+            JsonCPP::JsonObject status;
+            std::string name;
+            name = keys[0], status.SetField(name, new JsonCPP::JsonInteger(10000 + (int)i));
+            name = keys[1], status.SetField(name, new JsonCPP::JsonString("account \"main\""));
+            name = keys[2], status.SetField(name, new JsonCPP::JsonBoolean(true));
+            name = keys[3], status.SetField(name, new JsonCPP::JsonString("online"));
+            name = keys[4], status.SetField(name, new JsonCPP::JsonInteger((int)i * 1000));
+            name = keys[5], status.SetField(name, new JsonCPP::JsonInteger((int)i));
+            name = keys[6], status.SetField(name, new JsonCPP::JsonInteger((int)i * 2));
+            name = keys[7], status.SetField(name, new JsonCPP::JsonInteger(3));
+            name = keys[8], status.SetField(name, new JsonCPP::JsonFloat(1.25f));
+            JsonCPP::JsonArray *groups = new JsonCPP::JsonArray();
+            for (int g = 0; g < 4; g++)
+                groups->AppendElement(*new JsonCPP::JsonInteger(g));
+            name = keys[9], status.SetField(name, groups);
+            name = keys[10], status.SetField(name, new JsonCPP::JsonNull());
+            name = keys[11], status.SetField(name, new JsonCPP::JsonString("0.1"));
+            checksum += status.ToString().size();
+        }
+        double seconds = (nowNs() - start) / 1e9;
+        printf("%-10s %9.2f us/status %9.1f allocs/status\n", "JsonCPP", seconds * 1e6 / rounds, (double)(allocations - startAllocations) / rounds);
+
+        QQDommy::ByteBuffer out(512);
+        startAllocations = allocations;
+        start = nowNs();
+        for (size_t i = 0; i < rounds; i++)
+        {
+            out.clear();
+            QQDommy::JsonWriter writer(out);
+            writer.beginObject()
+                .field(keys[0], 10000 + i)
+                .field(keys[1], "account \"main\"")
+                .field(keys[2], true)
+                .field(keys[3], "online")
+                .field(keys[4], i * 1000)
+                .field(keys[5], i)
+                .field(keys[6], i * 2)
+                .field(keys[7], 3)
+                .field(keys[8], 1.25)
+                .key(keys[9])
+                .beginArray().value(0).value(1).value(2).value(3).endArray()
+                .key(keys[10])
+                .null()
+                .field(keys[11], "0.1")
+                .endObject();
+            checksum += out.readableBytes();
+        }
+        seconds = (nowNs() - start) / 1e9;
+        printf("%-10s %9.2f us/status %9.1f allocs/status\n", "writer", seconds * 1e6 / rounds, (double)(allocations - startAllocations) / rounds);
+
+        // every field looked up in the map of JsonCPP and in the index of the document
+        std::string text((const char *)out.readPointer(), out.readableBytes());
+        JsonCPP::JsonObject *object = JsonCPP::JsonFactory::CreateJsonObject(text.data(), (int)text.size());
+        QQDommy::JsonDocument document;
+        const QQDommy::JsonValue &root = document.parse(text);
+        std::vector<std::string> names(keys, keys + 12);
+        start = nowNs();
+        for (size_t i = 0; i < rounds; i++)
+            for (std::string &name : names)
+                checksum += (*object)[name].GetType();
+        seconds = (nowNs() - start) / 1e9;
+        printf("%-10s %9.1f ns/lookup\n", "JsonCPP", seconds * 1e9 / rounds / names.size());
+        start = nowNs();
+        for (size_t i = 0; i < rounds; i++)
+            for (std::string &name : names)
+                checksum += root[name].getType();
+        seconds = (nowNs() - start) / 1e9;
+        printf("%-10s %9.1f ns/lookup\n", "document", seconds * 1e9 / rounds / names.size());
+        delete object;
+    }
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file loadgen.cpp
+ * @author maxwellzs
+ * @brief benchmark the stack against the mock server over loopback
+ * usage : loadgen [clients] [messages per client] [push burst] [trace file] [trace one flow in]
+ * with a trace file the sampled flows are written for chrome://tracing or perfetto
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <sys/resource.h>
+#include "mock/MockServer.h"
+#include "mock/LoadGenerator.h"
+#include "utils/Tracing.h"
+#include "utils/MetricsExport.h"
+
+int main(int args, char **argv)
+{
+    using namespace QQDommy;
+    LoadConfig load;
+    MockServerConfig serverConfig;
+    if (args > 1)
+        load.clients = strtoull(argv[1], nullptr, 10);
+    if (args > 2)
+        load.messagesPerClient = strtoull(argv[2], nullptr, 10);
+    if (args > 3)
+        serverConfig.pushBurst = strtoull(argv[3], nullptr, 10);
+    if (args > 4)
+        Tracer::setSampling(args > 5 ? (uint32_t)strtoul(argv[5], nullptr, 10) : 100);
+
+    // both ends of every connection live in this process
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    EventLoop serverLoop;
+    MockServer server(serverLoop, serverConfig);
+    load.port = server.listen(load.ip, 0);
+    std::thread serverThread([&serverLoop]()
+                             {
+        Tracer::nameThread("server loop");
+        serverLoop.run(); });
+    Tracer::nameThread("client loop");
+
+    EventLoop clientLoop;
+    LoadGenerator generator(clientLoop, load);
+    LoadReport report = generator.run();
+    serverLoop.stop();
+    serverThread.join();
+
+    const MockServerStats &stats = server.getStats();
+    printf("%s\n", report.toString().c_str());
+    printf("server : connections %llu, logins %llu, messages %llu, pushes %llu, push acks %llu\n",
+           (unsigned long long)stats.connections.load(), (unsigned long long)stats.logins.load(),
+           (unsigned long long)stats.messages.load(), (unsigned long long)stats.pushes.load(),
+           (unsigned long long)stats.pushAcks.load());
+    // both ends write through the connections, the cork shows in the syscalls per packet
+    uint64_t packets = 0, syscalls = 0;
+    for (const CounterSnapshot &counter : Metrics::snapshot().counters)
+        if (counter.name == "connection_packets_sent_total")
+            packets = counter.value;
+        else if (counter.name == "connection_send_syscalls_total")
+            syscalls = counter.value;
+    printf("sends : %llu packets in %llu syscalls, %.3f per packet\n", (unsigned long long)packets,
+           (unsigned long long)syscalls, packets > 0 ? (double)syscalls / packets : 0);
+    if (args > 4)
+    {
+        std::vector<TraceEvent> events = Tracer::collect();
+        ByteBuffer trace;
+        Tracer::toChrome(events, trace);
+        MetricsExport::writeFile(argv[4], trace);
+        printf("trace : %zu events written to %s\n", events.size(), argv[4]);
+    }
+    return report.failed == 0 ? 0 : 1;
+}
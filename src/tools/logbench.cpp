@@ -0,0 +1,179 @@
+/**
+ * @file logbench.cpp
+ * @author maxwellzs
+ * @brief compare the queue of the asynchronous logger of LogCPP with the ring logger
+ * every thread logs the same message as fast as it can, the time of every call is
+ * recorded to show the tail latency the callers see
+ * it also measures the binary mode, the rendering of a line and a debug log dropped by the level filter
+ * usage : logbench [threads] [messages per thread]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "Loggers.h"
+#include "Global.h"
+#include "utils/ByteBuffer.h"
+
+/// @brief writes nothing, only the cost of the queue is measured
+class NullStream : public LogCPP::BaseStream
+{
+public:
+    size_t lines = 0;
+    LogCPP::BaseStream &operator<<(const std::string &content) override
+    {
+        lines++;
+        return *this;
+    }
+};
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief run the producers and print the result
+ *
+ * @param name the name of the queue
+ * @param threads the number of producers
+ * @param messages the messages of each producer
+ * @param submit log one message
+ * @param finish block until every message is consumed
+ */
+static void bench(const char *name, size_t threads, size_t messages,
+                  const std::function<void(const std::string &)> &submit, const std::function<void()> &finish)
+{
+    std::vector<std::vector<uint32_t>> latencies(threads);
+    std::vector<std::thread> producers;
+    uint64_t start = nowNs();
+    for (size_t t = 0; t < threads; t++)
+        producers.emplace_back([&, t]()
+                               {
+            std::string msg = "packet 0x0810 from 10000 handled in 35 us, session key rotated, thread " + std::to_string(t);
+            std::vector<uint32_t> &own = latencies[t];
+            own.reserve(messages);
+            for (size_t i = 0; i < messages; i++)
+            {
+                uint64_t begin = nowNs();
+                submit(msg);
+                own.push_back((uint32_t)(nowNs() - begin));
+            } });
+    for (std::thread &producer : producers)
+        producer.join();
+    uint64_t submitted = nowNs();
+    finish();
+    uint64_t end = nowNs();
+
+    std::vector<uint32_t> all;
+    for (auto &own : latencies)
+        all.insert(all.end(), own.begin(), own.end());
+    std::sort(all.begin(), all.end());
+    auto at = [&all](double q)
+    { return (unsigned long long)all[(size_t)(q * (all.size() - 1))]; };
+    double seconds = (end - start) / 1e9;
+    printf("%-8s threads %2zu : %10.0f msg/s, submit %.3f s, drained %.3f s, call ns p50 %llu p99 %llu p999 %llu max %llu\n",
+           name, threads, threads * messages / seconds, (submitted - start) / 1e9, seconds,
+           at(0.5), at(0.99), at(0.999), (unsigned long long)all.back());
+}
+
+int main(int args, char **argv)
+{
+    size_t threads = args > 1 ? strtoull(argv[1], nullptr, 10) : 4;
+    size_t messages = args > 2 ? strtoull(argv[2], nullptr, 10) : 200000;
+    size_t total = threads * messages;
+
+    {
+        // the queue of LogCPP with a daemon pulling from it
+        LogCPP::SynchronizedMessageQueue queue;
+        NullStream sink;
+        std::thread daemon([&]()
+                           {
+            while (sink.lines < total)
+                for (const std::string &msg : queue.PullMessage())
+                    sink << msg; });
+        bench("LogCPP", threads, messages, [&queue](const std::string &msg)
+              { queue.SubmitMessage(msg); }, [&daemon]()
+              { daemon.join(); });
+    }
+    {
+        QQDommy::RingLogger logger;
+        NullStream *sink = new NullStream();
+        logger.AddStream(sink);
+        logger.Start();
+        bench("ring", threads, messages, [&logger](const std::string &msg)
+              { logger.Log(LogCPP::INFO, msg); }, [&logger]()
+              { logger.SafeDelete(); });
+        printf("ring wakeups %llu for %zu messages\n", (unsigned long long)logger.getRing().getWakeups(), sink->lines);
+    }
+    {
+        // the binary mode, the daemon of the logger formats the records
+        QQDommy::RingLogger logger;
+        NullStream *sink = new NullStream();
+        logger.AddStream(sink);
+        logger.Start();
+        QQDommy::BinaryLog::setTarget(&logger);
+        bench("binary", threads, messages, [](const std::string &msg)
+              { INFO_BIN("packet 0x%04x from %llu handled in %d us, session key rotated", 0x0810, 10000ULL, 35); }, [&logger]()
+              { logger.SafeDelete(); });
+        printf("binary lines %zu\n", sink->lines);
+    }
+    {
+        // rendering a line, the element chain of LogCPP against the compiled layout
+        std::string msg = "packet 0x0810 from 10000 handled in 35 us";
+        std::string line;
+        LogCPP::LevelElement *levels[QQDommy::LEVEL_COUNT];
+        for (size_t i = 0; i < QQDommy::LEVEL_COUNT; i++)
+            levels[i] = new LogCPP::LevelElement((LogCPP::LEVELS)i);
+        std::vector<LogCPP::BaseElement *> chain = {new LogCPP::ConstantStringElement("::"),
+                                                    new LogCPP::TimeElement("%y-%m-%d %H:%M:%S"),
+                                                    new LogCPP::ConstantStringElement("::")};
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < total; i++)
+        {
+            line.clear();
+            levels[LogCPP::INFO]->CompileElement(line);
+            for (LogCPP::BaseElement *element : chain)
+                element->CompileElement(line);
+            line += msg;
+        }
+        double chainNs = (double)(nowNs() - start) / total;
+
+        std::vector<LogCPP::BaseElement *> elements = {new LogCPP::ConstantStringElement("::"),
+                                                       new QQDommy::RecordTimeElement("%y-%m-%d %H:%M:%S"),
+                                                       new LogCPP::ConstantStringElement("::")};
+        QQDommy::LogLayout layout;
+        layout.compile((LogCPP::BaseElement *const *)levels, elements);
+        QQDommy::TscCalibration calibration = QQDommy::TscClock::calibration();
+        start = nowNs();
+        for (size_t i = 0; i < total; i++)
+        {
+            line.clear();
+            layout.render(line, LogCPP::INFO, calibration.toRealtimeNs(QQDommy::TscClock::now()), msg.data(), msg.size());
+        }
+        printf("line rendering : element chain %.1f ns, layout %.1f ns\n", chainNs, (double)(nowNs() - start) / total);
+    }
+    {
+        // the cost of a debug log nobody wants, the hex dump must not be built
+        using QQDommy::operator""_hex;
+        QQDommy::ByteBuffer packet;
+        packet.writeBytes("1A 2B 3C 4D 5E 6E 1A 2B 3C 4D 5E 6E"_hex);
+        QQDommy::LogFilter::setMinimum(LogCPP::INFO);
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < total; i++)
+            DEBUG_ASYN(packet.toHexString());
+        printf("filtered debug log : %.2f ns per call\n", (double)(nowNs() - start) / total);
+    }
+    return 0;
+}
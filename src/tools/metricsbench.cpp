@@ -0,0 +1,92 @@
+/**
+ * @file metricsbench.cpp
+ * @author maxwellzs
+ * @brief the cost of one event of the metrics against a counter shared by the threads
+ * every thread updates the same metric in a loop, the time per event is printed,
+ * then the snapshot is merged and exported in both text formats
+ * usage : metricsbench [threads] [events per thread] [prometheus file or pipe]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include "utils/Metrics.h"
+#include "utils/MetricsExport.h"
+
+static const QQDommy::Counter benchEvents("bench_events_total", "events of the benchmark");
+static const QQDommy::Histogram benchValues("bench_values", "values of the benchmark");
+static const QQDommy::Histogram benchTimes("bench_scope_ns", "empty scopes timed by the benchmark", QQDommy::UNIT_TICKS);
+static std::atomic<uint64_t> shared{0};
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief run the event on every thread and print the time of one event
+ *
+ * @param name the name of the event
+ * @param threads the number of threads
+ * @param events the events per thread
+ * @param event the event, given its index
+ */
+static void bench(const char *name, size_t threads, size_t events, const std::function<void(size_t)> &event)
+{
+    std::vector<std::thread> workers;
+    uint64_t start = nowNs();
+    for (size_t t = 0; t < threads; t++)
+        workers.emplace_back([&]
+                             {
+            for (size_t i = 0; i < events; i++)
+                event(i); });
+    for (std::thread &worker : workers)
+        worker.join();
+    double ns = (double)(nowNs() - start);
+    printf("%-12s %8.2f ns/event (wall / events of one thread)\n", name, ns / events);
+}
+
+int main(int args, char **argv)
+{
+    size_t threads = args > 1 ? strtoull(argv[1], nullptr, 10) : 4;
+    size_t events = args > 2 ? strtoull(argv[2], nullptr, 10) : 20000000;
+    printf("%zu threads, %zu events each\n", threads, events);
+    // the std::function call is in every line, the empty event is the baseline
+    bench("empty", threads, events, [](size_t) {});
+    bench("shared", threads, events, [](size_t)
+          { shared.fetch_add(1, std::memory_order_relaxed); });
+    bench("counter", threads, events, [](size_t)
+          { benchEvents.add(); });
+    bench("histogram", threads, events, [](size_t i)
+          { benchValues.record(i & 0xfff); });
+    bench("timer", threads, events, [](size_t)
+          { QQDommy::ScopedTimer timer(benchTimes); });
+
+    uint64_t start = nowNs();
+    QQDommy::MetricsSnapshot snapshot = QQDommy::Metrics::snapshot();
+    QQDommy::ByteBuffer json, prometheus;
+    QQDommy::MetricsExport::toJson(snapshot, json);
+    QQDommy::MetricsExport::toPrometheus(snapshot, prometheus);
+    printf("snapshot and export %.1f us, json %zu bytes, prometheus %zu bytes\n",
+           (nowNs() - start) / 1e3, json.readableBytes(), prometheus.readableBytes());
+    for (const QQDommy::CounterSnapshot &counter : snapshot.counters)
+        if (counter.name == "bench_events_total")
+            printf("%s %llu\n", counter.name.c_str(), (unsigned long long)counter.value);
+    for (const QQDommy::HistogramSnapshot &histogram : snapshot.histograms)
+        printf("%-14s count %llu p50 %.0f p99 %.0f\n", histogram.name.c_str(),
+               (unsigned long long)histogram.count, histogram.percentile(0.5), histogram.percentile(0.99));
+    if (args > 3)
+        QQDommy::MetricsExport::writeFile(argv[3], prometheus);
+    return 0;
+}
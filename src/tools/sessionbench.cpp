@@ -0,0 +1,85 @@
+/**
+ * @file sessionbench.cpp
+ * @author maxwellzs
+ * @brief the time a restarted host takes to resume its sessions from the store
+ * the sessions of many accounts are saved, the store is closed and opened again,
+ * then every session is loaded and its sequence bound as a resumed client would
+ * usage : sessionbench [accounts] [path]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "core/SessionStore.h"
+#include "core/Multiplexer.h"
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int main(int args, char **argv)
+{
+    using namespace QQDommy;
+    size_t accounts = args > 1 ? strtoull(argv[1], nullptr, 10) : 10000;
+    const char *path = args > 2 ? argv[2] : "sessionbench.store";
+    ::remove(path);
+
+    uint64_t start = nowNs();
+    {
+        SessionStore store(path, accounts);
+        SessionState state;
+        // the sizes of the tokens of a real login
+        state.tgtLength = 72;
+        state.d2Length = 136;
+        for (size_t i = 0; i < accounts; i++)
+        {
+            state.uin = 10000 + i;
+            memset(state.tgt, (int)i, state.tgtLength);
+            memset(state.d2, (int)i, state.d2Length);
+            store.save(state);
+            store.sequence(state.uin).store((uint32_t)i, std::memory_order_relaxed);
+        }
+    }
+    printf("%-24s %8.2f ms for %zu accounts\n", "save and close", (nowNs() - start) / 1e6, accounts);
+
+    start = nowNs();
+    SessionStore store(path, accounts);
+    double opened = (nowNs() - start) / 1e6;
+    size_t resumed = 0;
+    SessionState state;
+    for (uint64_t uin : store.accounts())
+    {
+        if (!store.load(uin, state))
+            continue;
+        SequenceMultiplexer mux(16);
+        mux.bindSequence(store.sequence(uin));
+        resumed += mux.nextSequence() != 0;
+    }
+    printf("%-24s %8.2f ms\n", "open", opened);
+    printf("%-24s %8.2f ms for %zu sessions\n", "open and resume", (nowNs() - start) / 1e6, resumed);
+
+    std::atomic<uint32_t> &sequence = store.sequence(10000);
+    const size_t rounds = 10000000;
+    start = nowNs();
+    for (size_t i = 0; i < rounds; i++)
+        sequence.fetch_add(1, std::memory_order_relaxed);
+    printf("%-24s %8.2f ns\n", "advance a sequence", (nowNs() - start) / (double)rounds);
+
+    start = nowNs();
+    for (size_t i = 0; i < accounts; i++)
+    {
+        state.uin = 10000 + i;
+        store.save(state);
+    }
+    printf("%-24s %8.2f us\n", "save", (nowNs() - start) / 1e3 / accounts);
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file stringbench.cpp
+ * @author maxwellzs
+ * @brief the speed of the utf-8 validation and of the length prefixed strings
+ * the scalar and the vectorized validation run over ascii and chinese text, then
+ * the nicknames of a friend list are read as views and as copies
+ * usage : stringbench [megabytes] [rounds]
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright GNU
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <functional>
+#include "utils/ByteBuffer.h"
+#include "utils/Utf8.h"
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// @brief repeat a piece of text up to the given size
+static std::string text(const char *piece, size_t size)
+{
+    std::string result;
+    while (result.size() < size)
+        result += piece;
+    return result;
+}
+
+static void bench(const char *name, const std::string &input, size_t rounds, const std::function<bool(const char *, size_t)> &validate)
+{
+    bool valid = true;
+    uint64_t start = nowNs();
+    for (size_t i = 0; i < rounds; i++)
+        valid &= validate(input.data(), input.size());
+    double seconds = (nowNs() - start) / 1e9;
+    printf("%-16s %8.2f GB/s valid %d\n", name, input.size() * rounds / seconds / 1e9, valid);
+}
+
+int main(int args, char **argv)
+{
+    size_t megabytes = args > 1 ? strtoull(argv[1], nullptr, 10) : 1;
+    size_t rounds = args > 2 ? strtoull(argv[2], nullptr, 10) : 1000;
+    printf("%zu MB of text, %zu rounds, vectorized %d\n", megabytes, rounds, QQDommy::Utf8::vectorized());
+    std::string ascii = text("hello from the load generator ", megabytes << 20);
+    std::string chinese = text("你好，这是一条来自群聊的消息 ok ", megabytes << 20);
+    bench("ascii scalar", ascii, rounds, QQDommy::Utf8::validateScalar);
+    bench("ascii", ascii, rounds, QQDommy::Utf8::validate);
+    bench("chinese scalar", chinese, rounds, QQDommy::Utf8::validateScalar);
+    bench("chinese", chinese, rounds, QQDommy::Utf8::validate);
+
+    // a friend list of nicknames, each after its u16 length
+    QQDommy::ByteBuffer list;
+    const size_t friends = 10000;
+    for (size_t i = 0; i < friends; i++)
+        list.writeString<uint16_t>("好友 " + std::to_string(i) + " 的昵称");
+    size_t checksum = 0;
+    uint64_t start = nowNs();
+    for (size_t round = 0; round < rounds; round++)
+    {
+        QQDommy::ByteBuffer view = QQDommy::ByteBuffer::wrap(list.readPointer(), list.readableBytes());
+        for (size_t i = 0; i < friends; i++)
+            checksum += view.readString<uint16_t>(true).size();
+    }
+    printf("%-16s %8.1f ns/string\n", "view", (nowNs() - start) / (double)(rounds * friends));
+    start = nowNs();
+    for (size_t round = 0; round < rounds; round++)
+    {
+        QQDommy::ByteBuffer view = QQDommy::ByteBuffer::wrap(list.readPointer(), list.readableBytes());
+        for (size_t i = 0; i < friends; i++)
+        {
+            std::string copy(view.readString<uint16_t>(true));
+            checksum += copy.size();
+        }
+    }
+    printf("%-16s %8.1f ns/string\n", "copy", (nowNs() - start) / (double)(rounds * friends));
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "utils/Arena.h"
+
+QQDommy::Arena::Arena(size_t blockSize) : blockSize(blockSize)
+{
+}
+
+QQDommy::Arena::~Arena()
+{
+    for (Block &block : blocks)
+        delete[] block.data;
+}
+
+void *QQDommy::Arena::grow(size_t size, size_t align)
+{
+    size_t needed = size + align;
+    size_t capacity = needed > blockSize ? needed : blockSize;
+    char *data = new char[capacity];
+    blocks.push_back({data, capacity});
+    uintptr_t at = ((uintptr_t)data + align - 1) & ~(uintptr_t)(align - 1);
+    // an oversized block is used up at once, the last block keeps serving the small allocations
+    if (needed <= blockSize || cursor == nullptr)
+    {
+        cursor = (char *)(at + size);
+        limit = data + capacity;
+    }
+    used += size;
+    return (void *)at;
+}
+
+void QQDommy::Arena::reset()
+{
+    if (blocks.empty())
+        return;
+    if (blocks.size() > 1)
+    {
+        // one block as large as all of them, the next use of the same size allocates nothing
+        size_t reserved = getReserved();
+        for (Block &block : blocks)
+            delete[] block.data;
+        blocks.clear();
+        blocks.push_back({new char[reserved], reserved});
+    }
+    cursor = blocks[0].data;
+    limit = blocks[0].data + blocks[0].size;
+    used = 0;
+}
+
+size_t QQDommy::Arena::getUsed() const
+{
+    return used;
+}
+
+size_t QQDommy::Arena::getReserved() const
+{
+    size_t reserved = 0;
+    for (const Block &block : blocks)
+        reserved += block.size;
+    return reserved;
+}
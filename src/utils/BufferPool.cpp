@@ -0,0 +1,37 @@
+#include "utils/BufferPool.h"
+
+QQDommy::BufferPool::BufferPool(size_t bufferSize, size_t limit)
+    : bufferSize(bufferSize), limit(limit)
+{
+    freeBuffers.reserve(limit);
+}
+
+QQDommy::ByteBuffer QQDommy::BufferPool::acquire()
+{
+    if (freeBuffers.empty())
+    {
+        allocated++;
+        return ByteBuffer(bufferSize);
+    }
+    ByteBuffer buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void QQDommy::BufferPool::release(ByteBuffer &&buffer)
+{
+    if (buffer.readOnly() || freeBuffers.size() >= limit)
+        return;
+    buffer.clear();
+    freeBuffers.push_back(std::move(buffer));
+}
+
+size_t QQDommy::BufferPool::freeCount() const
+{
+    return freeBuffers.size();
+}
+
+size_t QQDommy::BufferPool::allocatedCount() const
+{
+    return allocated;
+}
@@ -1,14 +1,25 @@
 #include "utils/ByteBuffer.h"
+#include "utils/Metrics.h"
 
-void QQDommy::ByteBuffer::resize()
+static const QQDommy::Counter resizes("bytebuffer_resizes_total", "reallocations of the byte buffers");
+static const QQDommy::Counter compactions("bytebuffer_compactions_total", "unread bytes moved to the front of a buffer");
+static const QQDommy::Counter copiedBytes("bytebuffer_copied_bytes_total", "bytes copied by the reallocations and the compactions");
+
+void QQDommy::ByteBuffer::resize(size_t required)
 {
-    size_t newSize = capacity * 2;
+    // a moved from buffer has no capacity left
+    size_t newSize = capacity == 0 ? DEFAULT_BUFFER_SIZE : capacity * 2;
+    while (newSize < required)
+        newSize *= 2;
     uint8_t *newBuffer = new uint8_t[newSize];
     // only copy the part with original data
     memcpy(newBuffer, data, writeIndex);
+    resizes.add();
+    copiedBytes.add(writeIndex);
     // delete the previous
-    delete data;
+    delete[] data;
     data = newBuffer;
+    capacity = newSize;
 }
 
 void QQDommy::ByteBuffer::check_readOnly()
@@ -29,7 +40,7 @@ void QQDommy::ByteBuffer::check_resize(size_t s)
     {
         // out of bound
         // operate resize instantly
-        resize();
+        resize(s + writeIndex);
     }
 }
 
@@ -40,11 +51,51 @@ QQDommy::ByteBuffer::ByteBuffer()
     this->data = new uint8_t[DEFAULT_BUFFER_SIZE];
 }
 
+QQDommy::ByteBuffer::ByteBuffer(size_t initialCapacity)
+{
+    capacity = initialCapacity == 0 ? DEFAULT_BUFFER_SIZE : initialCapacity;
+    this->data = new uint8_t[capacity];
+}
+
+QQDommy::ByteBuffer::ByteBuffer(const uint8_t *view, size_t length)
+{
+    // a view never writes, the const is only dropped to share the member
+    data = const_cast<uint8_t *>(view);
+    writeIndex = length;
+    capacity = length;
+    isReadOnly = true;
+}
+
 QQDommy::ByteBuffer::~ByteBuffer()
 {
     // initialize buffer
     if (!isReadOnly && data != nullptr)
-        delete data;
+        delete[] data;
+}
+
+QQDommy::ByteBuffer::ByteBuffer(ByteBuffer &&other) noexcept
+    : data(other.data), readIndex(other.readIndex), writeIndex(other.writeIndex),
+      capacity(other.capacity), isReadOnly(other.isReadOnly)
+{
+    // the other buffer no longer owns the memory
+    other.data = nullptr;
+    other.readIndex = other.writeIndex = other.capacity = 0;
+}
+
+QQDommy::ByteBuffer &QQDommy::ByteBuffer::operator=(ByteBuffer &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+    if (!isReadOnly && data != nullptr)
+        delete[] data;
+    data = other.data;
+    readIndex = other.readIndex;
+    writeIndex = other.writeIndex;
+    capacity = other.capacity;
+    isReadOnly = other.isReadOnly;
+    other.data = nullptr;
+    other.readIndex = other.writeIndex = other.capacity = 0;
+    return *this;
 }
 
 #define check_before_write  \
@@ -152,25 +203,22 @@ std::string QQDommy::ByteBuffer::toHexString()
 
 QQDommy::ByteBuffer &QQDommy::ByteBuffer::writeHexString(const std::string &expr)
 {
-    // TODO: 在此处插入 return 语句
-    std::string word;
-    std::istringstream reader(expr);
-
-    while (reader >> word)
+    // the constants known at compile time are better written with _hex
+    size_t length = expr.size();
+    for (size_t i = 0; i < length;)
     {
-        // loop hex
-        // hex should be in pair
-        if (word.length() != 2)
-            throw IllegalHexExprException(expr);
-        if (HEX_VAL.find(word.at(0)) == HEX_VAL.end() || HEX_VAL.find(word.at(0)) == HEX_VAL.end())
+        if (isHexSpace(expr[i]))
+        {
+            i++;
+            continue;
+        }
+        // every word is one pair of digits
+        if (i + 1 >= length || hexValue(expr[i]) < 0 || hexValue(expr[i + 1]) < 0 ||
+            (i + 2 < length && !isHexSpace(expr[i + 2])))
             throw IllegalHexExprException(expr);
-        // not male formed
-        int8_t h4 = HEX_VAL.at(word.at(0));
-        int8_t l4 = HEX_VAL.at(word.at(1));
-        write_uint8(l4 + (h4 << 4));
+        write_uint8((uint8_t)(hexValue(expr[i]) << 4 | hexValue(expr[i + 1])));
+        i += 2;
     }
-
-    // noerror
     return *this;
 }
 
@@ -187,9 +235,9 @@ QQDommy::ByteBuffer &QQDommy::ByteBuffer::writeByteVector(const std::vector<uint
 QQDommy::ByteBuffer &QQDommy::ByteBuffer::writeBuffer(ByteBuffer &ref)
 {
     // TODO: 在此处插入 return 语句
-    while(ref.readIndex < ref.writeIndex) {
-        write_uint8(ref.read_uint8());
-    }
+    size_t length = ref.readableBytes();
+    writeBytes(ref.readPointer(), length);
+    ref.skip(length);
     return *this;
 }
 
@@ -200,17 +248,18 @@ QQDommy::ByteBuffer QQDommy::ByteBuffer::slice(size_t length)
 
 QQDommy::ByteBuffer QQDommy::ByteBuffer::slice(size_t offset, size_t length)
 {
-    ByteBuffer inherit;
     // illegal operation, reaching the limit of the buffer
     if (offset >= writeIndex ||
         length == 0 ||
         length + offset >= writeIndex)
         throw BufferOutOfBoundException();
-    inherit.data = this->data + offset;
-    inherit.writeIndex = length;
     // no writing the read only
-    inherit.isReadOnly = true;
-    return inherit;
+    return ByteBuffer(this->data + offset, length);
+}
+
+QQDommy::ByteBuffer QQDommy::ByteBuffer::wrap(const uint8_t *src, size_t length)
+{
+    return ByteBuffer(src, length);
 }
 
 QQDommy::ByteBuffer &QQDommy::ByteBuffer::doVisit(const BufferVisitor &visitor)
@@ -221,6 +270,102 @@ QQDommy::ByteBuffer &QQDommy::ByteBuffer::doVisit(const BufferVisitor &visitor)
     return *this;
 }
 
+size_t QQDommy::ByteBuffer::readableBytes() const
+{
+    return writeIndex - readIndex;
+}
+
+size_t QQDommy::ByteBuffer::writableBytes() const
+{
+    return capacity - writeIndex;
+}
+
+const uint8_t *QQDommy::ByteBuffer::readPointer() const
+{
+    return data + readIndex;
+}
+
+uint8_t *QQDommy::ByteBuffer::writePointer()
+{
+    return data + writeIndex;
+}
+
+QQDommy::ByteBuffer &QQDommy::ByteBuffer::ensureWritable(size_t length)
+{
+    check_readOnly();
+    if (writableBytes() >= length)
+        return *this;
+    // reuse the consumed head before asking for more memory
+    if (readIndex > 0 && capacity - readableBytes() >= length)
+    {
+        compact();
+        return *this;
+    }
+    resize(writeIndex + length);
+    return *this;
+}
+
+QQDommy::ByteBuffer &QQDommy::ByteBuffer::commitWrite(size_t length)
+{
+    if (length > writableBytes())
+        throw BufferOutOfBoundException();
+    writeIndex += length;
+    return *this;
+}
+
+QQDommy::ByteBuffer &QQDommy::ByteBuffer::skip(size_t length)
+{
+    check_outOfBound(length);
+    readIndex += length;
+    return *this;
+}
+
+QQDommy::ByteBuffer &QQDommy::ByteBuffer::writeBytes(const void *src, size_t length)
+{
+    check_readOnly();
+    if (length == 0)
+        return *this;
+    // the source may lie in this buffer, e.g. b.writeBuffer(b), its offset outlives a resize
+    uintptr_t at = (uintptr_t)src, begin = (uintptr_t)data;
+    if (at >= begin && at < begin + capacity)
+    {
+        size_t offset = at - begin;
+        check_resize(length);
+        memmove(data + writeIndex, data + offset, length);
+    }
+    else
+    {
+        check_resize(length);
+        memcpy(data + writeIndex, src, length);
+    }
+    writeIndex += length;
+    return *this;
+}
+
+void QQDommy::ByteBuffer::compact()
+{
+    check_readOnly();
+    if (readIndex == 0)
+        return;
+    size_t remain = readableBytes();
+    memmove(data, data + readIndex, remain);
+    compactions.add();
+    copiedBytes.add(remain);
+    readIndex = 0;
+    writeIndex = remain;
+}
+
+void QQDommy::ByteBuffer::clear()
+{
+    check_readOnly();
+    readIndex = writeIndex = 0;
+}
+
+bool QQDommy::ByteBuffer::readOnly() const
+{
+    return isReadOnly;
+}
+
 QQDommy::IllegalHexExprException::IllegalHexExprException(const std::string &expr)
 {
     this->expr = "error expr : " + expr;
@@ -239,4 +384,9 @@ const char *QQDommy::BufferOutOfBoundException::what() const noexcept
 const char *QQDommy::ReadOnlyBufferException::what() const noexcept
 {
     return "trying to read an read only buffer";
+}
+
+const char *QQDommy::IllegalStringException::what() const noexcept
+{
+    return "the string is not valid utf-8";
 }
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "utils/Metrics.h"
+#include <mutex>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+struct MetricInfo
+{
+    std::string name;
+    std::string help;
+    QQDommy::METRIC_UNIT unit;
+};
+
+/**
+ * @brief the names of the metrics, the shards of the living threads and what the
+ * finished threads counted, everything is guarded by the mutex
+ *
+ */
+struct MetricsRegistry
+{
+    std::mutex mutex;
+    std::vector<MetricInfo> counters;
+    std::vector<MetricInfo> gauges;
+    std::vector<MetricInfo> histograms;
+    std::atomic<int64_t> gaugeValues[QQDommy::MAX_GAUGES];
+    std::vector<QQDommy::MetricsShard *> shards;
+    uint64_t retiredCounters[QQDommy::MAX_COUNTERS] = {};
+    uint64_t retiredBuckets[QQDommy::MAX_HISTOGRAMS][QQDommy::HISTOGRAM_BUCKETS] = {};
+    uint64_t retiredSums[QQDommy::MAX_HISTOGRAMS] = {};
+
+    MetricsRegistry()
+    {
+        // id 0 takes the metrics beyond the limits, it is never exported
+        counters.push_back({"", "", QQDommy::UNIT_NONE});
+        gauges.push_back({"", "", QQDommy::UNIT_NONE});
+        histograms.push_back({"", "", QQDommy::UNIT_NONE});
+    }
+};
+
+/// @brief the metrics are registered by the statics of other files, the registry is built on first use and never freed
+static MetricsRegistry &registry()
+{
+    static MetricsRegistry *instance = new MetricsRegistry();
+    return *instance;
+}
+
+static uint32_t registerMetric(std::vector<MetricInfo> &metrics, size_t limit, const char *name, const char *help, QQDommy::METRIC_UNIT unit)
+{
+    // the same name declared in two places is the same metric
+    for (size_t id = 1; id < metrics.size(); id++)
+        if (metrics[id].name == name)
+            return (uint32_t)id;
+    if (metrics.size() >= limit)
+        return 0;
+    metrics.push_back({name, help, unit});
+    return (uint32_t)(metrics.size() - 1);
+}
+
+/// @brief merges the shard of a thread into the totals when the thread exits
+struct ShardOwner
+{
+    QQDommy::MetricsShard *shard = nullptr;
+    ~ShardOwner()
+    {
+        if (shard == nullptr)
+            return;
+        MetricsRegistry &metrics = registry();
+        std::lock_guard<std::mutex> lock(metrics.mutex);
+        for (size_t id = 0; id < QQDommy::MAX_COUNTERS; id++)
+            metrics.retiredCounters[id] += shard->counters[id].load(std::memory_order_relaxed);
+        for (size_t id = 0; id < QQDommy::MAX_HISTOGRAMS; id++)
+        {
+            QQDommy::HistogramShard *histogram = shard->histograms[id].load(std::memory_order_relaxed);
+            if (histogram == nullptr)
+                continue;
+            for (size_t bucket = 0; bucket < QQDommy::HISTOGRAM_BUCKETS; bucket++)
+                metrics.retiredBuckets[id][bucket] += histogram->buckets[bucket].load(std::memory_order_relaxed);
+            metrics.retiredSums[id] += histogram->sum.load(std::memory_order_relaxed);
+            delete histogram;
+        }
+        metrics.shards.erase(std::find(metrics.shards.begin(), metrics.shards.end(), shard));
+        delete shard;
+    }
+};
+
+double QQDommy::HistogramSnapshot::percentile(double quantile) const
+{
+    if (count == 0)
+        return 0;
+    uint64_t rank = (uint64_t)std::ceil(std::clamp(quantile, 0.0, 1.0) * count);
+    uint64_t seen = 0;
+    for (const std::pair<double, uint64_t> &bucket : buckets)
+    {
+        seen += bucket.second;
+        if (seen >= rank)
+            return bucket.first;
+    }
+    return buckets.back().first;
+}
+
+QQDommy::MetricsShard *QQDommy::Metrics::attach()
+{
+    static thread_local ShardOwner owner;
+    MetricsRegistry &metrics = registry();
+    MetricsShard *shard = new MetricsShard();
+    {
+        std::lock_guard<std::mutex> lock(metrics.mutex);
+        metrics.shards.push_back(shard);
+    }
+    owner.shard = shard;
+    localShard = shard;
+    return shard;
+}
+
+QQDommy::HistogramShard *QQDommy::Metrics::attachHistogram(MetricsShard *shard, uint32_t id)
+{
+    HistogramShard *histogram = new HistogramShard();
+    // published for the snapshots reading the shard from another thread
+    shard->histograms[id].store(histogram, std::memory_order_release);
+    return histogram;
+}
+
+uint32_t QQDommy::Metrics::registerCounter(const char *name, const char *help)
+{
+    MetricsRegistry &metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.mutex);
+    return registerMetric(metrics.counters, MAX_COUNTERS, name, help, UNIT_NONE);
+}
+
+std::atomic<int64_t> *QQDommy::Metrics::registerGauge(const char *name, const char *help)
+{
+    MetricsRegistry &metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.mutex);
+    return &metrics.gaugeValues[registerMetric(metrics.gauges, MAX_GAUGES, name, help, UNIT_NONE)];
+}
+
+uint32_t QQDommy::Metrics::registerHistogram(const char *name, const char *help, METRIC_UNIT unit)
+{
+    MetricsRegistry &metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.mutex);
+    return registerMetric(metrics.histograms, MAX_HISTOGRAMS, name, help, unit);
+}
+
+uint64_t QQDommy::Metrics::bucketLimit(size_t bucket)
+{
+    if (bucket < (1u << HISTOGRAM_SUB_BITS))
+        return bucket;
+    unsigned exponent = (unsigned)(bucket >> HISTOGRAM_SUB_BITS) + HISTOGRAM_SUB_BITS - 1;
+    uint64_t width = (uint64_t)1 << (exponent - HISTOGRAM_SUB_BITS);
+    uint64_t low = (uint64_t)((1u << HISTOGRAM_SUB_BITS) + (bucket & ((1u << HISTOGRAM_SUB_BITS) - 1))) * width;
+    return low + width - 1;
+}
+
+QQDommy::MetricsSnapshot QQDommy::Metrics::snapshot()
+{
+    MetricsRegistry &metrics = registry();
+    MetricsSnapshot result;
+    result.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+    double nsPerTick = TscClock::calibration().nsPerTick;
+    std::lock_guard<std::mutex> lock(metrics.mutex);
+    for (size_t id = 1; id < metrics.counters.size(); id++)
+    {
+        uint64_t value = metrics.retiredCounters[id];
+        for (MetricsShard *shard : metrics.shards)
+            value += shard->counters[id].load(std::memory_order_relaxed);
+        result.counters.push_back({metrics.counters[id].name, metrics.counters[id].help, value});
+    }
+    for (size_t id = 1; id < metrics.gauges.size(); id++)
+        result.gauges.push_back({metrics.gauges[id].name, metrics.gauges[id].help,
+                                 metrics.gaugeValues[id].load(std::memory_order_relaxed)});
+    std::vector<uint64_t> buckets(HISTOGRAM_BUCKETS);
+    for (size_t id = 1; id < metrics.histograms.size(); id++)
+    {
+        const MetricInfo &info = metrics.histograms[id];
+        double scale = info.unit == UNIT_TICKS ? nsPerTick : 1;
+        uint64_t sum = metrics.retiredSums[id];
+        std::copy(metrics.retiredBuckets[id], metrics.retiredBuckets[id] + HISTOGRAM_BUCKETS, buckets.begin());
+        for (MetricsShard *shard : metrics.shards)
+        {
+            HistogramShard *histogram = shard->histograms[id].load(std::memory_order_acquire);
+            if (histogram == nullptr)
+                continue;
+            for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+                buckets[bucket] += histogram->buckets[bucket].load(std::memory_order_relaxed);
+            sum += histogram->sum.load(std::memory_order_relaxed);
+        }
+        HistogramSnapshot histogram;
+        histogram.name = info.name;
+        histogram.help = info.help;
+        histogram.sum = sum * scale;
+        for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+        {
+            if (buckets[bucket] == 0)
+                continue;
+            histogram.count += buckets[bucket];
+            histogram.buckets.emplace_back(bucketLimit(bucket) * scale, buckets[bucket]);
+        }
+        result.histograms.push_back(std::move(histogram));
+    }
+    return result;
+}
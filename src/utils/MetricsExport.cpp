@@ -0,0 +1,224 @@
+#include "utils/MetricsExport.h"
+#include "json/JsonWriter.h"
+#include <charconv>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static void writeText(QQDommy::ByteBuffer &out, std::string_view text)
+{
+    out.writeBytes(text.data(), text.size());
+}
+
+/// @brief the shortest text read back as the same double
+static void writeNumber(QQDommy::ByteBuffer &out, double number)
+{
+    out.ensureWritable(32);
+    char *at = (char *)out.writePointer();
+    std::to_chars_result result = std::to_chars(at, at + 32, number);
+    out.commitWrite(result.ptr - at);
+}
+
+static void writeNumber(QQDommy::ByteBuffer &out, uint64_t number)
+{
+    out.ensureWritable(20);
+    char *at = (char *)out.writePointer();
+    std::to_chars_result result = std::to_chars(at, at + 20, number);
+    out.commitWrite(result.ptr - at);
+}
+
+/// @brief the help and the type lines before the samples of a metric
+static void writeHeader(QQDommy::ByteBuffer &out, const std::string &name, const std::string &help, const char *type)
+{
+    writeText(out, "# HELP ");
+    writeText(out, name);
+    writeText(out, " ");
+    // a new line in the help would end the line
+    for (char c : help)
+    {
+        if (c == '\n')
+            writeText(out, "\\n");
+        else if (c == '\\')
+            writeText(out, "\\\\");
+        else
+            out.write_uint8(c);
+    }
+    writeText(out, "\n# TYPE ");
+    writeText(out, name);
+    writeText(out, " ");
+    writeText(out, type);
+    writeText(out, "\n");
+}
+
+static void writeWhole(int fd, const QQDommy::ByteBuffer &text, const std::string &path)
+{
+    const uint8_t *data = text.readPointer();
+    size_t remain = text.readableBytes();
+    while (remain > 0)
+    {
+        ssize_t n = ::write(fd, data, remain);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            int error = errno;
+            ::close(fd);
+            throw QQDommy::MetricsExportException(path, strerror(error));
+        }
+        data += n;
+        remain -= n;
+    }
+}
+
+/**
+ * @brief blocks SIGPIPE on the calling thread while it writes into a pipe, a reader
+ * going away fails the write with EPIPE instead of killing the process
+ *
+ */
+class SigpipeBlock
+{
+private:
+    sigset_t pipeSet;
+    sigset_t saved;
+    bool wasPending;
+
+public:
+    SigpipeBlock()
+    {
+        sigemptyset(&pipeSet);
+        sigaddset(&pipeSet, SIGPIPE);
+        sigset_t pending;
+        sigpending(&pending);
+        wasPending = sigismember(&pending, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSet, &saved);
+    }
+    ~SigpipeBlock()
+    {
+        // the SIGPIPE raised by our own write is taken before the mask is restored
+        if (!wasPending)
+        {
+            timespec none = {0, 0};
+            while (sigtimedwait(&pipeSet, nullptr, &none) < 0 && errno == EINTR)
+                ;
+        }
+        pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+    }
+};
+
+QQDommy::MetricsExportException::MetricsExportException(const std::string &path, const std::string &error)
+{
+    reason = "can't export the metrics to " + path + " : " + error;
+}
+
+const char *QQDommy::MetricsExportException::what() const _GLIBCXX_TXN_SAFE_DYN _GLIBCXX_USE_NOEXCEPT
+{
+    return reason.c_str();
+}
+
+void QQDommy::MetricsExport::toJson(const MetricsSnapshot &snapshot, ByteBuffer &out)
+{
+    JsonWriter writer(out);
+    writer.beginObject().field("timestamp", snapshot.timestampMs);
+    writer.key("counters").beginObject();
+    for (const CounterSnapshot &counter : snapshot.counters)
+        writer.field(counter.name, counter.value);
+    writer.endObject();
+    writer.key("gauges").beginObject();
+    for (const GaugeSnapshot &gauge : snapshot.gauges)
+        writer.field(gauge.name, gauge.value);
+    writer.endObject();
+    writer.key("histograms").beginObject();
+    for (const HistogramSnapshot &histogram : snapshot.histograms)
+    {
+        writer.key(histogram.name)
+            .beginObject()
+            .field("count", histogram.count)
+            .field("sum", histogram.sum)
+            .field("p50", histogram.percentile(0.5))
+            .field("p90", histogram.percentile(0.9))
+            .field("p99", histogram.percentile(0.99))
+            .field("max", histogram.percentile(1));
+        // [upper bound, count] pairs
+        writer.key("buckets").beginArray();
+        for (const std::pair<double, uint64_t> &bucket : histogram.buckets)
+            writer.beginArray().value(bucket.first).value(bucket.second).endArray();
+        writer.endArray().endObject();
+    }
+    writer.endObject().endObject();
+}
+
+void QQDommy::MetricsExport::toPrometheus(const MetricsSnapshot &snapshot, ByteBuffer &out)
+{
+    for (const CounterSnapshot &counter : snapshot.counters)
+    {
+        writeHeader(out, counter.name, counter.help, "counter");
+        writeText(out, counter.name);
+        writeText(out, " ");
+        writeNumber(out, counter.value);
+        writeText(out, "\n");
+    }
+    for (const GaugeSnapshot &gauge : snapshot.gauges)
+    {
+        writeHeader(out, gauge.name, gauge.help, "gauge");
+        writeText(out, gauge.name);
+        writeText(out, " ");
+        writeNumber(out, (double)gauge.value);
+        writeText(out, "\n");
+    }
+    for (const HistogramSnapshot &histogram : snapshot.histograms)
+    {
+        writeHeader(out, histogram.name, histogram.help, "histogram");
+        uint64_t cumulative = 0;
+        for (const std::pair<double, uint64_t> &bucket : histogram.buckets)
+        {
+            cumulative += bucket.second;
+            writeText(out, histogram.name);
+            writeText(out, "_bucket{le=\"");
+            writeNumber(out, bucket.first);
+            writeText(out, "\"} ");
+            writeNumber(out, cumulative);
+            writeText(out, "\n");
+        }
+        writeText(out, histogram.name);
+        writeText(out, "_bucket{le=\"+Inf\"} ");
+        writeNumber(out, histogram.count);
+        writeText(out, "\n");
+        writeText(out, histogram.name);
+        writeText(out, "_sum ");
+        writeNumber(out, histogram.sum);
+        writeText(out, "\n");
+        writeText(out, histogram.name);
+        writeText(out, "_count ");
+        writeNumber(out, histogram.count);
+        writeText(out, "\n");
+    }
+}
+
+void QQDommy::MetricsExport::writeFile(const std::string &path, const ByteBuffer &text)
+{
+    struct stat info;
+    if (::stat(path.c_str(), &info) == 0 && S_ISFIFO(info.st_mode))
+    {
+        // a pipe without a reader fails at once instead of blocking the exporter
+        int fd = ::open(path.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            throw MetricsExportException(path, strerror(errno));
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+        SigpipeBlock block;
+        writeWhole(fd, text, path);
+        ::close(fd);
+        return;
+    }
+    std::string aside = path + ".tmp";
+    int fd = ::open(aside.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw MetricsExportException(aside, strerror(errno));
+    writeWhole(fd, text, aside);
+    ::close(fd);
+    if (::rename(aside.c_str(), path.c_str()) != 0)
+        throw MetricsExportException(path, strerror(errno));
+}
@@ -0,0 +1,233 @@
+#include "utils/TimerWheel.h"
+
+/// @brief the bit offset of every level in the expire tick
+static size_t level_shift(size_t level)
+{
+    return level == 0 ? 0 : QQDommy::WHEEL_LEVEL0_BITS + (level - 1) * QQDommy::WHEEL_LEVEL_BITS;
+}
+
+static size_t level_size(size_t level)
+{
+    return (size_t)1 << (level == 0 ? QQDommy::WHEEL_LEVEL0_BITS : QQDommy::WHEEL_LEVEL_BITS);
+}
+
+QQDommy::TimerWheel::TimerWheel(int tickMs)
+    : start(std::chrono::steady_clock::now()), tick(tickMs > 0 ? tickMs : DEFAULT_TICK_MS)
+{
+    // the sentinels point to themselves, the vectors are never resized afterwards
+    for (size_t level = 0; level < WHEEL_LEVELS; level++)
+        slots[level] = std::vector<TimerLink>(level_size(level));
+}
+
+QQDommy::TimerWheel::TimerNode *QQDommy::TimerWheel::allocate()
+{
+    if (freeNodes.empty())
+    {
+        uint32_t base = (uint32_t)(chunks.size() * TIMER_CHUNK_SIZE);
+        chunks.emplace_back(new TimerNode[TIMER_CHUNK_SIZE]);
+        for (size_t i = TIMER_CHUNK_SIZE; i > 0; i--)
+        {
+            chunks.back()[i - 1].index = base + (uint32_t)(i - 1);
+            freeNodes.push_back(base + (uint32_t)(i - 1));
+        }
+    }
+    uint32_t index = freeNodes.back();
+    freeNodes.pop_back();
+    return &chunks[index / TIMER_CHUNK_SIZE][index % TIMER_CHUNK_SIZE];
+}
+
+void QQDommy::TimerWheel::recycle(TimerNode *node)
+{
+    node->active = node->firing = node->cancelled = false;
+    node->callback = nullptr;
+    // ids of the old timer no longer match this node
+    node->generation++;
+    freeNodes.push_back(node->index);
+    count--;
+}
+
+QQDommy::TimerWheel::TimerNode *QQDommy::TimerWheel::find(TimerId id)
+{
+    uint32_t index = (uint32_t)(id & 0xffffffff);
+    uint32_t generation = (uint32_t)(id >> 32);
+    if (index == 0 || index > chunks.size() * TIMER_CHUNK_SIZE)
+        return nullptr;
+    index--;
+    TimerNode *node = &chunks[index / TIMER_CHUNK_SIZE][index % TIMER_CHUNK_SIZE];
+    if (node->generation != generation || !node->active)
+        return nullptr;
+    return node;
+}
+
+void QQDommy::TimerWheel::unlink(TimerLink *link)
+{
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->prev = link->next = link;
+}
+
+void QQDommy::TimerWheel::place(TimerNode *node)
+{
+    if (node->expire < currentTick)
+        node->expire = currentTick;
+    uint64_t delta = node->expire - currentTick;
+    size_t level = 0;
+    while (level + 1 < WHEEL_LEVELS && delta >= ((uint64_t)1 << level_shift(level + 1)))
+        level++;
+    uint64_t expire = node->expire;
+    // beyond the range of the top level, park it in the farthest slot and cascade later
+    uint64_t range = (uint64_t)1 << (level_shift(WHEEL_LEVELS - 1) + WHEEL_LEVEL_BITS);
+    if (delta >= range)
+        expire = currentTick + range - 1;
+    TimerLink &slot = slots[level][(expire >> level_shift(level)) & (level_size(level) - 1)];
+    node->prev = slot.prev;
+    node->next = &slot;
+    slot.prev->next = node;
+    slot.prev = node;
+}
+
+QQDommy::TimerId QQDommy::TimerWheel::schedule(int delayMs, const TimerCallback &callback, int intervalMs)
+{
+    TimerNode *node = allocate();
+    uint64_t tickMs = tick.count();
+    uint64_t delay = delayMs > 0 ? (delayMs + tickMs - 1) / tickMs : 0;
+    // the current tick is partly gone, count from the next one so the delay is a minimum
+    uint64_t now = ticksOf(std::chrono::steady_clock::now()) + 1;
+    node->expire = (now > currentTick ? now : currentTick) + delay;
+    node->interval = intervalMs > 0 ? (intervalMs + tickMs - 1) / tickMs : 0;
+    node->callback = callback;
+    node->active = true;
+    count++;
+    place(node);
+    return ((uint64_t)node->generation << 32) | (node->index + 1);
+}
+
+bool QQDommy::TimerWheel::cancel(TimerId id)
+{
+    TimerNode *node = find(id);
+    if (node == nullptr || node->cancelled)
+        return false;
+    if (node->firing)
+    {
+        // the node is owned by processTick, it is recycled after the callback returns
+        node->cancelled = true;
+        return true;
+    }
+    unlink(node);
+    recycle(node);
+    return true;
+}
+
+void QQDommy::TimerWheel::cascade(size_t level, size_t index)
+{
+    TimerLink &slot = slots[level][index];
+    TimerLink *link = slot.next;
+    // detach the whole list first, place may put nodes back into this slot
+    slot.prev = slot.next = &slot;
+    while (link != &slot)
+    {
+        TimerLink *next = link->next;
+        place(static_cast<TimerNode *>(link));
+        link = next;
+    }
+}
+
+size_t QQDommy::TimerWheel::processTick()
+{
+    for (size_t level = 1; level < WHEEL_LEVELS; level++)
+    {
+        // a lower level wrapped around, refill it from the level above
+        if ((currentTick & (((uint64_t)1 << level_shift(level)) - 1)) != 0)
+            break;
+        cascade(level, (currentTick >> level_shift(level)) & (level_size(level) - 1));
+    }
+    TimerLink &slot = slots[0][currentTick & (level_size(0) - 1)];
+    TimerLink expired;
+    if (slot.next != &slot)
+    {
+        // move the whole slot into a local list in one go
+        expired.next = slot.next;
+        expired.prev = slot.prev;
+        expired.next->prev = &expired;
+        expired.prev->next = &expired;
+        slot.prev = slot.next = &slot;
+    }
+    // timers scheduled by the callbacks below land on the following ticks
+    uint64_t due = currentTick++;
+    size_t fired = 0;
+    while (expired.next != &expired)
+    {
+        TimerNode *node = static_cast<TimerNode *>(expired.next);
+        unlink(node);
+        // parked beyond the range of the wheel, not due yet
+        if (node->expire > due)
+        {
+            place(node);
+            continue;
+        }
+        node->firing = true;
+        node->callback();
+        fired++;
+        node->firing = false;
+        if (node->interval == 0 || node->cancelled)
+        {
+            recycle(node);
+            continue;
+        }
+        node->expire = due + node->interval;
+        place(node);
+    }
+    return fired;
+}
+
+uint64_t QQDommy::TimerWheel::ticksOf(std::chrono::steady_clock::time_point t) const
+{
+    if (t <= start)
+        return 0;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t - start).count() / tick.count();
+}
+
+size_t QQDommy::TimerWheel::advance(std::chrono::steady_clock::time_point now)
+{
+    uint64_t target = ticksOf(now);
+    size_t fired = 0;
+    while (currentTick <= target)
+    {
+        // nothing to expire, jump to the present in one step
+        if (count == 0)
+        {
+            currentTick = target + 1;
+            break;
+        }
+        fired += processTick();
+    }
+    return fired;
+}
+
+int QQDommy::TimerWheel::nextTimeout(std::chrono::steady_clock::time_point now) const
+{
+    if (count == 0)
+        return -1;
+    // the nearest non empty slot of the first level, or the next cascade
+    // a tick on the boundary has to cascade before its slot is known
+    size_t offset = currentTick & (level_size(0) - 1);
+    size_t wait = offset == 0 ? 0 : level_size(0) - offset;
+    for (size_t i = 0; i < wait; i++)
+    {
+        const TimerLink &slot = slots[0][(currentTick + i) & (level_size(0) - 1)];
+        if (slot.next != &slot)
+        {
+            wait = i;
+            break;
+        }
+    }
+    auto due = start + tick * (currentTick + wait);
+    if (due <= now)
+        return 0;
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count() + 1;
+}
+
+size_t QQDommy::TimerWheel::size() const
+{
+    return count;
+}
@@ -0,0 +1,202 @@
+#include "utils/Tracing.h"
+#include "json/JsonWriter.h"
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/**
+ * @brief the rings of all the threads and the names of the threads, guarded by the mutex
+ *
+ */
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector<QQDommy::TraceRing *> rings;
+    /// @brief kept after the rings are freed, the events of an exited thread may still be exported
+    std::map<int, const char *> threadNames;
+};
+
+static std::atomic<uint32_t> sampling{0};
+/// @brief 0 means no flow
+static std::atomic<uint64_t> nextFlow{1};
+
+/// @brief the rings outlive the statics of other files, the registry is never freed
+static TraceRegistry &registry()
+{
+    static TraceRegistry *instance = new TraceRegistry();
+    return *instance;
+}
+
+/**
+ * @brief closes the ring of the thread when it exits, the next collect frees it
+ *
+ */
+struct TraceRingOwner
+{
+    QQDommy::TraceRing *ring = nullptr;
+    ~TraceRingOwner()
+    {
+        if (ring != nullptr)
+            ring->closed.store(true, std::memory_order_release);
+    }
+};
+
+QQDommy::TraceRing::TraceRing(int tid) : slots(new Slot[TRACE_RING_SIZE]), tid(tid)
+{
+}
+
+void QQDommy::TraceRing::copyTo(std::vector<TraceEvent> &events) const
+{
+    uint64_t end = committed.load(std::memory_order_acquire);
+    uint64_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+    size_t first = events.size();
+    for (uint64_t index = begin; index < end; index++)
+    {
+        const Slot &slot = slots[index & (TRACE_RING_SIZE - 1)];
+        events.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                          slot.end.load(std::memory_order_relaxed), slot.flow.load(std::memory_order_relaxed),
+                          slot.kind.load(std::memory_order_relaxed), tid});
+    }
+    // the slots the writer started to overwrite during the copy are dropped
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claim = claimed.load(std::memory_order_relaxed);
+    uint64_t valid = claim > TRACE_RING_SIZE ? claim - TRACE_RING_SIZE : 0;
+    if (valid > begin)
+        events.erase(events.begin() + first, events.begin() + first + std::min(valid - begin, end - begin));
+}
+
+QQDommy::TraceRing *QQDommy::Tracer::attach()
+{
+    static thread_local TraceRingOwner owner;
+    TraceRegistry &traces = registry();
+    owner.ring = new TraceRing((int)::syscall(SYS_gettid));
+    {
+        std::lock_guard<std::mutex> lock(traces.mutex);
+        traces.rings.push_back(owner.ring);
+    }
+    localRing = owner.ring;
+    return localRing;
+}
+
+bool QQDommy::Tracer::sampleSlow()
+{
+    uint32_t every = sampling.load(std::memory_order_relaxed);
+    if (every == 0)
+        return false;
+    countdown = every;
+    return true;
+}
+
+void QQDommy::Tracer::setSampling(uint32_t every)
+{
+    sampling.store(every, std::memory_order_relaxed);
+}
+
+uint64_t QQDommy::Tracer::newFlow()
+{
+    return nextFlow.fetch_add(1, std::memory_order_relaxed);
+}
+
+void QQDommy::Tracer::nameThread(const char *name)
+{
+    TraceRing *ring = localRing != nullptr ? localRing : attach();
+    ring->threadName.store(name, std::memory_order_release);
+}
+
+std::vector<QQDommy::TraceEvent> QQDommy::Tracer::collect()
+{
+    TraceRegistry &traces = registry();
+    std::vector<TraceEvent> events;
+    std::lock_guard<std::mutex> lock(traces.mutex);
+    for (auto it = traces.rings.begin(); it != traces.rings.end();)
+    {
+        TraceRing *ring = *it;
+        // read before the copy, the last events of a closed ring are all committed
+        bool closed = ring->closed.load(std::memory_order_acquire);
+        ring->copyTo(events);
+        const char *name = ring->threadName.load(std::memory_order_acquire);
+        if (name != nullptr)
+            traces.threadNames[ring->tid] = name;
+        if (!closed)
+        {
+            it++;
+            continue;
+        }
+        delete ring;
+        it = traces.rings.erase(it);
+    }
+    return events;
+}
+
+void QQDommy::Tracer::toChrome(const std::vector<TraceEvent> &events, ByteBuffer &out)
+{
+    double nsPerTick = TscClock::calibration().nsPerTick;
+    uint64_t base = UINT64_MAX;
+    for (const TraceEvent &event : events)
+        base = std::min(base, event.start);
+    // microseconds from the first event, the absolute time would lose the nanoseconds in a double
+    auto micros = [base, nsPerTick](uint64_t ticks)
+    { return (double)(int64_t)(ticks - base) * nsPerTick / 1000; };
+    int pid = (int)::getpid();
+    JsonWriter writer(out);
+    writer.beginObject().field("displayTimeUnit", "ns").key("traceEvents").beginArray();
+    std::map<int, const char *> names;
+    {
+        TraceRegistry &traces = registry();
+        std::lock_guard<std::mutex> lock(traces.mutex);
+        names = traces.threadNames;
+    }
+    for (const std::pair<const int, const char *> &name : names)
+    {
+        bool present = std::any_of(events.begin(), events.end(), [&name](const TraceEvent &event)
+                                   { return event.tid == name.first; });
+        if (!present)
+            continue;
+        writer.beginObject()
+            .field("name", "thread_name")
+            .field("ph", "M")
+            .field("pid", pid)
+            .field("tid", name.first)
+            .key("args")
+            .beginObject()
+            .field("name", name.second)
+            .endObject()
+            .endObject();
+    }
+    for (const TraceEvent &event : events)
+    {
+        if (event.kind == SPAN_SYNC)
+        {
+            writer.beginObject()
+                .field("name", event.name)
+                .field("cat", "span")
+                .field("ph", "X")
+                .field("ts", micros(event.start))
+                .field("dur", micros(event.end) - micros(event.start))
+                .field("pid", pid)
+                .field("tid", event.tid)
+                .key("args")
+                .beginObject()
+                .field("flow", event.flow)
+                .endObject()
+                .endObject();
+            continue;
+        }
+        // the async events of a flow share its id and are nested on one track
+        const char *phases[2] = {"b", "e"};
+        uint64_t times[2] = {event.start, event.end};
+        for (int i = 0; i < 2; i++)
+            writer.beginObject()
+                .field("name", event.name)
+                .field("cat", "flow")
+                .field("ph", phases[i])
+                .field("id", event.flow)
+                .field("ts", micros(times[i]))
+                .field("pid", pid)
+                .field("tid", event.tid)
+                .endObject();
+    }
+    writer.endArray().endObject();
+}
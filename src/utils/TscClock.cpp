@@ -0,0 +1,53 @@
+#include "utils/TscClock.h"
+#include <mutex>
+#include <thread>
+#include <ctime>
+
+static std::mutex calibrationMutex;
+static QQDommy::TscCalibration current;
+static bool calibrated = false;
+
+static int64_t clockNs(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/// @brief read the counter and the monotonic clock as close together as possible
+static void sample(uint64_t &ticks, int64_t &ns)
+{
+    uint64_t before = QQDommy::TscClock::now();
+    ns = clockNs(CLOCK_MONOTONIC);
+    uint64_t after = QQDommy::TscClock::now();
+    ticks = before + (after - before) / 2;
+}
+
+QQDommy::TscCalibration QQDommy::TscClock::calibrate()
+{
+    std::lock_guard<std::mutex> lock(calibrationMutex);
+    if (!calibrated)
+    {
+        sample(current.baseTicks, current.baseNs);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        calibrated = true;
+    }
+    uint64_t ticks;
+    int64_t ns;
+    sample(ticks, ns);
+    if (ticks > current.baseTicks && ns > current.baseNs)
+        current.nsPerTick = (double)(ns - current.baseNs) / (double)(ticks - current.baseTicks);
+    // the wall clock may be stepped at any time, it only moves the rendered times
+    current.realtimeOffsetNs = clockNs(CLOCK_REALTIME) - clockNs(CLOCK_MONOTONIC);
+    return current;
+}
+
+QQDommy::TscCalibration QQDommy::TscClock::calibration()
+{
+    {
+        std::lock_guard<std::mutex> lock(calibrationMutex);
+        if (calibrated)
+            return current;
+    }
+    return calibrate();
+}
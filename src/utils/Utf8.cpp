@@ -0,0 +1,215 @@
+#include "utils/Utf8.h"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UTF8_AVX2 1
+#endif
+
+bool QQDommy::Utf8::validateScalar(const char *text, size_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)text;
+    size_t i = 0;
+    while (i < length)
+    {
+        if (i + 8 <= length)
+        {
+            // the ascii is skipped 8 bytes at a time
+            uint64_t word;
+            memcpy(&word, bytes + i, 8);
+            if ((word & 0x8080808080808080ull) == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+        uint8_t lead = bytes[i];
+        if (lead < 0x80)
+        {
+            i++;
+            continue;
+        }
+        size_t continuations;
+        // the second byte is narrowed for the overlong forms, the surrogates and above U+10FFFF
+        uint8_t low = 0x80, high = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+            continuations = 1;
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            continuations = 2;
+            low = lead == 0xE0 ? 0xA0 : 0x80;
+            high = lead == 0xED ? 0x9F : 0xBF;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            continuations = 3;
+            low = lead == 0xF0 ? 0x90 : 0x80;
+            high = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+        else
+            return false;
+        if (length - i <= continuations)
+            return false;
+        if (bytes[i + 1] < low || bytes[i + 1] > high)
+            return false;
+        for (size_t k = 2; k <= continuations; k++)
+            if ((bytes[i + k] & 0xC0) != 0x80)
+                return false;
+        i += continuations + 1;
+    }
+    return true;
+}
+
+#ifdef UTF8_AVX2
+
+/**
+ * @brief the error bits of a pair of bytes, looked up by the high and the low nibble of
+ * the first byte and the high nibble of the second, a pair is wrong if a bit is set in all 3
+ *
+ */
+const static uint8_t TOO_SHORT = 1 << 0;
+const static uint8_t TOO_LONG = 1 << 1;
+const static uint8_t OVERLONG_3 = 1 << 2;
+const static uint8_t TOO_LARGE = 1 << 3;
+const static uint8_t SURROGATE = 1 << 4;
+const static uint8_t OVERLONG_2 = 1 << 5;
+const static uint8_t TOO_LARGE_1000 = 1 << 6;
+const static uint8_t OVERLONG_4 = 1 << 6;
+const static uint8_t TWO_CONTS = 1 << 7;
+const static uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+const static uint8_t BYTE_1_HIGH[16] = {
+    // ascii
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    // continuation
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    // 1100____ and 1101____ lead 2 bytes
+    TOO_SHORT | OVERLONG_2, TOO_SHORT,
+    // 1110____ leads 3 bytes, 1111____ leads 4
+    TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+const static uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    // ____1101 is 0xED, the surrogates
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+const static uint8_t BYTE_2_HIGH[16] = {
+    // ascii
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    // 1000____, 1001____, 101_____
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    // 11______
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+/// @brief a lead in the last 3 bytes whose continuation is in the next block
+const static uint8_t INCOMPLETE[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1};
+
+struct Utf8Checker
+{
+    __m256i error;
+    __m256i previous;
+    __m256i previousIncomplete;
+
+    __attribute__((target("avx2"))) Utf8Checker()
+        : error(_mm256_setzero_si256()), previous(_mm256_setzero_si256()), previousIncomplete(_mm256_setzero_si256())
+    {
+    }
+
+    __attribute__((target("avx2"))) static __m256i table(const uint8_t *values)
+    {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)values));
+    }
+
+    __attribute__((target("avx2"))) static __m256i highNibble(__m256i bytes)
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0f));
+    }
+
+    /// @brief the input shifted by n bytes, the bytes of the previous block shifted in
+    template <int N>
+    __attribute__((target("avx2"))) static __m256i before(__m256i input, __m256i previous)
+    {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+    }
+
+    __attribute__((target("avx2"))) void check(__m256i input)
+    {
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            // an ascii block can only fail on a lead at the end of the previous one
+            error = _mm256_or_si256(error, previousIncomplete);
+            previousIncomplete = _mm256_setzero_si256();
+            previous = input;
+            return;
+        }
+        __m256i previous1 = before<1>(input, previous);
+        __m256i special = _mm256_and_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(table(BYTE_1_HIGH), highNibble(previous1)),
+                             _mm256_shuffle_epi8(table(BYTE_1_LOW), _mm256_and_si256(previous1, _mm256_set1_epi8(0x0f)))),
+            _mm256_shuffle_epi8(table(BYTE_2_HIGH), highNibble(input)));
+        // the third and fourth bytes of a sequence must be continuations, and only they may be
+        __m256i third = _mm256_subs_epu8(before<2>(input, previous), _mm256_set1_epi8((char)(0xe0 - 0x80)));
+        __m256i fourth = _mm256_subs_epu8(before<3>(input, previous), _mm256_set1_epi8((char)(0xf0 - 0x80)));
+        __m256i must = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+        error = _mm256_or_si256(error, _mm256_xor_si256(must, special));
+        previousIncomplete = _mm256_subs_epu8(input, _mm256_loadu_si256((const __m256i *)INCOMPLETE));
+        previous = input;
+    }
+};
+
+__attribute__((target("avx2"))) static bool validateAvx2(const char *text, size_t length)
+{
+    Utf8Checker checker;
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+        checker.check(_mm256_loadu_si256((const __m256i *)(text + i)));
+    if (i < length)
+    {
+        // the tail is padded with ascii, a sequence cut by the end fails as too short
+        alignas(32) char tail[32] = {};
+        memcpy(tail, text + i, length - i);
+        checker.check(_mm256_load_si256((const __m256i *)tail));
+    }
+    __m256i error = _mm256_or_si256(checker.error, checker.previousIncomplete);
+    return _mm256_testz_si256(error, error);
+}
+
+#endif
+
+bool QQDommy::Utf8::vectorized()
+{
+#ifdef UTF8_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+bool QQDommy::Utf8::validate(const char *text, size_t length)
+{
+#ifdef UTF8_AVX2
+    // the setup of the vectors is not worth it for a nickname
+    if (length >= 32 && vectorized())
+        return validateAvx2(text, length);
+#endif
+    return validateScalar(text, length);
+}